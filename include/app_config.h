@@ -13,9 +13,19 @@
 #define APP_VERSION_MINOR 0
 #define APP_VERSION_PATCH 0
 
-/* Sensor sampling configuration */
-#define SENSOR_SAMPLE_INTERVAL_MS    5000    /* 5 seconds */
+/* Sensor sampling configuration (per-channel periods: CONFIG_APP_SENSOR_*_PERIOD_MS) */
 #define SENSOR_QUEUE_SIZE            10
+#define SENSOR_HISTORY_SIZE          64      /* Samples kept in history ring (power of two) */
+#define SENSOR_CACHE_LINE_SIZE       32      /* ESP32-S3 data cache line */
+#define SENSOR_READ_TIMEOUT_MS       100     /* Max wait for one cycle of bus reads */
+#define SAMPLE_BUS_POOL_SIZE         32      /* Samples in flight across all subscribers */
+
+/* Statistics engine (window lengths: CONFIG_APP_STATS_WINDOW*_MS) */
+#define STATS_SUBSCRIBER_DEPTH       16
+#define STATS_UPLINK_QUEUE_SIZE      4
+
+/* Vibration spectrum (FFT size, bands, peaks: CONFIG_APP_VIBRATION_*) */
+#define VIBRATION_UPLINK_QUEUE_SIZE  2
 
 /* BLE configuration */
 #define BLE_DEVICE_NAME              "SecureSensorNode"
@@ -26,9 +36,27 @@
 #define MQTT_BROKER_PORT             1883    /* TLS port */
 #define MQTT_CLIENT_ID               "esp32s3_sensor_node"
 #define MQTT_PUB_TOPIC               "sensors/data"
+#define MQTT_PUB_TOPIC_CBOR          "sensors/data/cbor"
+#define MQTT_STATS_TOPIC             "sensors/stats"
+#define MQTT_VIBRATION_TOPIC         "sensors/vibration"
+#define MQTT_BATCH_TOPIC             "sensors/batch"
+#define MQTT_BATCH_TOPIC_CBOR        "sensors/batch/cbor"
+#define MQTT_BATCH_TOPIC_LZ          "sensors/batch/lz"
+#define MQTT_BATCH_TOPIC_CBOR_LZ     "sensors/batch/cbor/lz"
+#define MQTT_BATCH_TOPIC_TS          "sensors/batch/ts/" MQTT_CLIENT_ID   /* Block has no device id */
 #define MQTT_PUB_INTERVAL_MS         15000   /* 15 seconds */
 #define MQTT_KEEPALIVE_SEC           60
+#ifdef CONFIG_APP_MQTT_QOS1
 #define MQTT_QOS                     1
+#else
+#define MQTT_QOS                     0
+#endif
+#define MQTT_CONNACK_TIMEOUT_MS      5000
+#define MQTT_IO_QUEUE_SIZE           4       /* Threads waiting on the MQTT I/O thread */
+
+/* Reconnect (backoff and timeouts: CONFIG_APP_CONN_*) */
+#define CONN_EVENT_QUEUE_SIZE        8
+#define CONN_BOOT_TIMEOUT_MS         30000   /* Startup wait for the first connection */
 
 /* WiFi configuration */
 #define WIFI_SSID                    "iPhone"
@@ -44,16 +72,29 @@
 /* Buffer sizes */
 #define JSON_BUFFER_SIZE             512
 #define CBOR_BUFFER_SIZE             256
+#define BATCH_HEADER_MAX_LEN         128     /* JSON batch header and trailer */
+#define BATCH_ROW_MAX_LEN            56      /* Longest JSON batch row */
+#define BATCH_CBOR_ROW_MAX_LEN       24      /* Longest CBOR batch row */
+#define SPECTRUM_HEADER_MAX_LEN      136     /* Spectrum JSON without device ID, bands and peaks */
+#define SPECTRUM_BAND_MAX_LEN        11      /* One spectrum band below 10^6 mg */
+#define SPECTRUM_PEAK_MAX_LEN        32      /* One spectrum peak below 10^6 Hz and mg */
+#define MQTT_STREAM_CHUNK_SIZE       128     /* Staging buffer of a streamed PUBLISH */
 
 /* Stack sizes */
 #define SENSOR_THREAD_STACK_SIZE     2048
 #define BLE_THREAD_STACK_SIZE        2048
 #define MQTT_THREAD_STACK_SIZE       4096
+#define STATS_THREAD_STACK_SIZE      1536
+#define VIBRATION_THREAD_STACK_SIZE  2048
+#define CONN_THREAD_STACK_SIZE       3072
 
 /* Thread priorities */
 #define SENSOR_THREAD_PRIORITY       5
 #define BLE_THREAD_PRIORITY          6
 #define MQTT_THREAD_PRIORITY         6
+#define STATS_THREAD_PRIORITY        7
+#define VIBRATION_THREAD_PRIORITY    8
+#define CONN_THREAD_PRIORITY         7
 
 #endif /* APP_CONFIG_H */
 /* BLE Service UUIDs */
@@ -2,12 +2,60 @@
 #define BLE_SERVICE_H
 
 #include <stdbool.h>
+#include <zephyr/sys/byteorder.h>
 #include "sensor_manager.h"
+#include "payload_format.h"
+
+/*
+ * Packed sensor characteristic (UUID ...def2), little-endian:
+ *
+ *   0  u8   schema version (BLE_PACKED_SCHEMA_VERSION)
+ *   1  u8   valid_mask
+ *   2  u32  timestamp_ms
+ *   6  the SAMPLE_FIELDS values in order, each at its integer width:
+ *      6  i16  temperature_cc
+ *      8  i16  accel_x_mg
+ *      10 i16  accel_y_mg
+ *      12 i16  accel_z_mg
+ *      14 u16  battery_mv
+ *
+ * Fields are only ever appended; a reader accepts any record at least
+ * as long as the fields it knows.
+ */
+#define BLE_PACKED_SCHEMA_VERSION 1
+#define BLE_PACKED_HEADER_LEN     6
+#define BLE_PACKED_LEN            (BLE_PACKED_HEADER_LEN + SAMPLE_VALUE_BYTES)
+
+/**
+ * @brief Pack a sample into the packed characteristic layout
+ * @param sample Sample
+ * @param record BLE_PACKED_LEN bytes to fill
+ */
+static inline void ble_packed_encode(const sensor_sample_t *sample, uint8_t *record)
+{
+    record[0] = BLE_PACKED_SCHEMA_VERSION;
+    record[1] = sample->valid_mask;
+    sys_put_le32(sample->timestamp_ms, &record[2]);
+
+    uint8_t *out = &record[BLE_PACKED_HEADER_LEN];
+
+#define PUT_PACKED(name, type, n, ...)                                    \
+    for (int i = 0; i < (n); i++) {                                       \
+        uint32_t raw = (uint32_t)SAMPLE_COMPONENTS(sample, name, type)[i]; \
+                                                                          \
+        for (size_t b = 0; b < sizeof(type); b++) {                       \
+            *out++ = (uint8_t)(raw >> (8 * b));                           \
+        }                                                                 \
+    }
+    SAMPLE_FIELDS(PUT_PACKED)
+#undef PUT_PACKED
+}
 
 int ble_service_init(void);
 int ble_service_start_advertising(void);
 int ble_service_stop_advertising(void);
-int ble_service_notify(const sensor_data_t *data);
+int ble_service_set_format(enum payload_format format);
+int ble_service_notify(const sensor_sample_t *sample);
 bool ble_service_is_connected(void);
 
 #endif
@@ -0,0 +1,110 @@
+/**
+ * @file conn_manager.h
+ * @brief Reconnect state machine for the WiFi link, the IP address and the broker
+ *
+ * The uplink is three layers, each resting on the one below: the WiFi
+ * association, the DHCP address and the MQTT session. Network and MQTT
+ * callbacks report each layer going up or down with conn_manager_notify().
+ * The manager thread then redoes only the layers that were lost. A lost
+ * broker session is reconnected without touching WiFi or DHCP. A lost
+ * address restarts DHCP on the existing association.
+ *
+ * The first retry after a loss is immediate. Each further failure of the
+ * same layer waits conn_backoff_ms(): an exponential delay from
+ * CONFIG_APP_CONN_BACKOFF_MIN_MS up to CONFIG_APP_CONN_BACKOFF_MAX_MS,
+ * with a random half of it as jitter, so a fleet that lost the same
+ * access point does not retry in lockstep.
+ */
+
+#ifndef CONN_MANAGER_H
+#define CONN_MANAGER_H
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+enum conn_state {
+    CONN_STATE_LINK_DOWN,       /* Waiting to (re)associate */
+    CONN_STATE_LINK_CONNECTING, /* Association requested */
+    CONN_STATE_IP_WAIT,         /* Associated, waiting for DHCP */
+    CONN_STATE_BROKER_DOWN,     /* Address up, waiting to (re)connect MQTT */
+    CONN_STATE_UP,
+};
+
+enum conn_event {
+    CONN_EVENT_LINK_UP,         /* Association succeeded */
+    CONN_EVENT_LINK_FAILED,     /* Association attempt failed */
+    CONN_EVENT_LINK_DOWN,       /* Association lost */
+    CONN_EVENT_IP_UP,           /* DHCP address assigned */
+    CONN_EVENT_IP_DOWN,         /* DHCP address removed */
+    CONN_EVENT_BROKER_DOWN,     /* MQTT session closed */
+};
+
+/* Which layer a loss took down */
+enum conn_loss {
+    CONN_LOSS_LINK,
+    CONN_LOSS_IP,
+    CONN_LOSS_BROKER,
+    CONN_LOSS_COUNT
+};
+
+/* Layer actions, run on the manager thread */
+struct conn_ops {
+    /* Request association; the outcome arrives as LINK_UP or LINK_FAILED */
+    int (*link_connect)(void);
+    /* Restart DHCP on the current association */
+    int (*ip_renew)(void);
+    /* Connect the MQTT session; 0 once it is up */
+    int (*broker_connect)(void);
+    /* Whether the MQTT session is up right now */
+    bool (*broker_connected)(void);
+};
+
+struct conn_stats {
+    uint32_t losses[CONN_LOSS_COUNT];
+    uint32_t recovery_ms[CONN_LOSS_COUNT];  /* Last loss to UP, per layer */
+    uint32_t link_attempts;
+    uint32_t ip_renewals;
+    uint32_t broker_attempts;
+};
+
+/**
+ * @brief Start the manager thread, which brings every layer up
+ * @param ops Layer actions, must outlive the manager
+ * @return 0 on success, or negative errno
+ */
+int conn_manager_start(const struct conn_ops *ops);
+
+/**
+ * @brief Report a layer event; callable from any thread
+ * @param event Event
+ */
+void conn_manager_notify(enum conn_event event);
+
+/**
+ * @brief Current state
+ */
+enum conn_state conn_manager_state(void);
+
+/**
+ * @brief Wait until every layer is up
+ * @param timeout How long to wait
+ * @return 0 once up, or -EAGAIN on timeout
+ */
+int conn_manager_wait_up(k_timeout_t timeout);
+
+/**
+ * @brief Get the loss, recovery and attempt counters
+ * @param stats Counters to fill
+ */
+void conn_manager_get_stats(struct conn_stats *stats);
+
+/**
+ * @brief Delay before a retry
+ * @param attempt Failures of the layer so far; 0 retries at once
+ * @param random Random value for the jitter
+ * @return Delay in milliseconds
+ */
+uint32_t conn_backoff_ms(uint32_t attempt, uint32_t random);
+
+#endif /* CONN_MANAGER_H */
@@ -0,0 +1,60 @@
+/**
+ * @file dsp.h
+ * @brief Signal processing kernels
+ *
+ * Two real-input FFT implementations with the same contract:
+ *  - scalar: textbook complex radix-2 on n points, twiddles by
+ *    recurrence, no tables. Portable reference.
+ *  - fast: n real points packed as n/2 complex points, table twiddles,
+ *    trivial first stage, then a split pass to the real spectrum.
+ * dsp_rfft_power() is whichever one CONFIG_APP_VIBRATION_FFT_* selects;
+ * both are always built so they can be compared.
+ */
+
+#ifndef DSP_H
+#define DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest FFT the twiddle table covers */
+#ifdef CONFIG_APP_VIBRATION_FFT_SIZE
+#define DSP_FFT_MAX_SIZE CONFIG_APP_VIBRATION_FFT_SIZE
+#else
+#define DSP_FFT_MAX_SIZE 512
+#endif
+
+/**
+ * @brief Build the twiddle table used by dsp_rfft_power_fast()
+ * @return 0 on success
+ */
+int dsp_fft_init(void);
+
+/**
+ * @brief Power spectrum of n real samples, portable implementation
+ * @param data n real samples on entry, room for 2n floats; clobbered
+ * @param n Power of two, at least 4
+ * @param power Receives |X[k]|² for k = 0..n/2 (n/2 + 1 bins)
+ * @return 0 on success, -EINVAL on a bad size
+ */
+int dsp_rfft_power_scalar(float *data, size_t n, float *power);
+
+/**
+ * @brief Power spectrum of n real samples, table-driven implementation
+ * @param data n real samples on entry; clobbered
+ * @param n Power of two, 4..DSP_FFT_MAX_SIZE
+ * @param power Receives |X[k]|² for k = 0..n/2 (n/2 + 1 bins)
+ * @return 0 on success, -EINVAL on a bad size, -EAGAIN before dsp_fft_init()
+ */
+int dsp_rfft_power_fast(float *data, size_t n, float *power);
+
+static inline int dsp_rfft_power(float *data, size_t n, float *power)
+{
+#ifdef CONFIG_APP_VIBRATION_FFT_SCALAR
+    return dsp_rfft_power_scalar(data, n, power);
+#else
+    return dsp_rfft_power_fast(data, n, power);
+#endif
+}
+
+#endif /* DSP_H */
@@ -0,0 +1,136 @@
+/**
+ * @file fast_boot.h
+ * @brief Last working WiFi, DHCP and broker details, and boot-to-first-publish time
+ *
+ * Once the broker accepts a connection, the access point (BSSID and
+ * channel), the DHCP lease and the resolved broker address are saved in
+ * settings under "fboot". On the next boot the MQTT client tries them
+ * first: it associates without scanning, takes the cached lease as a manual
+ * address while DHCP confirms it in the background, and connects without a
+ * DNS lookup. Once DHCP is bound the manual address gives way to DHCP's. A
+ * cached item that fails is forgotten and that step falls back to the full
+ * path. Items are only written when they change.
+ *
+ * Milestones since boot are recorded once each; the first publish logs
+ * them all. Without CONFIG_APP_FAST_BOOT nothing is cached, but the
+ * milestones are still measured, to compare both paths.
+ */
+
+#ifndef FAST_BOOT_H
+#define FAST_BOOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct net_if;
+struct in_addr;
+
+/* Cached items, each stored under its own settings key */
+enum fast_boot_item {
+    FAST_BOOT_LINK,             /* struct fast_boot_link */
+    FAST_BOOT_LEASE,            /* struct fast_boot_lease */
+    FAST_BOOT_BROKER,           /* struct fast_boot_broker */
+    FAST_BOOT_ITEM_COUNT
+};
+
+struct fast_boot_link {
+    uint32_t ssid_crc;          /* Of the SSID it belongs to */
+    uint8_t bssid[6];
+    uint8_t channel;
+};
+
+struct fast_boot_lease {
+    uint8_t addr[4];
+    uint8_t netmask[4];
+    uint8_t gateway[4];
+};
+
+struct fast_boot_broker {
+    uint32_t name_crc;          /* Of the host name it was resolved from */
+    uint8_t addr[4];
+};
+
+enum fast_boot_mark {
+    FAST_BOOT_MARK_LINK,        /* Associated */
+    FAST_BOOT_MARK_IP,          /* Address up */
+    FAST_BOOT_MARK_BROKER,      /* CONNACK */
+    FAST_BOOT_MARK_PUBLISH,     /* First PUBLISH sent */
+    FAST_BOOT_MARK_COUNT
+};
+
+struct fast_boot_stats {
+    uint32_t mark_ms[FAST_BOOT_MARK_COUNT]; /* Uptime of each milestone, 0 if not reached */
+    uint8_t loaded;             /* Items found in settings, bit per enum fast_boot_item */
+    uint8_t used;               /* Items tried this boot */
+    uint8_t failed;             /* Items that failed and were forgotten */
+    uint32_t saves;             /* Settings writes */
+};
+
+/**
+ * @brief Load the cached items from settings; run again, it starts over
+ * @return 0 on success, or negative errno (the cache is then empty)
+ */
+int fast_boot_init(void);
+
+/**
+ * @brief Copy a cached item out and count it as tried
+ * @param item Item
+ * @param value Receives the item
+ * @param len Size of the item's struct
+ * @return true if the item is cached
+ */
+bool fast_boot_get(enum fast_boot_item item, void *value, size_t len);
+
+/**
+ * @brief Cache an item that just worked, writing settings only if it changed
+ * @param item Item
+ * @param value Item's struct
+ * @param len Size of the item's struct
+ * @return 0 on success, or negative errno
+ */
+int fast_boot_save(enum fast_boot_item item, const void *value, size_t len);
+
+/**
+ * @brief Drop a cached item that failed, so the next boot takes the full path
+ * @param item Item
+ */
+void fast_boot_forget(enum fast_boot_item item);
+
+/**
+ * @brief Install the cached lease as a manual address until DHCP is bound
+ * @param iface Interface
+ * @param addr Receives the cached address
+ * @return true if the cached address is in use
+ */
+bool fast_boot_lease_apply(struct net_if *iface, struct in_addr *addr);
+
+/**
+ * @brief Replace the manual cached address once DHCP is bound
+ *
+ * The manual address is removed. If DHCP was granted the same address it
+ * is added back as a DHCP address with the lease time, so the lease
+ * governs it from then on; otherwise the cached lease is forgotten.
+ *
+ * @param iface Interface
+ * @param cached Address installed by fast_boot_lease_apply()
+ * @param bound Address DHCP is bound to
+ * @param lease_time Lease in seconds
+ * @return true if DHCP confirmed the cached address
+ */
+bool fast_boot_lease_bound(struct net_if *iface, const struct in_addr *cached,
+                           const struct in_addr *bound, uint32_t lease_time);
+
+/**
+ * @brief Record a milestone; only its first time counts
+ * @param mark Milestone
+ */
+void fast_boot_mark(enum fast_boot_mark mark);
+
+/**
+ * @brief Get the milestones and cache counters
+ * @param stats Counters to fill
+ */
+void fast_boot_get_stats(struct fast_boot_stats *stats);
+
+#endif /* FAST_BOOT_H */
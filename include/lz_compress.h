@@ -0,0 +1,103 @@
+/**
+ * @file lz_compress.h
+ * @brief Streaming LZSS compression in a small fixed window
+ *
+ * Heatshrink-class: every byte is either a literal or a back-reference
+ * into the last 2^window_bits bytes, with no heap and no index, so RAM
+ * is the caller's work buffer plus this struct. Input can be fed in any
+ * pieces (lz_compress_sink() takes it straight from a streaming
+ * text_writer); compressed bytes go to a caller buffer.
+ *
+ * Output layout (header little-endian, bit stream MSB first, the last
+ * byte zero-padded):
+ *
+ *   u8  version (LZ_COMPRESS_VERSION)
+ *   u8  window_bits << 4 | lookahead_bits
+ *   u16 uncompressed length
+ *   bits, per token:
+ *     '1' + 8 bits                      literal byte
+ *     '0' + window_bits + lookahead_bits  copy count bytes from distance
+ *                                       back, both stored minus one;
+ *                                       the copy may overlap itself
+ *
+ * scripts/lz_decompress.py decodes it on the ingest side.
+ */
+
+#ifndef LZ_COMPRESS_H
+#define LZ_COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LZ_COMPRESS_VERSION 1
+
+/* Header size in bytes */
+#define LZ_COMPRESS_HEADER_LEN 4
+
+/* Parameter limits */
+#define LZ_COMPRESS_MIN_WINDOW_BITS 4
+#define LZ_COMPRESS_MAX_WINDOW_BITS 12
+#define LZ_COMPRESS_MIN_LOOKAHEAD_BITS 2
+
+/* Work buffer of a window: the history, then as much input again */
+#define LZ_COMPRESS_WORK_SIZE(window_bits) (2U << (window_bits))
+
+/* Worst case output for @p len input bytes: all literals */
+#define LZ_COMPRESS_BOUND(len) (LZ_COMPRESS_HEADER_LEN + ((len) * 9U + 7U) / 8U)
+
+/*
+ * Input stored at this offset of a @p size byte buffer can be compressed
+ * into the start of the same buffer: after k input bytes at most
+ * header + ceil(9k / 8) bytes are written, which stays below the unread
+ * input, and everything fits.
+ */
+#define LZ_COMPRESS_IN_PLACE_OFFSET(size) (LZ_COMPRESS_HEADER_LEN + ((size) + 7U) / 8U)
+
+struct lz_compressor {
+    uint8_t *work;
+    uint8_t *out;
+    size_t out_size;
+    size_t out_len;
+    uint32_t in_len;            /* Bytes fed so far */
+    uint16_t fill;              /* Bytes in work */
+    uint16_t pos;               /* Next byte of work to encode */
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint8_t bit_count;          /* Bits pending in bit_acc */
+    uint32_t bit_acc;
+    int error;                  /* First error, reported by finish */
+};
+
+/**
+ * @brief Start a compressed stream
+ * @param c Compressor
+ * @param work LZ_COMPRESS_WORK_SIZE(window_bits) bytes, kept until finished
+ * @param window_bits log2 of the window, 4..12
+ * @param lookahead_bits log2 of the longest match, 2..window_bits - 1
+ * @param out Output buffer, at least LZ_COMPRESS_HEADER_LEN
+ * @param out_size Size of @p out
+ * @return 0 on success, -EINVAL on bad parameters
+ */
+int lz_compress_init(struct lz_compressor *c, uint8_t *work,
+                     uint8_t window_bits, uint8_t lookahead_bits,
+                     uint8_t *out, size_t out_size);
+
+/**
+ * @brief Compress more input
+ * @return 0 on success, -ENOMEM once the output buffer is full
+ */
+int lz_compress_feed(struct lz_compressor *c, const void *data, size_t len);
+
+/**
+ * @brief text_sink_t that feeds a struct lz_compressor (@p ctx)
+ */
+int lz_compress_sink(const char *data, size_t len, void *ctx);
+
+/**
+ * @brief Flush the last tokens and write the header
+ * @return Compressed length, -ENOMEM if it did not fit, or -EMSGSIZE
+ *         if the input was longer than the header can record
+ */
+int lz_compress_finish(struct lz_compressor *c);
+
+#endif /* LZ_COMPRESS_H */
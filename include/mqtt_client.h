@@ -1,13 +1,38 @@
 #ifndef MQTT_CLIENT_H
 #define MQTT_CLIENT_H
 
+#include <zephyr/kernel.h>
 #include "sensor_manager.h"
+#include "payload_format.h"
+
+struct stats_summary;
+struct vibration_spectrum;
+struct mqtt_qos1_stats;
 
 int app_mqtt_client_init(void);
-int mqtt_client_connect(void);
+int mqtt_client_wait_connected(k_timeout_t timeout);
 void app_mqtt_disconnect(void);
-int mqtt_client_publish_sensor_data(const sensor_data_t *data);
+int mqtt_client_set_format(enum payload_format format);
+int mqtt_client_publish_sensor_data(const sensor_sample_t *sample);
+int mqtt_client_publish_stats(const struct stats_summary *summary);
+int mqtt_client_publish_spectrum(const struct vibration_spectrum *spectrum);
+int mqtt_client_publish_batch(const sensor_sample_t *samples, size_t count);
 bool mqtt_client_is_connected(void);
-void mqtt_client_process(void);
+int mqtt_client_get_qos1_stats(struct mqtt_qos1_stats *stats);
+
+/* Wait for a PUBACK to free a QoS 1 window slot after a publish
+ * returned -EAGAIN. Returns 0 once a slot may be free, -EAGAIN on
+ * timeout, -ENOTCONN when disconnected. QoS 1 only. */
+int mqtt_client_wait_window(k_timeout_t timeout);
+
+/* Called on the MQTT I/O thread when a tagged PUBLISH gets its PUBACK */
+typedef void (*mqtt_client_ack_cb_t)(uint32_t tag, size_t samples);
+
+int mqtt_client_set_ack_callback(mqtt_client_ack_cb_t cb);
+
+/* Publish samples read back from flash, as a batch or one by one, with
+ * every PUBLISH tagged for the ack callback. Returns how many samples
+ * went out, or negative errno if none did. QoS 1 only. */
+int mqtt_client_publish_replay(const sensor_sample_t *samples, size_t count, uint32_t tag);
 
 #endif
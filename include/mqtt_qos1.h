@@ -0,0 +1,114 @@
+/**
+ * @file mqtt_qos1.h
+ * @brief In-flight window of QoS 1 PUBLISH packets
+ *
+ * Bookkeeping only: the MQTT client stores the payloads and does the
+ * sending. Each PUBLISH takes a slot and the next packet identifier,
+ * counting up from 1 and skipping any still in flight, and keeps it until
+ * the matching PUBACK. A slot whose PUBACK is overdue is reported by
+ * mqtt_qos1_next_due() for retransmission with DUP set.
+ *
+ * Round-trip times are taken only from packets acked on their first
+ * transmission, since the PUBACK of a resent packet may answer either copy.
+ * All times are k_uptime_get_32() milliseconds.
+ */
+
+#ifndef MQTT_QOS1_H
+#define MQTT_QOS1_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct mqtt_qos1_stats {
+    uint32_t in_flight;         /* PUBLISHes waiting for PUBACK */
+    uint32_t in_flight_peak;
+    uint32_t sent;              /* First transmissions */
+    uint32_t acked;
+    uint32_t retransmits;
+    uint32_t window_full;       /* PUBLISHes refused for want of a slot */
+    uint32_t rtt_last_ms;
+    uint32_t rtt_avg_ms;        /* Moving average, new samples weigh 1/8 */
+    uint32_t rtt_max_ms;
+};
+
+struct mqtt_qos1_slot {
+    uint32_t sent_ms;           /* Last transmission */
+    uint16_t id;                /* Packet identifier, 0 when free */
+    uint8_t retries;            /* Timeouts since the last (re)connect */
+    bool sent;                  /* Reserved slots are not in flight yet */
+    bool dup;                   /* Sent more than once */
+};
+
+struct mqtt_qos1_window {
+    struct mqtt_qos1_slot slots[CONFIG_APP_MQTT_QOS1_WINDOW];
+    uint32_t timeout_ms;        /* PUBACK wait before a retransmission */
+    uint16_t last_id;
+    struct mqtt_qos1_stats stats;
+};
+
+/**
+ * @brief Initialize an empty window
+ * @param window Window
+ * @param timeout_ms How long to wait for a PUBACK before resending
+ */
+void mqtt_qos1_init(struct mqtt_qos1_window *window, uint32_t timeout_ms);
+
+/**
+ * @brief Take a slot and a packet identifier for a new PUBLISH
+ *
+ * The slot is only in flight once mqtt_qos1_sent() records it; give it
+ * back with mqtt_qos1_release() if the send fails.
+ *
+ * @param window Window
+ * @param id Receives the packet identifier
+ * @return Slot index, or -EAGAIN if every slot is in flight
+ */
+int mqtt_qos1_reserve(struct mqtt_qos1_window *window, uint16_t *id);
+
+/**
+ * @brief Record the first transmission of a reserved slot
+ * @param window Window
+ * @param slot Slot from mqtt_qos1_reserve()
+ * @param now_ms Current time
+ */
+void mqtt_qos1_sent(struct mqtt_qos1_window *window, int slot, uint32_t now_ms);
+
+/**
+ * @brief Free a reserved slot whose PUBLISH could not be sent
+ * @param window Window
+ * @param slot Slot from mqtt_qos1_reserve()
+ */
+void mqtt_qos1_release(struct mqtt_qos1_window *window, int slot);
+
+/**
+ * @brief Match a PUBACK and free its slot
+ * @param window Window
+ * @param id Packet identifier of the PUBACK
+ * @param now_ms Current time
+ * @return Slot index that was freed, or -ENOENT for an unknown identifier
+ */
+int mqtt_qos1_ack(struct mqtt_qos1_window *window, uint16_t id, uint32_t now_ms);
+
+/**
+ * @brief Find a slot whose PUBACK is overdue
+ * @param window Window
+ * @param now_ms Current time
+ * @param wait_ms Receives the time until the next slot falls due, or -1
+ *                if nothing is in flight; only set when no slot is due
+ * @return Index of an overdue slot, or -ENOENT
+ */
+int mqtt_qos1_next_due(const struct mqtt_qos1_window *window, uint32_t now_ms,
+                       int32_t *wait_ms);
+
+/**
+ * @brief Record a retransmission of an in-flight slot
+ * @param window Window
+ * @param slot Slot being resent
+ * @param now_ms Current time
+ * @param timeout true if resent because its PUBACK was overdue, false if
+ *                resent after a reconnect, which restarts its retry count
+ */
+void mqtt_qos1_resent(struct mqtt_qos1_window *window, int slot, uint32_t now_ms,
+                      bool timeout);
+
+#endif /* MQTT_QOS1_H */
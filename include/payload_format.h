@@ -0,0 +1,21 @@
+/**
+ * @file payload_format.h
+ * @brief Wire formats for sensor payloads
+ */
+
+#ifndef PAYLOAD_FORMAT_H
+#define PAYLOAD_FORMAT_H
+
+enum payload_format {
+    PAYLOAD_FORMAT_JSON,
+    PAYLOAD_FORMAT_CBOR,        /* Integer keys, see cbor_encoder.c */
+};
+
+/* Format used by every transport until changed at runtime */
+#ifdef CONFIG_APP_PAYLOAD_FORMAT_CBOR
+#define PAYLOAD_FORMAT_DEFAULT PAYLOAD_FORMAT_CBOR
+#else
+#define PAYLOAD_FORMAT_DEFAULT PAYLOAD_FORMAT_JSON
+#endif
+
+#endif /* PAYLOAD_FORMAT_H */
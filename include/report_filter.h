@@ -0,0 +1,81 @@
+/**
+ * @file report_filter.h
+ * @brief Send-on-delta filter for sensor uplinks
+ *
+ * Each transport owns one filter. A sample is reported only when a
+ * channel moved beyond its deadband since the last reported sample, a
+ * channel became valid, or the heartbeat interval expired. Everything
+ * else is counted as suppressed.
+ */
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_manager.h"
+
+/* Per-channel deadband, in the channel's integer unit (cc, mg, mV) */
+struct report_deadband {
+    uint16_t absolute;          /* Minimum change worth reporting */
+    uint16_t relative_permille; /* Of the last reported value, 0 = off */
+};
+
+struct report_filter_config {
+    struct report_deadband deadband[SENSOR_CHANNEL_COUNT];
+    uint32_t heartbeat_ms;      /* Report at least this often, 0 = never */
+};
+
+struct report_filter {
+    const char *name;
+    const struct report_filter_config *config;
+    sensor_sample_t reference;  /* Last sample actually sent */
+    bool has_reference;
+    uint32_t sent;
+    uint32_t suppressed;
+    uint32_t heartbeats;        /* Sends forced only by the heartbeat */
+};
+
+/* Deadbands and heartbeat from CONFIG_APP_REPORT_* */
+extern const struct report_filter_config report_filter_default_config;
+
+/**
+ * @brief Initialize a filter; the first sample is always reported
+ * @param filter Filter to initialize
+ * @param name Name used in logs
+ * @param config Deadbands and heartbeat, must outlive the filter
+ */
+void report_filter_init(struct report_filter *filter, const char *name,
+                        const struct report_filter_config *config);
+
+/**
+ * @brief Decide whether a sample is worth transmitting
+ *
+ * A false return is counted as a suppressed transmission. A true return
+ * must be followed by report_filter_commit() once the send succeeded,
+ * so a failed send is retried on the next sample.
+ *
+ * @param filter Filter
+ * @param sample Candidate sample
+ * @return true if the sample should be sent
+ */
+bool report_filter_check(struct report_filter *filter, const sensor_sample_t *sample);
+
+/**
+ * @brief Record a sample as sent and make it the new reference
+ * @param filter Filter
+ * @param sample Sample that was transmitted
+ */
+void report_filter_commit(struct report_filter *filter, const sensor_sample_t *sample);
+
+/**
+ * @brief Forget the reference so the next sample is reported
+ *
+ * Used when the link drops, so a reconnecting peer gets fresh data
+ * immediately instead of waiting for a change or the heartbeat.
+ *
+ * @param filter Filter
+ */
+void report_filter_reset(struct report_filter *filter);
+
+#endif /* REPORT_FILTER_H */
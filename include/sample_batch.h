@@ -0,0 +1,56 @@
+/**
+ * @file sample_batch.h
+ * @brief Row layout shared by the batched JSON and CBOR encoders
+ *
+ * A batch is one header (device id, version, base timestamp) followed by
+ * one row per compact sample:
+ *
+ *   [dt_ms, temperature_cc, accel_x_mg, accel_y_mg, accel_z_mg, battery_mv, valid_mask]
+ *
+ * (the values being those of SAMPLE_FIELDS, in order).
+ *
+ * dt_ms is the time since the previous row (the first row's is 0, i.e.
+ * the base timestamp). The five values are differences from the previous
+ * row; the first row's are absolute. valid_mask is sent as is. A
+ * decoder restores each sample by a running sum down the rows.
+ */
+
+#ifndef SAMPLE_BATCH_H
+#define SAMPLE_BATCH_H
+
+#include <stdint.h>
+#include "sensor_manager.h"
+
+/* Delta-coded values per row, between dt_ms and valid_mask */
+#define SAMPLE_BATCH_VALUES SAMPLE_VALUE_COUNT
+
+struct sample_batch_row {
+    uint32_t dt_ms;
+    int32_t delta[SAMPLE_BATCH_VALUES];
+    uint8_t valid_mask;
+};
+
+/**
+ * @brief Build the row of @p cur
+ * @param prev Previous sample of the batch, NULL for the first row
+ * @param cur Sample to encode
+ * @param row Row to fill
+ */
+static inline void sample_batch_row(const sensor_sample_t *prev, const sensor_sample_t *cur,
+                                    struct sample_batch_row *row)
+{
+    static const sensor_sample_t zero;
+    const sensor_sample_t *ref = prev ? prev : &zero;
+    int32_t base[SAMPLE_BATCH_VALUES];
+
+    sample_schema_values(ref, base);
+    sample_schema_values(cur, row->delta);
+
+    row->dt_ms = prev ? cur->timestamp_ms - prev->timestamp_ms : 0;
+    for (int v = 0; v < SAMPLE_BATCH_VALUES; v++) {
+        row->delta[v] -= base[v];
+    }
+    row->valid_mask = cur->valid_mask;
+}
+
+#endif /* SAMPLE_BATCH_H */
@@ -0,0 +1,106 @@
+/**
+ * @file sample_bus.h
+ * @brief Multi-subscriber fan-out of sensor samples
+ *
+ * The sensor thread publishes each sample once into a pooled,
+ * reference-counted buffer. Every subscriber gets a pointer to that
+ * same buffer in its own queue and releases it when done, so a slow
+ * consumer never stalls sampling.
+ */
+
+#ifndef SAMPLE_BUS_H
+#define SAMPLE_BUS_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include "sensor_manager.h"
+
+/* Pooled sample shared by all subscribers (read-only for them) */
+struct sample_buf {
+    atomic_t refcount;
+    sensor_sample_t sample;
+};
+
+/* What to do when a subscriber's queue is full */
+enum sample_bus_overflow {
+    SAMPLE_BUS_DROP_NEWEST,   /* Keep queued samples, drop the incoming one */
+    SAMPLE_BUS_DROP_OLDEST,   /* Evict the oldest queued sample */
+};
+
+/* Subscriber, usually declared with SAMPLE_BUS_SUBSCRIBER_DEFINE() */
+struct sample_bus_subscriber {
+    sys_snode_t node;
+    const char *name;
+    uint8_t priority;                   /* Lower value is served first */
+    enum sample_bus_overflow overflow;
+    struct k_msgq *queue;               /* Holds struct sample_buf pointers */
+    uint32_t delivered;                 /* Samples queued to this subscriber */
+    uint32_t dropped;                   /* Samples lost to overflow */
+};
+
+/* Bus-wide counters */
+struct sample_bus_stats {
+    uint32_t published;                 /* Samples accepted by the bus */
+    uint32_t no_buffer;                 /* Samples lost to pool exhaustion */
+};
+
+/**
+ * @brief Define a subscriber and its queue
+ * @param _name Subscriber variable name
+ * @param _depth Queue depth in samples
+ * @param _priority Delivery order, lower first
+ * @param _overflow enum sample_bus_overflow policy
+ */
+#define SAMPLE_BUS_SUBSCRIBER_DEFINE(_name, _depth, _priority, _overflow)        \
+    K_MSGQ_DEFINE(_name##_queue, sizeof(struct sample_buf *), _depth,            \
+                  sizeof(void *));                                               \
+    struct sample_bus_subscriber _name = {                                       \
+        .name = #_name,                                                          \
+        .priority = _priority,                                                   \
+        .overflow = _overflow,                                                   \
+        .queue = &_name##_queue,                                                 \
+    }
+
+/**
+ * @brief Attach a subscriber to the bus
+ * @param sub Subscriber
+ * @return 0 on success, negative errno on failure
+ */
+int sample_bus_subscribe(struct sample_bus_subscriber *sub);
+
+/**
+ * @brief Detach a subscriber and release every sample still queued to it
+ * @param sub Subscriber
+ * @return 0 on success, -ENOENT if it was not subscribed
+ */
+int sample_bus_unsubscribe(struct sample_bus_subscriber *sub);
+
+/**
+ * @brief Publish a sample to every subscriber without blocking
+ * @param sample Sample to publish (copied once into a pool buffer)
+ * @return 0 on success, -ENOMEM if the pool is exhausted
+ */
+int sample_bus_publish(const sensor_sample_t *sample);
+
+/**
+ * @brief Wait for the next sample queued to a subscriber
+ * @param sub Subscriber
+ * @param timeout How long to wait
+ * @return Sample buffer to hand back with sample_bus_release(), or NULL on timeout
+ */
+struct sample_buf *sample_bus_receive(struct sample_bus_subscriber *sub,
+                                      k_timeout_t timeout);
+
+/**
+ * @brief Drop a reference obtained from sample_bus_receive()
+ * @param buf Sample buffer
+ */
+void sample_bus_release(struct sample_buf *buf);
+
+/**
+ * @brief Get bus-wide counters
+ * @param stats Counters to fill
+ */
+void sample_bus_get_stats(struct sample_bus_stats *stats);
+
+#endif /* SAMPLE_BUS_H */
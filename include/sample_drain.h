@@ -0,0 +1,65 @@
+/**
+ * @file sample_drain.h
+ * @brief Drain the sample history ring into a windowed uplink
+ *
+ * One drain per uplink reads every sample since its last pass through
+ * its own history cursor. A send refused because the uplink's in-flight
+ * window is full waits for a slot, within a wait budget per pass. Once
+ * the budget is spent, or the uplink is down, the rest of the pass goes
+ * to the store, so the ring never overruns a stalled uplink. Without a
+ * store they stay in the ring for the next pass.
+ */
+
+#ifndef SAMPLE_DRAIN_H
+#define SAMPLE_DRAIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include "sensor_manager.h"
+
+struct sample_drain_ops {
+    /* 0 once the sample is sent or needs no sending, -EAGAIN if the
+     * window is full, other negative errno if the uplink failed */
+    int (*send)(const sensor_sample_t *sample, void *ctx);
+    /* 0 once a window slot may be free, -EAGAIN on timeout */
+    int (*wait)(k_timeout_t timeout, void *ctx);
+    /* Keep a sample the uplink could not take, 0 on success; may be NULL */
+    int (*store)(const sensor_sample_t *sample, void *ctx);
+};
+
+struct sample_drain_stats {
+    uint32_t sent;              /* Samples send() accepted */
+    uint32_t stored;            /* Samples handed to store() */
+    uint32_t lost;              /* Samples store() failed on */
+    uint32_t waits;             /* Waits for a window slot */
+    uint32_t stalls;            /* Passes that spent their wait budget */
+};
+
+struct sample_drain {
+    sensor_cursor_t cursor;
+    const struct sample_drain_ops *ops;
+    void *ctx;
+    uint32_t wait_budget_ms;    /* Window waits allowed per pass */
+    struct sample_drain_stats stats;
+};
+
+/**
+ * @brief Initialize a drain on the next sample to be published
+ * @param drain Drain to initialize
+ * @param ops Uplink operations, must outlive the drain
+ * @param ctx Passed to every operation
+ * @param wait_budget_ms Longest total wait for window slots in one pass
+ */
+void sample_drain_init(struct sample_drain *drain, const struct sample_drain_ops *ops,
+                       void *ctx, uint32_t wait_budget_ms);
+
+/**
+ * @brief Hand every sample published since the last pass to the uplink
+ * @param drain Drain
+ * @param connected false to send nothing and store every sample
+ * @return Samples consumed from the ring in this pass
+ */
+int sample_drain_run(struct sample_drain *drain, bool connected);
+
+#endif /* SAMPLE_DRAIN_H */
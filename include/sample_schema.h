@@ -0,0 +1,134 @@
+/**
+ * @file sample_schema.h
+ * @brief Single definition of the sensor sample fields
+ *
+ * SAMPLE_FIELDS lists every value channel of a sample once. The compact
+ * sample and its float view are generated from it, and so is every wire
+ * encoder (JSON, compact JSON, CBOR, packed BLE record, batch rows,
+ * ts_compress) and the console display. scripts/sample_schema.py parses
+ * this file for the host-side decoders. Adding a channel is one X() line;
+ * new lines go at the end so existing binary layouts only grow.
+ *
+ * X(name, type, n, value, mul, div, unit, label, json, keys, dec, cdec, cbor, chan)
+ *
+ *   name   sensor_sample_t member, in the integer unit its suffix names
+ *   type   integer type of the member (16-bit: ts_compress relies on it)
+ *   n      components: 1 for a scalar, else the member is type[n]
+ *   value  sensor_data_t member, float (float[n])
+ *   mul    float = (float)integer * mul / div
+ *   div
+ *   unit   unit of the float value, for the console
+ *   label  console label
+ *   json   key in the "sensors" object of the JSON record
+ *   keys   one character per component: compact JSON keys, and for n > 1
+ *          also the component keys of the JSON object
+ *   dec    decimals of the JSON record (CBOR halves stay within them)
+ *   cdec   decimals of the compact JSON and the console
+ *   cbor   CBOR map key (4-6 taken; 1-3 and 7 are metadata and rows)
+ *   chan   sensor channel, as SENSOR_CHANNEL_<chan>: the valid_mask bit
+ *          and the report deadband that apply to every component
+ */
+
+#ifndef SAMPLE_SCHEMA_H
+#define SAMPLE_SCHEMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Conversion factors between the compact and float representations */
+#define SENSOR_MS2_PER_MG         0.00981f
+
+#define SAMPLE_FIELDS(X)                                                          \
+    X(temperature_cc, int16_t,  1, temperature_c,   1.0f, 100.0f, "°C", "Temperature", \
+      "temperature", "t", 2, 1, 4, TEMP)                                           \
+    X(accel_mg,       int16_t,  3, accel,           SENSOR_MS2_PER_MG, 1.0f, "m/s²",   \
+      "Accelerometer", "accelerometer", "xyz", 3, 2, 5, ACCEL)                     \
+    X(battery_mv,     uint16_t, 1, battery_voltage, 1.0f, 1000.0f, "V", "Battery",      \
+      "battery", "b", 2, 2, 6, BATTERY)
+
+/* Declarator suffix of an n-component member */
+#define SAMPLE_DIM(n) SAMPLE_DIM_##n
+#define SAMPLE_DIM_1
+#define SAMPLE_DIM_2 [2]
+#define SAMPLE_DIM_3 [3]
+#define SAMPLE_DIM_4 [4]
+
+/* Components of a field as an array, whatever its n */
+#define SAMPLE_COMPONENTS(ptr, name, type) ((const type *)&(ptr)->name)
+
+#define SAMPLE_X_COUNT(name, type, n, ...) + 1
+#define SAMPLE_X_VALUES(name, type, n, ...) + (n)
+#define SAMPLE_X_BYTES(name, type, n, ...) + (n) * sizeof(type)
+
+/* Number of fields */
+#define SAMPLE_FIELD_COUNT (0 SAMPLE_FIELDS(SAMPLE_X_COUNT))
+
+/* Number of values, counting each component */
+#define SAMPLE_VALUE_COUNT (0 SAMPLE_FIELDS(SAMPLE_X_VALUES))
+
+/* Bytes of all values at their integer width */
+#define SAMPLE_VALUE_BYTES (0 SAMPLE_FIELDS(SAMPLE_X_BYTES))
+
+/*
+ * Compact fixed-point sample (16 bytes). Used by the history ring and
+ * every queue; floats only appear at the edges via sensor_data_t.
+ */
+#define SAMPLE_X_MEMBER(name, type, n, ...) type name SAMPLE_DIM(n);
+typedef struct {
+    uint32_t timestamp_ms;    /* Timestamp in milliseconds */
+    SAMPLE_FIELDS(SAMPLE_X_MEMBER)
+    uint8_t valid_mask;       /* Channels whose last read succeeded */
+    uint8_t fresh_mask;       /* Channels sampled for this record */
+} sensor_sample_t;
+#undef SAMPLE_X_MEMBER
+
+/* Sensor data structure (float view of a sample) */
+#define SAMPLE_X_VALUE(name, type, n, value, ...) float value SAMPLE_DIM(n);
+typedef struct {
+    SAMPLE_FIELDS(SAMPLE_X_VALUE)
+    uint32_t timestamp_ms;    /* Timestamp in milliseconds */
+    bool valid;               /* Data validity flag */
+    uint8_t valid_mask;       /* Channels whose last read succeeded */
+    uint8_t fresh_mask;       /* Channels sampled for this record */
+} sensor_data_t;
+#undef SAMPLE_X_VALUE
+
+/**
+ * @brief Flatten the values of a sample, in schema order
+ * @param sample Sample
+ * @param values SAMPLE_VALUE_COUNT values to fill
+ */
+static inline void sample_schema_values(const sensor_sample_t *sample, int32_t *values)
+{
+    int32_t *out = values;
+
+#define SAMPLE_X_FLATTEN(name, type, n, ...)                              \
+    for (int i = 0; i < (n); i++) {                                       \
+        *out++ = SAMPLE_COMPONENTS(sample, name, type)[i];                \
+    }
+    SAMPLE_FIELDS(SAMPLE_X_FLATTEN)
+#undef SAMPLE_X_FLATTEN
+}
+
+/**
+ * @brief Convert a compact sample to its float view
+ * @param sample Compact sample
+ * @param data Float representation to fill
+ */
+static inline void sensor_sample_to_data(const sensor_sample_t *sample, sensor_data_t *data)
+{
+#define SAMPLE_X_TO_FLOAT(name, type, n, value, mul, div, ...)                  \
+    for (int i = 0; i < (n); i++) {                                             \
+        ((float *)&data->value)[i] =                                            \
+            (float)SAMPLE_COMPONENTS(sample, name, type)[i] * (mul) / (div);    \
+    }
+    SAMPLE_FIELDS(SAMPLE_X_TO_FLOAT)
+#undef SAMPLE_X_TO_FLOAT
+
+    data->timestamp_ms = sample->timestamp_ms;
+    data->valid = (sample->valid_mask != 0);
+    data->valid_mask = sample->valid_mask;
+    data->fresh_mask = sample->fresh_mask;
+}
+
+#endif /* SAMPLE_SCHEMA_H */
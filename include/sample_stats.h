@@ -0,0 +1,79 @@
+/**
+ * @file sample_stats.h
+ * @brief Streaming windowed statistics over sensor samples
+ *
+ * Samples are accumulated into the shortest window in O(1) per sample
+ * (integer count, min, max, sum and sum of squares). When a window
+ * closes its accumulator is merged into the next, longer window, so
+ * every window length costs O(1) per window close, never per sample.
+ */
+
+#ifndef SAMPLE_STATS_H
+#define SAMPLE_STATS_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include "sensor_manager.h"
+
+/* Channels aggregated by the statistics engine */
+typedef enum {
+    STATS_CHANNEL_TEMP,
+    STATS_CHANNEL_ACCEL_X,
+    STATS_CHANNEL_ACCEL_Y,
+    STATS_CHANNEL_ACCEL_Z,
+    STATS_CHANNEL_COUNT
+} stats_channel_t;
+
+/* Number of window lengths (CONFIG_APP_STATS_WINDOW{1,2,3}_MS) */
+#define STATS_WINDOW_COUNT 3
+
+/* Summary of one channel over one window, in °C or m/s² */
+struct stats_channel_summary {
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float variance;
+    float rms;
+    float peak_to_peak;
+};
+
+/* Summary of all channels over one closed window */
+struct stats_summary {
+    uint32_t window_ms;
+    uint32_t start_ms;
+    struct stats_channel_summary ch[STATS_CHANNEL_COUNT];
+};
+
+/**
+ * @brief Subscribe to the sample bus and start the statistics thread
+ * @return 0 on success, negative errno on failure
+ */
+int sample_stats_start(void);
+
+/**
+ * @brief Feed one sample (called by the statistics thread)
+ *
+ * Exposed so the engine can be driven directly, e.g. from benchmarks.
+ *
+ * @param sample Sample; only channels in fresh_mask are accumulated
+ */
+void sample_stats_add(const sensor_sample_t *sample);
+
+/**
+ * @brief Get the most recent summary of a window length
+ * @param window Window index (0 = shortest)
+ * @param summary Summary to fill
+ * @return 0 on success, -ENODATA if that window has not closed yet
+ */
+int sample_stats_get_latest(int window, struct stats_summary *summary);
+
+/**
+ * @brief Take the next summary queued for uplink (CONFIG_APP_STATS_UPLINK_WINDOW)
+ * @param summary Summary to fill
+ * @param timeout How long to wait
+ * @return 0 on success, -EAGAIN if none is available
+ */
+int sample_stats_get_summary(struct stats_summary *summary, k_timeout_t timeout);
+
+#endif /* SAMPLE_STATS_H */
@@ -0,0 +1,126 @@
+/**
+ * @file sensor_drivers.h
+ * @brief Low-level sensor driver API (subsys/sensors)
+ */
+
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/**
+ * @brief Completion callback for asynchronous sensor reads
+ *
+ * Called exactly once per accepted request, possibly from the bus
+ * driver's interrupt context: keep it short and do not block.
+ *
+ * @param result 0 on success, negative errno on bus failure
+ * @param user_data Pointer passed at submission
+ */
+typedef void (*sensor_read_cb_t)(int result, void *user_data);
+
+/* I²C temperature sensor */
+int i2c_temp_sensor_init(void);
+int i2c_temp_sensor_read(float *temp_c);
+
+/**
+ * @brief Start a non-blocking temperature read
+ * @param raw Where the raw register value is stored on success
+ * @param cb Completion callback
+ * @param user_data Passed to cb
+ * @return 0 if submitted, -EBUSY if a read is already in flight, negative errno on failure
+ */
+int i2c_temp_sensor_read_async(int16_t *raw, sensor_read_cb_t cb, void *user_data);
+
+/**
+ * @brief Convert a raw temperature register value to °C
+ */
+float i2c_temp_sensor_raw_to_celsius(int16_t raw);
+
+/**
+ * @brief Convert a raw temperature register value to centi-degrees Celsius
+ */
+int16_t i2c_temp_sensor_raw_to_cc(int16_t raw);
+
+/* Nominal scale in Q15: 1/128 °C per LSB = 0.78125 cc per LSB */
+#define I2C_TEMP_SENSOR_CC_PER_LSB_Q15 25600
+
+/* SPI accelerometer */
+int spi_accel_sensor_init(void);
+int spi_accel_sensor_read(float *x, float *y, float *z);
+
+/* Raw accelerometer sample as delivered by the hardware FIFO */
+struct accel_raw_frame {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+/**
+ * @brief Start a non-blocking single-frame accelerometer read
+ * @param frame Where the raw frame is stored on success
+ * @param cb Completion callback
+ * @param user_data Passed to cb
+ * @return 0 if submitted, -EBUSY if a read is already in flight, negative errno on failure
+ */
+int spi_accel_sensor_read_async(struct accel_raw_frame *frame,
+                                sensor_read_cb_t cb, void *user_data);
+
+/* Depth of the accelerometer hardware FIFO in frames */
+#define ACCEL_FIFO_DEPTH 32
+
+/**
+ * @brief Switch the accelerometer to FIFO stream mode
+ * @param odr_hz Output data rate (25, 50, 100, 200, 400, 800, 1600 or 3200 Hz)
+ * @param watermark FIFO level that raises the watermark flag (1..31)
+ * @return 0 on success, negative errno on failure
+ */
+int spi_accel_sensor_stream_start(uint16_t odr_hz, uint8_t watermark);
+
+/**
+ * @brief Return the accelerometer to single-sample (bypass) mode
+ * @return 0 on success, negative errno on failure
+ */
+int spi_accel_sensor_stream_stop(void);
+
+/**
+ * @brief Drain the hardware FIFO into a caller-supplied buffer
+ * @param frames Output array of raw frames
+ * @param max_frames Capacity of frames
+ * @return Number of frames read, or negative errno on failure
+ */
+int spi_accel_sensor_fifo_read(struct accel_raw_frame *frames, size_t max_frames);
+
+/**
+ * @brief Convert a raw accelerometer count to m/s²
+ */
+float spi_accel_sensor_raw_to_ms2(int16_t raw);
+
+/**
+ * @brief Convert a raw accelerometer count to milli-g
+ */
+int16_t spi_accel_sensor_raw_to_mg(int16_t raw);
+
+/* Nominal scale in Q15: 3.9 mg per LSB */
+#define SPI_ACCEL_SENSOR_MG_PER_LSB_Q15 127795
+
+/* ADC battery monitor */
+int adc_battery_init(void);
+int adc_battery_read(float *voltage_v);
+
+/**
+ * @brief Start a non-blocking battery voltage conversion
+ * @param millivolts Where the battery voltage is stored on success
+ * @param cb Completion callback
+ * @param user_data Passed to cb
+ * @return 0 if submitted, -EBUSY if a conversion is already in flight, negative errno on failure
+ */
+int adc_battery_read_async(uint16_t *millivolts, sensor_read_cb_t cb, void *user_data);
+
+/**
+ * @brief Convert battery millivolts to volts
+ */
+float adc_battery_mv_to_volts(uint16_t millivolts);
+
+#endif /* SENSOR_DRIVERS_H */
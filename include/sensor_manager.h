@@ -8,17 +8,25 @@
 
 #include <zephyr/kernel.h>
 #include <stdint.h>
+#include "sample_schema.h"
 
-/* Sensor data structure */
+/* Sensor channels, each sampled on its own schedule */
+typedef enum {
+    SENSOR_CHANNEL_TEMP,
+    SENSOR_CHANNEL_ACCEL,
+    SENSOR_CHANNEL_BATTERY,
+    SENSOR_CHANNEL_COUNT
+} sensor_channel_t;
+
+/* Bit of a channel in sensor_data_t valid_mask / fresh_mask */
+#define SENSOR_FIELD(channel)     (1U << (channel))
+#define SENSOR_FIELD_ALL          ((1U << SENSOR_CHANNEL_COUNT) - 1U)
+
+/* Per-consumer read position in the sample history ring */
 typedef struct {
-    float temperature_c;      /* Temperature in Celsius */
-    float accel_x;            /* Accelerometer X-axis (m/s²) */
-    float accel_y;            /* Accelerometer Y-axis (m/s²) */
-    float accel_z;            /* Accelerometer Z-axis (m/s²) */
-    float battery_voltage;    /* Battery voltage (V) */
-    uint32_t timestamp_ms;    /* Timestamp in milliseconds */
-    bool valid;               /* Data validity flag */
-} sensor_data_t;
+    uint32_t next;            /* Sequence number of the next sample to read */
+    uint32_t dropped;         /* Samples overwritten before they were read */
+} sensor_cursor_t;
 
 /**
  * @brief Initialize sensor manager and all sensors
@@ -45,10 +53,45 @@ void sensor_manager_stop(void);
 int sensor_manager_get_data(sensor_data_t *data);
 
 /**
- * @brief Register callback for new sensor data
- * @param callback Function to call when new data is available
+ * @brief Get the latest compact sample
+ * @param sample Sample to fill
+ * @return 0 on success, -ENODATA if nothing has been sampled yet
+ */
+int sensor_manager_get_sample(sensor_sample_t *sample);
+
+/**
+ * @brief Position a cursor on the next sample to be published
+ * @param cursor Cursor owned by the calling consumer
+ */
+void sensor_manager_cursor_init(sensor_cursor_t *cursor);
+
+/**
+ * @brief Copy every sample published since the cursor's position
+ *
+ * Never blocks the sampling thread. If the consumer fell more than
+ * SENSOR_HISTORY_SIZE samples behind, the oldest samples are skipped
+ * and counted in cursor->dropped.
+ *
+ * @param cursor Cursor owned by the calling consumer, advanced on return
+ * @param buf Output array of samples
+ * @param n Capacity of buf in samples
+ * @return Number of samples copied, or negative errno on failure
+ */
+int sensor_manager_read_since(sensor_cursor_t *cursor, sensor_sample_t *buf, size_t n);
+
+/**
+ * @brief Change a channel's sampling period at runtime
+ * @param channel Sensor channel
+ * @param period_ms New period in milliseconds, 0 to stop sampling the channel
+ * @return 0 on success, negative errno on failure
+ */
+int sensor_manager_set_period(sensor_channel_t channel, uint32_t period_ms);
+
+/**
+ * @brief Get a channel's current sampling period
+ * @param channel Sensor channel
+ * @return Period in milliseconds (0 if disabled)
  */
-typedef void (*sensor_data_callback_t)(const sensor_data_t *data);
-void sensor_manager_register_callback(sensor_data_callback_t callback);
+uint32_t sensor_manager_get_period(sensor_channel_t channel);
 
 #endif /* SENSOR_MANAGER_H */
\ No newline at end of file
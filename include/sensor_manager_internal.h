@@ -0,0 +1,35 @@
+/**
+ * @file sensor_manager_internal.h
+ * @brief Sampling cycle internals of sensor_manager.c, for the tests
+ *
+ * These are file-local in the application. Built with CONFIG_ZTEST they
+ * get external linkage, so tests/ can run one sampling cycle or one
+ * history publish directly, without the sensor thread's schedule.
+ */
+
+#ifndef SENSOR_MANAGER_INTERNAL_H
+#define SENSOR_MANAGER_INTERNAL_H
+
+#include <stdint.h>
+#include "sensor_manager.h"
+
+#ifdef CONFIG_ZTEST
+#define SENSOR_MGR_INTERNAL
+#else
+#define SENSOR_MGR_INTERNAL static
+#endif
+
+/**
+ * @brief Publish a sample into the history ring (one producer at a time)
+ * @param sample Sample to publish
+ */
+SENSOR_MGR_INTERNAL void history_publish(const sensor_sample_t *sample);
+
+/**
+ * @brief Sample the @p due channels, all bus transfers in flight together
+ * @param due Bitmask of SENSOR_FIELD() channels to read
+ * @param sample Record updated with the results and their masks
+ */
+SENSOR_MGR_INTERNAL void sample_channels(uint8_t due, sensor_sample_t *sample);
+
+#endif /* SENSOR_MANAGER_INTERNAL_H */
@@ -0,0 +1,90 @@
+/**
+ * @file sensor_pipeline.h
+ * @brief Fixed-point processing chain between the drivers and the sensor manager
+ *
+ * Each channel runs raw driver counts through three integer stages:
+ *  1. calibration: (raw - offset) × gain, gain in Q15, which also
+ *     carries the nominal counts-to-unit scale (cc, mg, mV);
+ *  2. a second-order Butterworth low-pass, Q30 coefficients, state
+ *     kept with PIPELINE_FRAC_BITS extra fractional bits;
+ *  3. decimation by an integer factor.
+ * Only the calibration is runtime-tunable and, with CONFIG_SETTINGS,
+ * persisted under "pipeline/cal".
+ */
+
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Scalar channels of the pipeline; the accelerometer has one per axis */
+typedef enum {
+    PIPELINE_CHANNEL_TEMP,
+    PIPELINE_CHANNEL_ACCEL_X,
+    PIPELINE_CHANNEL_ACCEL_Y,
+    PIPELINE_CHANNEL_ACCEL_Z,
+    PIPELINE_CHANNEL_BATTERY,
+    PIPELINE_CHANNEL_COUNT
+} pipeline_channel_t;
+
+/* Fractional bits carried through the filter state */
+#define PIPELINE_FRAC_BITS 8
+
+/* Q15 gain of 1.0 */
+#define PIPELINE_GAIN_ONE (1 << 15)
+
+/* output = (raw - offset) × gain_q15 / 2^15 */
+struct pipeline_calibration {
+    int32_t offset;             /* Raw counts */
+    int32_t gain_q15;
+};
+
+/**
+ * @brief Compute filter coefficients and load stored calibration
+ * @return 0 on success, negative errno on failure
+ */
+int sensor_pipeline_init(void);
+
+/**
+ * @brief Push one raw value through a channel's chain
+ *
+ * Integer-only; called from the sampling thread for every raw reading,
+ * including each frame of an accelerometer FIFO burst.
+ *
+ * @param channel Channel
+ * @param raw Raw driver value
+ * @param out Receives the calibrated, filtered value when one is emitted
+ * @return true if the decimator emitted a value into @p out
+ */
+bool sensor_pipeline_process(pipeline_channel_t channel, int32_t raw, int16_t *out);
+
+/**
+ * @brief Clear a channel's filter and decimator state
+ *
+ * The next raw value re-primes the filter instead of ramping from zero.
+ *
+ * @param channel Channel
+ */
+void sensor_pipeline_reset(pipeline_channel_t channel);
+
+/**
+ * @brief Replace and persist a channel's calibration
+ * @param channel Channel
+ * @param cal New offset and gain
+ * @return 0 on success, negative errno if it could not be stored
+ *         (the new calibration is applied regardless)
+ */
+int sensor_pipeline_set_calibration(pipeline_channel_t channel,
+                                    const struct pipeline_calibration *cal);
+
+/**
+ * @brief Get a channel's current calibration
+ * @param channel Channel
+ * @param cal Calibration to fill
+ * @return 0 on success, -EINVAL on a bad channel
+ */
+int sensor_pipeline_get_calibration(pipeline_channel_t channel,
+                                    struct pipeline_calibration *cal);
+
+#endif /* SENSOR_PIPELINE_H */
@@ -0,0 +1,91 @@
+/**
+ * @file store_forward.h
+ * @brief Flash log of samples the MQTT uplink could not send
+ *
+ * While the broker is unreachable the main loop appends samples to a
+ * flash circular buffer (FCB) on the store_partition. Each record holds
+ * a sequence number and the compact sample. Once connected, the main
+ * loop reads the oldest records with store_forward_peek() and publishes
+ * them at QoS 1. Only when the broker has acknowledged every PUBLISH of
+ * the group does it confirm them with store_forward_ack(), so a sample
+ * reaches the broker at least once even if the node resets in between.
+ *
+ * The sequence number of the last confirmed record is the replay cursor;
+ * with CONFIG_SETTINGS it is saved on every ack and restored on boot.
+ * Sectors whose records are all confirmed are erased right away. When
+ * the log is full the oldest sector is erased to make room and its
+ * unsent records are counted as dropped. FCB writes its sectors in turn,
+ * so erases spread evenly over the partition.
+ *
+ * RAM use is fixed: the FCB state, its sector table and one cursor.
+ * Only the main loop may call these functions; they fail with -ENODEV
+ * until store_forward_init() has succeeded.
+ */
+
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sample_schema.h"
+
+struct store_forward_stats {
+    uint32_t pending;           /* Records not yet confirmed */
+    uint32_t stored;            /* Records appended since boot */
+    uint32_t replayed;          /* Records confirmed since boot */
+    uint32_t dropped;           /* Unsent records lost to a full log */
+    uint32_t erased;            /* Sectors erased since boot */
+};
+
+/**
+ * @brief Open the log and restore the replay cursor
+ *
+ * Formats the partition if it holds no valid log. Calling it again
+ * reopens the log from flash, as after a reboot.
+ *
+ * @return 0 on success, or negative errno
+ */
+int store_forward_init(void);
+
+/**
+ * @brief Append samples, erasing the oldest sector when the log is full
+ * @param samples Samples in time order
+ * @param count Number of samples
+ * @return 0 on success, or negative errno
+ */
+int store_forward_append(const sensor_sample_t *samples, size_t count);
+
+/**
+ * @brief Read the oldest unconfirmed samples without consuming them
+ * @param samples Receives up to @p max samples, oldest first
+ * @param max Capacity of @p samples
+ * @param last_seq Receives the sequence number of the last sample read
+ * @return Number of samples read, or negative errno
+ */
+int store_forward_peek(sensor_sample_t *samples, size_t max, uint32_t *last_seq);
+
+/**
+ * @brief Confirm the samples up to a sequence number as delivered and save the cursor
+ * @param seq Sequence number of the last sample to confirm, from store_forward_peek()
+ * @return 0 on success (also when they were already confirmed), or negative errno
+ */
+int store_forward_ack(uint32_t seq);
+
+/**
+ * @brief Number of samples waiting for replay
+ */
+uint32_t store_forward_pending(void);
+
+/**
+ * @brief Erase the whole log, dropping every pending sample
+ * @return 0 on success, or negative errno
+ */
+int store_forward_clear(void);
+
+/**
+ * @brief Get the log counters
+ * @param stats Counters to fill
+ */
+void store_forward_get_stats(struct store_forward_stats *stats);
+
+#endif /* STORE_FORWARD_H */
@@ -0,0 +1,103 @@
+/**
+ * @file text_writer.h
+ * @brief printf-free text output for the JSON and console paths
+ *
+ * Appends strings, integers and fixed-precision decimals to a caller
+ * buffer. text_put_fixed() prints exactly what "%.Nf" prints for the
+ * same float (correctly rounded, ties to even), using integer scaling
+ * and a two-digit table, so the image needs no floating-point printf.
+ *
+ * With a sink attached the buffer is only a staging area: whenever it
+ * fills, its contents are handed to the sink and writing continues, so
+ * output of any length can be streamed through a small buffer.
+ */
+
+#ifndef TEXT_WRITER_H
+#define TEXT_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest precision text_put_fixed() accepts */
+#define TEXT_FIXED_MAX_DECIMALS 9
+
+/* Longest "%.9f" of a float: sign, 39 integer digits, point, 9 decimals, NUL */
+#define TEXT_FIXED_MAX_LEN 51
+
+/**
+ * @brief Receives staged output of a streaming writer
+ * @return 0 on success, negative errno to stop the stream
+ */
+typedef int (*text_sink_t)(const char *data, size_t len, void *ctx);
+
+/* Output cursor; len keeps counting past size so overflow is detected once */
+struct text_writer {
+    char *buf;
+    size_t size;
+    size_t len;                 /* Bytes produced so far */
+    size_t flushed;             /* Bytes already handed to the sink */
+    text_sink_t sink;
+    void *sink_ctx;
+    int error;                  /* First sink error */
+};
+
+static inline void text_writer_init(struct text_writer *w, char *buf, size_t size)
+{
+    *w = (struct text_writer){.buf = buf, .size = size};
+}
+
+/**
+ * @brief Stream the output through @p buf into @p sink
+ *
+ * text_finish() then flushes the rest and returns the total length.
+ * A zero @p size cannot stage anything: the stream fails with -EINVAL.
+ */
+static inline void text_writer_init_stream(struct text_writer *w, char *buf, size_t size,
+                                           text_sink_t sink, void *ctx)
+{
+    *w = (struct text_writer){.buf = buf, .size = size, .sink = sink, .sink_ctx = ctx};
+}
+
+/* Slow path of the put functions once the buffer is full */
+void text_put_overflow(struct text_writer *w, const char *src, size_t len);
+
+static inline void text_put_char(struct text_writer *w, char c)
+{
+    size_t pos = w->len - w->flushed;
+
+    if (pos < w->size) {
+        w->buf[pos] = c;
+        w->len++;
+    } else {
+        text_put_overflow(w, &c, 1);
+    }
+}
+
+void text_put_str(struct text_writer *w, const char *str);
+
+void text_put_uint(struct text_writer *w, uint32_t value);
+
+void text_put_int(struct text_writer *w, int32_t value);
+
+/**
+ * @brief Append a float with a fixed number of decimals, as "%.Nf" would
+ * @param w Writer
+ * @param value Value; NaN and infinities print as "nan" and "inf"
+ * @param decimals Digits after the point, at most TEXT_FIXED_MAX_DECIMALS
+ */
+void text_put_fixed(struct text_writer *w, float value, unsigned int decimals);
+
+/**
+ * @brief NUL-terminate the output, or flush it to the sink
+ * @return Length without the terminator, -ENOMEM if it did not fit,
+ *         or the sink's error
+ */
+int text_finish(struct text_writer *w);
+
+/**
+ * @brief Format one float into @p buf, as snprintf("%.Nf") would
+ * @return Length without the terminator, or -ENOMEM if it did not fit
+ */
+int text_format_fixed(char *buf, size_t size, float value, unsigned int decimals);
+
+#endif /* TEXT_WRITER_H */
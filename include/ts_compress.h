@@ -0,0 +1,87 @@
+/**
+ * @file ts_compress.h
+ * @brief Streaming bit-packed compression of compact sample series
+ *
+ * Gorilla-style: timestamps as delta-of-delta, each value channel as a
+ * zig-zag delta, both in variable-length prefix codes, so an unchanged
+ * channel costs one bit. Samples are appended one at a time into a
+ * caller-provided block; a sample that does not fit is refused whole.
+ *
+ * Block layout (header little-endian, bit stream MSB first):
+ *
+ *   u8  version (TS_COMPRESS_VERSION)
+ *   u16 sample count
+ *   u32 timestamp of the first sample
+ *   bits, per sample:
+ *     timestamp delta-of-delta (skipped for the first sample)
+ *       '0'                 0
+ *       '10'   + 7 bits     -63..64
+ *       '110'  + 9 bits     -255..256
+ *       '1110' + 12 bits    -2047..2048
+ *       '1111' + 32 bits    anything else
+ *     valid_mask: '0' unchanged, '1' + 8 bits
+ *     each value of SAMPLE_FIELDS in order (temperature_cc, accel_mg[0..2],
+ *     battery_mv), as the zig-zag delta of its 16 bits from the previous
+ *     sample (from 0 for the first):
+ *       '0'                 0
+ *       '10'   + 4 bits     < 16
+ *       '110'  + 8 bits     < 256
+ *       '111'  + 17 bits    anything else
+ *
+ * scripts/ts_decompress.py decodes blocks on the ingest side.
+ */
+
+#ifndef TS_COMPRESS_H
+#define TS_COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_manager.h"
+
+#define TS_COMPRESS_VERSION 1
+
+/* Block header size in bytes */
+#define TS_COMPRESS_HEADER_LEN 7
+
+/* Value channels per sample */
+#define TS_COMPRESS_VALUES SAMPLE_VALUE_COUNT
+
+/* Worst case of one sample in the bit stream (timestamp, mask, values), in bytes */
+#define TS_COMPRESS_SAMPLE_MAX_LEN ((36 + 9 + 20 * TS_COMPRESS_VALUES + 7) / 8)
+
+struct ts_compressor {
+    uint8_t *buf;
+    size_t size;
+    size_t bits;                /* Bits written after the header */
+    uint16_t count;
+    uint32_t prev_ts;
+    int32_t prev_dt;
+    uint8_t prev_mask;
+    int16_t prev[TS_COMPRESS_VALUES];
+};
+
+/**
+ * @brief Start an empty block
+ * @param c Compressor
+ * @param buf Block buffer
+ * @param size Size of @p buf, at least TS_COMPRESS_HEADER_LEN
+ * @return 0 on success, -EINVAL if the buffer is too small
+ */
+int ts_compress_init(struct ts_compressor *c, uint8_t *buf, size_t size);
+
+/**
+ * @brief Append one sample to the block
+ * @param c Compressor
+ * @param sample Sample, later than the previous one
+ * @return 0 on success, -ENOSPC if it does not fit (the block is unchanged)
+ */
+int ts_compress_append(struct ts_compressor *c, const sensor_sample_t *sample);
+
+/**
+ * @brief Write the header and return the block length
+ * @param c Compressor
+ * @return Block length in bytes; appending may continue afterwards
+ */
+size_t ts_compress_finish(struct ts_compressor *c);
+
+#endif /* TS_COMPRESS_H */
@@ -0,0 +1,79 @@
+/**
+ * @file vibration.h
+ * @brief Vibration spectrum of the accelerometer stream
+ *
+ * Frames drained from the accelerometer FIFO are collected into
+ * CONFIG_APP_VIBRATION_FFT_SIZE point windows of one axis. One full
+ * window per CONFIG_APP_VIBRATION_INTERVAL_MS is Hann-weighted and
+ * transformed on the vibration thread into per-band RMS and the
+ * strongest spectral peaks, which are queued for uplink in place of
+ * the raw samples.
+ */
+
+#ifndef VIBRATION_H
+#define VIBRATION_H
+
+#include <zephyr/kernel.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_drivers.h"
+
+#define VIBRATION_BAND_COUNT CONFIG_APP_VIBRATION_BANDS
+#define VIBRATION_PEAK_COUNT CONFIG_APP_VIBRATION_PEAKS
+
+struct vibration_peak {
+    float freq_hz;
+    float amplitude_mg;         /* RMS of the tone */
+};
+
+/* Spectrum of one window */
+struct vibration_spectrum {
+    uint32_t timestamp_ms;      /* When the window was completed */
+    uint16_t sample_rate_hz;
+    uint16_t fft_size;
+    uint8_t axis;               /* 0 = X, 1 = Y, 2 = Z */
+    uint8_t peak_count;
+    float rms_mg;               /* Overall RMS without DC */
+    float band_width_hz;        /* Band i covers [i, i+1) × band_width_hz */
+    float band_rms_mg[VIBRATION_BAND_COUNT];
+    struct vibration_peak peaks[VIBRATION_PEAK_COUNT];   /* Strongest first */
+};
+
+/**
+ * @brief Build the window and FFT tables and start the vibration thread
+ * @return 0 on success, negative errno on failure
+ */
+int vibration_start(void);
+
+/**
+ * @brief Append accelerometer frames to the current window
+ *
+ * Called from the sampling thread; only copies. When the window is full
+ * it is handed to the vibration thread, or dropped if the previous one
+ * is still being analysed.
+ *
+ * @param frames Raw frames in FIFO order
+ * @param count Number of frames
+ */
+void vibration_feed(const struct accel_raw_frame *frames, size_t count);
+
+/**
+ * @brief Analyse one window of milli-g samples
+ *
+ * Exposed so the analysis can be driven directly, e.g. from benchmarks.
+ *
+ * @param samples CONFIG_APP_VIBRATION_FFT_SIZE samples of one axis
+ * @param spectrum Result; timestamp_ms is left to the caller
+ * @return 0 on success, negative errno on failure
+ */
+int vibration_analyze(const int16_t *samples, struct vibration_spectrum *spectrum);
+
+/**
+ * @brief Take the next spectrum queued for uplink
+ * @param spectrum Spectrum to fill
+ * @param timeout How long to wait
+ * @return 0 on success, -EAGAIN if none is available
+ */
+int vibration_get_spectrum(struct vibration_spectrum *spectrum, k_timeout_t timeout);
+
+#endif /* VIBRATION_H */
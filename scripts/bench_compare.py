@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Compare two runs of the tests/benchmarks suite and flag regressions.
+
+Reads the BENCH lines (see tests/benchmarks/src/bench.h) of a baseline
+log and a new log. An operation regresses when its time per operation,
+bytes or stack high-water mark grew by more than the threshold; the exit
+status is 1 if any did, so CI can gate on it.
+
+Usage:
+    bench_compare.py baseline.log new.log [--threshold 10]
+    bench_compare.py new.log --json > baseline.json    # keep a baseline
+"""
+
+import argparse
+import json
+import sys
+
+PREFIX = "BENCH "
+
+# Metrics compared, and whether timing noise applies to them
+METRICS = (("ns_per_op", True), ("bytes", False), ("stack_bytes", False))
+
+
+def load(path):
+    """BENCH results of a log (or a --json dump) keyed by operation name."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+
+    if text.lstrip().startswith("{") and PREFIX not in text:
+        return json.loads(text)
+
+    results = {}
+    for line in text.splitlines():
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        record = json.loads(line[pos + len(PREFIX):])
+        results[record.pop("name")] = record
+    return results
+
+
+def compare(base, new, threshold):
+    """Rows of (name, metric, old, new, change %, regressed)."""
+    rows = []
+    for name in sorted(set(base) | set(new)):
+        if name not in base or name not in new:
+            rows.append((name, "added" if name in new else "removed", None, None, None, False))
+            continue
+        if "error" in new[name]:
+            rows.append((name, "error", None, new[name]["error"], None, True))
+            continue
+        for metric, noisy in METRICS:
+            old, cur = base[name].get(metric), new[name].get(metric)
+            if old is None or cur is None:
+                continue
+            change = (cur - old) * 100.0 / old if old else (0.0 if cur == old else float("inf"))
+            limit = threshold if noisy else 0.0
+            rows.append((name, metric, old, cur, change, change > limit))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="+", help="baseline log and new log, or one log with --json")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10); "
+                             "bytes and stack may not grow at all")
+    parser.add_argument("--json", action="store_true",
+                        help="print the results of one log as JSON")
+    args = parser.parse_args()
+
+    if args.json:
+        json.dump(load(args.logs[-1]), sys.stdout, indent=1, sort_keys=True)
+        print()
+        return 0
+
+    if len(args.logs) != 2:
+        parser.error("need a baseline log and a new log")
+
+    rows = compare(load(args.logs[0]), load(args.logs[1]), args.threshold)
+    regressions = 0
+    for name, metric, old, cur, change, regressed in rows:
+        if change is None:
+            print(f"{name:28} {metric}" + (f" {cur}" if cur is not None else ""))
+        elif metric == "ns_per_op" or change != 0:
+            mark = "REGRESSION" if regressed else ""
+            print(f"{name:28} {metric:12} {old:>10} -> {cur:>10} {change:+7.1f}% {mark}")
+        regressions += regressed
+
+    print(f"{regressions} regression(s)")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,61 +1,93 @@
+import argparse
 import asyncio
 import json
 from bleak import BleakClient
 
+import sample_schema
+
 MAC = "98:88:E0:10:1F:2E"
 CHAR_UUID = "12345678-1234-5678-1234-56789abcdef1"
+PACKED_CHAR_UUID = "12345678-1234-5678-1234-56789abcdef2"
+
+
+def decode_json(data):
+    """Compact JSON record, one key per value (see include/sample_schema.h)"""
+    return sample_schema.decode_compact_json(json.loads(data.decode('utf-8')))
+
+
+def decode_packed(data):
+    """Packed little-endian record in integer units, converted for display"""
+    return sample_schema.to_float(sample_schema.decode_packed(data))
+
+
+def show(values):
+    """Print each schema field as the firmware console does"""
+    names = iter(v.name for v in sample_schema.VALUES)
+    for f in sample_schema.FIELDS:
+        if f.n == 1:
+            print(f"{f.label}: {values[next(names)]:.{f.cdec}f} {f.unit}")
+            continue
+        print(f"{f.label}:")
+        for key in f.keys:
+            print(f"     {key.upper()}: {values[next(names)]:+7.{f.cdec}f} {f.unit}")
+
+
+def make_handler(decode):
+    def notification_handler(sender, data):
+        """Affiche les données des capteurs de façon lisible"""
+        try:
+            sensor_data = decode(data)
+
+            # Affichage formaté
+            print("\n" + "="*50)
+            print("📊 SENSOR DATA")
+            print("="*50)
+            show(sensor_data)
+            print("="*50)
+
+        except (json.JSONDecodeError, UnicodeDecodeError):
+            print(f"⚠️  Invalid JSON: {data!r}")
+        except KeyError as e:
+            print(f"⚠️  Missing key: {e}")
+            print(f"📦 Raw data: {data!r}")
+        except Exception as e:
+            print(f"❌ Error: {e}")
+            print(f"📦 Raw HEX: {data.hex()}")
+
+    return notification_handler
+
+
+async def main(packed):
+    char_uuid = PACKED_CHAR_UUID if packed else CHAR_UUID
+    handler = make_handler(decode_packed if packed else decode_json)
 
-def notification_handler(sender, data):
-    """Affiche les données des capteurs de façon lisible"""
-    try:
-        # Décoder le JSON
-        text = data.decode('utf-8')
-        sensor_data = json.loads(text)
-        
-        # Affichage formaté
-        print("\n" + "="*50)
-        print("📊 SENSOR DATA")
-        print("="*50)
-        print(f"🌡️  Temperature:  {sensor_data['temp']:.1f} °C")
-        print(f"📐 Accelerometer:")
-        print(f"     X: {sensor_data['ax']:+7.2f} m/s²")
-        print(f"     Y: {sensor_data['ay']:+7.2f} m/s²")
-        print(f"     Z: {sensor_data['az']:+7.2f} m/s²")
-        print(f"🔋 Battery:       {sensor_data['batt']:.2f} V")
-        print("="*50)
-        
-    except json.JSONDecodeError:
-        print(f"⚠️  Invalid JSON: {text}")
-    except KeyError as e:
-        print(f"⚠️  Missing key: {e}")
-        print(f"📦 Raw data: {text}")
-    except Exception as e:
-        print(f"❌ Error: {e}")
-        print(f"📦 Raw HEX: {data.hex()}")
-
-async def main():
     print(f"🔍 Connecting to {MAC}...")
-    
+
     async with BleakClient(MAC, timeout=15.0) as client:
         print(f"✅ Connected to ESP32!")
-        print(f"🔔 Activating notifications...")
-        
-        await client.start_notify(CHAR_UUID, notification_handler)
-        
+        print(f"🔔 Activating {'packed' if packed else 'JSON'} notifications...")
+
+        await client.start_notify(char_uuid, handler)
+
         print(f"✅ Notifications enabled!")
         print(f"📡 Receiving sensor data... (press Ctrl+C to stop)\n")
-        
+
         try:
             # Recevoir indéfiniment
             while True:
                 await asyncio.sleep(1)
         except KeyboardInterrupt:
             print("\n\n👋 Stopping...")
-            await client.stop_notify(CHAR_UUID)
+            await client.stop_notify(char_uuid)
             print("✅ Disconnected")
 
 if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Receive sensor notifications over BLE")
+    parser.add_argument("--json", action="store_true",
+                        help="subscribe to the JSON characteristic instead of the packed one")
+    args = parser.parse_args()
+
     try:
-        asyncio.run(main())
+        asyncio.run(main(packed=not args.json))
     except KeyboardInterrupt:
         print("\n👋 Bye!")
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Expand lz_compress payloads (MQTT topic sensors/batch/lz) back to JSON.
+
+Payload layout: see include/lz_compress.h.
+
+Usage:
+    lz_decompress.py payload.bin [...]      # one raw payload per file
+    mosquitto_sub -t sensors/batch/lz -F %x | lz_decompress.py --hex
+"""
+
+import argparse
+import struct
+import sys
+
+VERSION = 1
+HEADER = struct.Struct("<BBH")
+
+
+def decode(payload):
+    version, params, length = HEADER.unpack_from(payload)
+    if version != VERSION:
+        raise ValueError(f"unsupported payload version {version}")
+    window_bits, lookahead_bits = params >> 4, params & 0x0F
+
+    data = payload[HEADER.size:]
+    pos = 0
+
+    def bits(count):
+        nonlocal pos
+        value = 0
+        for _ in range(count):
+            byte = data[pos >> 3]
+            value = (value << 1) | ((byte >> (7 - (pos & 7))) & 1)
+            pos += 1
+        return value
+
+    out = bytearray()
+    while len(out) < length:
+        if bits(1):
+            out.append(bits(8))
+            continue
+        dist = bits(window_bits) + 1
+        count = bits(lookahead_bits) + 1
+        if dist > len(out) or len(out) + count > length:
+            raise ValueError(f"bad back-reference at output byte {len(out)}")
+        for _ in range(count):      # byte by byte: the copy may overlap
+            out.append(out[-dist])
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", help="raw payload files")
+    parser.add_argument("--hex", action="store_true",
+                        help="read one hex-encoded payload per line from stdin")
+    args = parser.parse_args()
+
+    if args.hex:
+        payloads = [bytes.fromhex(line.strip()) for line in sys.stdin if line.strip()]
+    else:
+        payloads = []
+        for name in args.files:
+            with open(name, "rb") as f:
+                payloads.append(f.read())
+
+    for payload in payloads:
+        sys.stdout.buffer.write(decode(payload))
+        sys.stdout.buffer.write(b"\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+"""Sample fields as defined by SAMPLE_FIELDS in include/sample_schema.h.
+
+The firmware generates its encoders from that X-macro list; this module
+parses the same list so the host-side decoders follow it too.
+"""
+
+import os
+import re
+import struct
+from collections import namedtuple
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "include", "sample_schema.h")
+
+Field = namedtuple("Field", "name type n value mul div unit label json keys dec cdec cbor chan")
+
+# Integer types of the schema as struct codes
+STRUCT_CODES = {"int8_t": "b", "uint8_t": "B", "int16_t": "h", "uint16_t": "H",
+                "int32_t": "i", "uint32_t": "I"}
+
+
+def _split_args(text):
+    """Split an X(...) argument list on top-level commas."""
+    args, depth, quoted, start = [], 0, False, 0
+    for i, ch in enumerate(text):
+        if ch == '"':
+            quoted = not quoted
+        elif not quoted and ch == "(":
+            depth += 1
+        elif not quoted and ch == ")":
+            depth -= 1
+        elif not quoted and ch == "," and depth == 0:
+            args.append(text[start:i].strip())
+            start = i + 1
+    args.append(text[start:].strip())
+    return args
+
+
+def _number(token, constants):
+    token = token.strip()
+    return constants[token] if token in constants else float(token.rstrip("fF"))
+
+
+def load(path=HEADER):
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+
+    # Numeric #defines the schema may use for mul/div
+    constants = {name: float(value) for name, value in
+                 re.findall(r"#define\s+(\w+)\s+([-+0-9.eE]+)[fF]?\s", source)}
+
+    match = re.search(r"#define SAMPLE_FIELDS\(X\)(.*?)\n\s*\n", source, re.S)
+    if match is None:
+        raise ValueError(f"no SAMPLE_FIELDS in {path}")
+    body = match.group(1).replace("\\\n", " ")
+
+    fields = []
+    for entry in re.finditer(r"\bX\((.*?)\)\s*(?=X\(|$)", body.strip(), re.S):
+        a = _split_args(entry.group(1))
+        fields.append(Field(
+            name=a[0], type=a[1], n=int(a[2]), value=a[3],
+            mul=_number(a[4], constants), div=_number(a[5], constants),
+            unit=a[6].strip('"'), label=a[7].strip('"'), json=a[8].strip('"'),
+            keys=a[9].strip('"'), dec=int(a[10]), cdec=int(a[11]), cbor=int(a[12]),
+            chan=a[13]))
+    return fields
+
+
+FIELDS = load()
+
+
+def _component_name(field, i):
+    """accel_mg, 'xyz', 0 -> accel_x_mg"""
+    if field.n == 1:
+        return field.name
+    base, unit = field.name.rsplit("_", 1)
+    return f"{base}_{field.keys[i]}_{unit}"
+
+
+# One entry per value, components expanded (accel_mg -> accel_x_mg, ...)
+Value = namedtuple("Value", "name type scale unit key signed bits")
+VALUES = [
+    Value(name=_component_name(f, i), type=f.type,
+          scale=f.mul / f.div, unit=f.unit, key=f.keys[i],
+          signed=not f.type.startswith("u"), bits=8 * struct.calcsize(STRUCT_CODES[f.type]))
+    for f in FIELDS for i in range(f.n)
+]
+
+# Packed BLE record: version, valid_mask, timestamp, then every value
+PACKED_SCHEMA_VERSION = 1
+PACKED = struct.Struct("<BBI" + "".join(STRUCT_CODES[v.type] for v in VALUES))
+
+
+def wrap(value, v):
+    """Reduce an integer to the width and signedness of value v."""
+    value &= (1 << v.bits) - 1
+    if v.signed and value >> (v.bits - 1):
+        value -= 1 << v.bits
+    return value
+
+
+def decode_packed(data):
+    """Packed record to {"timestamp_ms", "valid_mask", <value name>: int}.
+
+    Records of a later schema version are decoded too, as far as this
+    version knows them: later versions only append fields.
+    """
+    if len(data) < 1 or data[0] < 1:
+        raise ValueError(f"unknown schema version {data[0] if data else None}")
+    if len(data) < PACKED.size:
+        raise ValueError(f"short record ({len(data)} bytes)")
+
+    # Fields this version does not know are in the tail; ignore it
+    _, valid, ts, *values = PACKED.unpack_from(data)
+    record = {"timestamp_ms": ts, "valid_mask": valid}
+    record.update((v.name, x) for v, x in zip(VALUES, values))
+    return record
+
+
+def to_float(record):
+    """Integer values of a record in their float units, keyed by value name."""
+    return {v.name: record[v.name] * v.scale for v in VALUES}
+
+
+def decode_compact_json(obj):
+    """Compact JSON object ({"t":..,"x":..}) to floats keyed by value name."""
+    return {v.name: obj[v.key] for v in VALUES}
+
+
+def undelta_rows(rows):
+    """Batch rows [dt, values..., valid] to absolute (timestamp offset, values, valid)."""
+    t, values = 0, [0] * len(VALUES)
+    for row in rows:
+        t += row[0]
+        values = [wrap(a + d, v) for a, d, v in zip(values, row[1:1 + len(VALUES)], VALUES)]
+        yield t, values, row[1 + len(VALUES)]
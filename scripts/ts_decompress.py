@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Decode ts_compress blocks (MQTT topic sensors/batch/ts) into samples.
+
+Block layout: see include/ts_compress.h.
+
+Usage:
+    ts_decompress.py block.bin [...]        # one raw block per file
+    mosquitto_sub -t sensors/batch/ts -F %x | ts_decompress.py --hex
+"""
+
+import argparse
+import struct
+import sys
+
+from sample_schema import VALUES, wrap
+
+VERSION = 1
+HEADER = struct.Struct("<BHI")
+FIELDS = ("timestamp_ms", *(v.name for v in VALUES), "valid_mask")
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def bits(self, count):
+        value = 0
+        for _ in range(count):
+            byte = self.data[self.pos >> 3]
+            value = (value << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return value
+
+    def prefix(self, limit):
+        """Number of leading 1 bits, stopping after a 0 or at limit."""
+        ones = 0
+        while ones < limit and self.bits(1):
+            ones += 1
+        return ones
+
+
+def signed(value, width, high):
+    """Undo the two's complement of a width-bit field holding [high-2^width+1, high]."""
+    return value - (1 << width) if value > high else value
+
+
+def read_dod(r):
+    n = r.prefix(4)
+    if n == 0:
+        return 0
+    if n == 1:
+        return signed(r.bits(7), 7, 64)
+    if n == 2:
+        return signed(r.bits(9), 9, 256)
+    if n == 3:
+        return signed(r.bits(12), 12, 2048)
+    return signed(r.bits(32), 32, 0x7FFFFFFF)
+
+
+def read_delta(r):
+    zz = r.bits((0, 4, 8, 17)[r.prefix(3)])
+    return (zz >> 1) ^ -(zz & 1)
+
+
+def decode(block):
+    version, count, t0 = HEADER.unpack_from(block)
+    if version != VERSION:
+        raise ValueError(f"unsupported block version {version}")
+
+    r = BitReader(block[HEADER.size:])
+    samples = []
+    ts, dt, mask = t0, 0, 0
+    values = [0] * len(VALUES)
+
+    for i in range(count):
+        if i > 0:
+            dt = (dt + read_dod(r)) & 0xFFFFFFFF
+            dt = dt - (1 << 32) if dt & 0x80000000 else dt
+            ts = (ts + dt) & 0xFFFFFFFF
+        if r.bits(1):
+            mask = r.bits(8)
+        # Deltas are of the 16-bit patterns; wrap restores each field's sign
+        values = [(v + read_delta(r)) & 0xFFFF for v in values]
+        samples.append((ts, *(wrap(x, v) for x, v in zip(values, VALUES)), mask))
+
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", help="raw block files")
+    parser.add_argument("--hex", action="store_true",
+                        help="read one hex-encoded block per line from stdin")
+    args = parser.parse_args()
+
+    if args.hex:
+        blocks = [bytes.fromhex(line.strip()) for line in sys.stdin if line.strip()]
+    else:
+        blocks = []
+        for name in args.files:
+            with open(name, "rb") as f:
+                blocks.append(f.read())
+
+    print(",".join(FIELDS))
+    for block in blocks:
+        for sample in decode(block):
+            print(",".join(str(v) for v in sample))
+
+
+if __name__ == "__main__":
+    main()
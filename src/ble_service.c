@@ -17,10 +17,25 @@ LOG_MODULE_REGISTER(ble_svc, LOG_LEVEL_INF);
 /* Connexion et état */
 static struct bt_conn *current_conn = NULL;
 static bool notify_enabled = false;
+static bool packed_notify_enabled = false;
 
-/* Buffer pour les données JSON */
-#define JSON_BUFFER_SIZE 256
-static char json_buffer[JSON_BUFFER_SIZE];
+/* Buffer pour les données JSON ou CBOR */
+#define PAYLOAD_BUFFER_SIZE 256
+static uint8_t payload_buffer[PAYLOAD_BUFFER_SIZE];
+static enum payload_format payload_format = PAYLOAD_FORMAT_DEFAULT;
+
+/* Last packed record, also returned on read */
+static uint8_t packed_record[BLE_PACKED_LEN];
+
+/* JSON encoder */
+extern int json_encode_sensor_data_compact(const sensor_data_t *data,
+                                           char *buffer,
+                                           size_t buffer_size);
+
+/* CBOR encoder */
+extern int cbor_encode_sensor_data(const sensor_data_t *data,
+                                   uint8_t *buffer,
+                                   size_t buffer_size);
 
 /* UUID Service : 12345678-1234-5678-1234-56789abcdef0 */
 #define BT_UUID_SENSOR_SERVICE \
@@ -30,6 +45,10 @@ static char json_buffer[JSON_BUFFER_SIZE];
 #define BT_UUID_SENSOR_DATA_CHAR \
     BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef1))
 
+/* UUID Characteristic : 12345678-1234-5678-1234-56789abcdef2 (packed binary) */
+#define BT_UUID_SENSOR_PACKED_CHAR \
+    BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789abcdef2))
+
 /**
  * @brief CCC change handler
  */
@@ -39,6 +58,19 @@ static void sensor_data_ccc_changed(const struct bt_gatt_attr *attr, uint16_t va
     LOG_INF("Notifications %s", notify_enabled ? "enabled" : "disabled");
 }
 
+static void sensor_packed_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+    packed_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+    LOG_INF("Packed notifications %s", packed_notify_enabled ? "enabled" : "disabled");
+}
+
+static ssize_t read_packed(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                           void *buf, uint16_t len, uint16_t offset)
+{
+    return bt_gatt_attr_read(conn, attr, buf, len, offset,
+                             packed_record, sizeof(packed_record));
+}
+
 /**
  * @brief GATT service
  */
@@ -47,10 +79,19 @@ BT_GATT_SERVICE_DEFINE(sensor_service,
     BT_GATT_CHARACTERISTIC(BT_UUID_SENSOR_DATA_CHAR,
                           BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
                           BT_GATT_PERM_READ,
-                          NULL, NULL, json_buffer),
+                          NULL, NULL, payload_buffer),
     BT_GATT_CCC(sensor_data_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_SENSOR_PACKED_CHAR,
+                          BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                          BT_GATT_PERM_READ,
+                          read_packed, NULL, NULL),
+    BT_GATT_CCC(sensor_packed_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
 );
 
+/* Characteristic declarations, as passed to bt_gatt_notify() */
+#define SENSOR_DATA_ATTR   (&sensor_service.attrs[1])
+#define SENSOR_PACKED_ATTR (&sensor_service.attrs[4])
+
 /**
  * @brief Advertising data
  */
@@ -93,6 +134,7 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
     }
 
     notify_enabled = false;
+    packed_notify_enabled = false;
     
     /* Redémarrer advertising après déconnexion */
     LOG_INF("Restarting advertising...");
@@ -160,34 +202,80 @@ int ble_service_stop_advertising(void)
     return 0;
 }
 
-int ble_service_notify(const sensor_data_t *data)
+int ble_service_set_format(enum payload_format format)
 {
-    if (!current_conn || !notify_enabled) {
-        return -ENOTCONN;
+    if (format == PAYLOAD_FORMAT_CBOR && !IS_ENABLED(CONFIG_APP_PAYLOAD_CBOR)) {
+        return -ENOTSUP;
+    }
+
+    payload_format = format;
+    return 0;
+}
+
+/**
+ * @brief Notify the packed characteristic; integers only, no conversion
+ */
+static int notify_packed(const sensor_sample_t *sample)
+{
+    ble_packed_encode(sample, packed_record);
+
+    return bt_gatt_notify(current_conn, SENSOR_PACKED_ATTR,
+                          packed_record, sizeof(packed_record));
+}
+
+/**
+ * @brief Notify the JSON/CBOR characteristic
+ */
+static int notify_encoded(const sensor_sample_t *sample)
+{
+    sensor_data_t data;
+    int len;
+
+    sensor_sample_to_data(sample, &data);
+
+#ifdef CONFIG_APP_PAYLOAD_CBOR
+    if (payload_format == PAYLOAD_FORMAT_CBOR) {
+        len = cbor_encode_sensor_data(&data, payload_buffer, sizeof(payload_buffer));
+    } else
+#endif
+    {
+        len = json_encode_sensor_data_compact(&data, (char *)payload_buffer,
+                                              sizeof(payload_buffer));
     }
 
-    /* Créer JSON compact */
-    int len = snprintf(json_buffer, sizeof(json_buffer),
-        "{\"t\":%.1f,\"x\":%.2f,\"y\":%.2f,\"z\":%.2f,\"b\":%.2f}",
-        (double)data->temperature_c,
-        (double)data->accel_x,
-        (double)data->accel_y,
-        (double)data->accel_z,
-        (double)data->battery_voltage
-    );
-
-    if (len < 0 || len >= sizeof(json_buffer)) {
-        LOG_ERR("JSON encode failed");
-        return -ENOMEM;
+    if (len < 0) {
+        LOG_ERR("Encode failed: %d", len);
+        return len;
     }
-    
+
     LOG_DBG("Sending: %d bytes", len);
-    
-    return bt_gatt_notify(current_conn, &sensor_service.attrs[1],
-                         json_buffer, len);
+
+    return bt_gatt_notify(current_conn, SENSOR_DATA_ATTR, payload_buffer, len);
+}
+
+int ble_service_notify(const sensor_sample_t *sample)
+{
+    if (!current_conn || (!notify_enabled && !packed_notify_enabled)) {
+        return -ENOTCONN;
+    }
+
+    int ret = 0;
+
+    /* Each subscribed characteristic gets its own notification */
+    if (packed_notify_enabled) {
+        ret = notify_packed(sample);
+    }
+    if (notify_enabled) {
+        int err = notify_encoded(sample);
+        if (ret == 0) {
+            ret = err;
+        }
+    }
+
+    return ret;
 }
 
 bool ble_service_is_connected(void)
 {
-    return (current_conn != NULL && notify_enabled);
+    return (current_conn != NULL && (notify_enabled || packed_notify_enabled));
 }
\ No newline at end of file
@@ -0,0 +1,261 @@
+/**
+ * @file conn_manager.c
+ * @brief Reconnect state machine for the WiFi link, the IP address and the broker
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/random/random.h>
+#include <errno.h>
+#include "conn_manager.h"
+#include "app_config.h"
+
+LOG_MODULE_REGISTER(conn_manager, LOG_LEVEL_INF);
+
+K_MSGQ_DEFINE(conn_event_queue, sizeof(enum conn_event), CONN_EVENT_QUEUE_SIZE, 4);
+
+static K_THREAD_STACK_DEFINE(conn_stack, CONN_THREAD_STACK_SIZE);
+static struct k_thread conn_thread;
+static K_SEM_DEFINE(up_sem, 0, 1);
+
+static const char *const loss_names[CONN_LOSS_COUNT] = {"link", "IP", "broker"};
+
+/* Manager thread only, except state and stats, which others read */
+static const struct conn_ops *ops;
+static enum conn_state state = CONN_STATE_LINK_DOWN;
+static uint32_t deadline;           /* Next retry or timeout, k_uptime_get_32() ms */
+static uint32_t attempt;            /* Failures of the current layer in a row */
+static bool recovering;
+static enum conn_loss loss;
+static uint32_t loss_at;
+static struct conn_stats stats;
+
+uint32_t conn_backoff_ms(uint32_t attempt, uint32_t random)
+{
+    if (attempt == 0) {
+        return 0;
+    }
+
+    uint32_t delay = CONFIG_APP_CONN_BACKOFF_MAX_MS;
+
+    /* Doubling past the cap would overflow first */
+    if (attempt <= 31 &&
+        CONFIG_APP_CONN_BACKOFF_MIN_MS <= (CONFIG_APP_CONN_BACKOFF_MAX_MS >> (attempt - 1))) {
+        delay = (uint32_t)CONFIG_APP_CONN_BACKOFF_MIN_MS << (attempt - 1);
+    }
+
+    /* Half fixed, half random */
+    return delay / 2 + random % (delay - delay / 2 + 1);
+}
+
+static void enter(enum conn_state next, uint32_t delay_ms)
+{
+    state = next;
+    deadline = k_uptime_get_32() + delay_ms;
+
+    if (next == CONN_STATE_UP) {
+        attempt = 0;
+        if (recovering) {
+            recovering = false;
+            stats.recovery_ms[loss] = k_uptime_get_32() - loss_at;
+            LOG_INF("Recovered from %s loss in %u ms", loss_names[loss],
+                    stats.recovery_ms[loss]);
+        }
+        k_sem_give(&up_sem);
+    }
+}
+
+/* A layer that was up went down: redo it and everything above, at once */
+static void lost(enum conn_loss what, enum conn_state redo)
+{
+    stats.losses[what]++;
+    LOG_WRN("%s lost", loss_names[what]);
+
+    /* A loss during recovery keeps the first loss's start time */
+    if (!recovering || what < loss) {
+        loss = what;
+    }
+    if (!recovering) {
+        recovering = true;
+        loss_at = k_uptime_get_32();
+    }
+
+    attempt = 0;
+    enter(redo, 0);
+}
+
+/* The current layer failed again: back off before the next try */
+static void retry(enum conn_state redo)
+{
+    attempt++;
+    enter(redo, conn_backoff_ms(attempt, sys_rand32_get()));
+}
+
+static void handle_event(enum conn_event event)
+{
+    switch (event) {
+    case CONN_EVENT_LINK_UP:
+        if (state == CONN_STATE_LINK_DOWN || state == CONN_STATE_LINK_CONNECTING) {
+            attempt = 0;
+            enter(CONN_STATE_IP_WAIT, CONFIG_APP_CONN_DHCP_TIMEOUT_MS);
+        }
+        break;
+
+    case CONN_EVENT_LINK_FAILED:
+        if (state == CONN_STATE_LINK_CONNECTING) {
+            LOG_WRN("Association failed");
+            retry(CONN_STATE_LINK_DOWN);
+        }
+        break;
+
+    case CONN_EVENT_LINK_DOWN:
+        /* While associating, LINK_UP or LINK_FAILED tells the outcome */
+        if (state != CONN_STATE_LINK_DOWN && state != CONN_STATE_LINK_CONNECTING) {
+            lost(CONN_LOSS_LINK, CONN_STATE_LINK_DOWN);
+        }
+        break;
+
+    case CONN_EVENT_IP_UP:
+        if (state != CONN_STATE_BROKER_DOWN && state != CONN_STATE_UP) {
+            attempt = 0;
+            enter(CONN_STATE_BROKER_DOWN, 0);
+        }
+        break;
+
+    case CONN_EVENT_IP_DOWN:
+        if (state == CONN_STATE_BROKER_DOWN || state == CONN_STATE_UP) {
+            lost(CONN_LOSS_IP, CONN_STATE_IP_WAIT);
+        }
+        break;
+
+    case CONN_EVENT_BROKER_DOWN:
+        /* Stale if a reconnect already replaced the session it reports */
+        if (state == CONN_STATE_UP && !ops->broker_connected()) {
+            lost(CONN_LOSS_BROKER, CONN_STATE_BROKER_DOWN);
+        }
+        break;
+    }
+}
+
+/* The deadline of the current state passed */
+static void step(void)
+{
+    int ret;
+
+    switch (state) {
+    case CONN_STATE_LINK_DOWN:
+        stats.link_attempts++;
+        ret = ops->link_connect();
+        if (ret < 0) {
+            LOG_WRN("Association request failed: %d", ret);
+            retry(CONN_STATE_LINK_DOWN);
+        } else {
+            enter(CONN_STATE_LINK_CONNECTING, CONFIG_APP_CONN_LINK_TIMEOUT_MS);
+        }
+        break;
+
+    case CONN_STATE_LINK_CONNECTING:
+        LOG_WRN("Association timed out");
+        retry(CONN_STATE_LINK_DOWN);
+        break;
+
+    case CONN_STATE_IP_WAIT:
+        /* DHCP did not answer: ask again, then give up on the association */
+        if (attempt >= CONFIG_APP_CONN_DHCP_RETRIES) {
+            LOG_WRN("No DHCP address, reassociating");
+            attempt = 0;
+            retry(CONN_STATE_LINK_DOWN);
+            break;
+        }
+        stats.ip_renewals++;
+        ret = ops->ip_renew();
+        if (ret < 0) {
+            LOG_WRN("DHCP restart failed: %d", ret);
+        }
+        attempt++;
+        enter(CONN_STATE_IP_WAIT, CONFIG_APP_CONN_DHCP_TIMEOUT_MS);
+        break;
+
+    case CONN_STATE_BROKER_DOWN:
+        stats.broker_attempts++;
+        ret = ops->broker_connect();
+        if (ret < 0) {
+            LOG_WRN("Broker connect failed: %d", ret);
+            retry(CONN_STATE_BROKER_DOWN);
+        } else {
+            enter(CONN_STATE_UP, 0);
+        }
+        break;
+
+    case CONN_STATE_UP:
+        break;
+    }
+}
+
+static void conn_thread_func(void *a, void *b, void *c)
+{
+    enum conn_event event;
+
+    ARG_UNUSED(a);
+    ARG_UNUSED(b);
+    ARG_UNUSED(c);
+
+    while (1) {
+        k_timeout_t wait = K_FOREVER;
+
+        if (state != CONN_STATE_UP) {
+            int32_t left = (int32_t)(deadline - k_uptime_get_32());
+
+            wait = left > 0 ? K_MSEC(left) : K_NO_WAIT;
+        }
+
+        /* Events first; the deadline is acted on once none is pending */
+        if (k_msgq_get(&conn_event_queue, &event, wait) == 0) {
+            handle_event(event);
+        } else if (state != CONN_STATE_UP) {
+            step();
+        }
+    }
+}
+
+int conn_manager_start(const struct conn_ops *conn_ops)
+{
+    if (conn_ops == NULL || ops != NULL) {
+        return -EINVAL;
+    }
+
+    ops = conn_ops;
+    enter(CONN_STATE_LINK_DOWN, 0);
+
+    k_thread_create(&conn_thread, conn_stack, K_THREAD_STACK_SIZEOF(conn_stack),
+                    conn_thread_func, NULL, NULL, NULL,
+                    CONN_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&conn_thread, "conn_manager");
+    return 0;
+}
+
+void conn_manager_notify(enum conn_event event)
+{
+    if (k_msgq_put(&conn_event_queue, &event, K_NO_WAIT) != 0) {
+        LOG_ERR("Connection event %d dropped", event);
+    }
+}
+
+enum conn_state conn_manager_state(void)
+{
+    return state;
+}
+
+int conn_manager_wait_up(k_timeout_t timeout)
+{
+    k_sem_reset(&up_sem);
+    if (state == CONN_STATE_UP) {
+        return 0;
+    }
+    return k_sem_take(&up_sem, timeout);
+}
+
+void conn_manager_get_stats(struct conn_stats *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file fast_boot.c
+ * @brief Last working WiFi, DHCP and broker details, and boot-to-first-publish time
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_ip.h>
+#include <errno.h>
+#include <string.h>
+#include "fast_boot.h"
+
+LOG_MODULE_REGISTER(fast_boot, LOG_LEVEL_INF);
+
+static struct fast_boot_link cached_link;
+static struct fast_boot_lease cached_lease;
+static struct fast_boot_broker cached_broker;
+
+struct cache_item {
+    const char *key;            /* Under "fboot/" */
+    void *value;
+    size_t len;
+};
+
+static const struct cache_item items[FAST_BOOT_ITEM_COUNT] = {
+    [FAST_BOOT_LINK] = {"link", &cached_link, sizeof(cached_link)},
+    [FAST_BOOT_LEASE] = {"lease", &cached_lease, sizeof(cached_lease)},
+    [FAST_BOOT_BROKER] = {"broker", &cached_broker, sizeof(cached_broker)},
+};
+
+static uint8_t valid;           /* Cached items, bit per enum fast_boot_item */
+static struct fast_boot_stats stats;
+
+#ifdef CONFIG_APP_FAST_BOOT
+static int fast_boot_settings_set(const char *name, size_t len,
+                                  settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+
+    for (int i = 0; i < FAST_BOOT_ITEM_COUNT; i++) {
+        if (!settings_name_steq(name, items[i].key, &next) || next != NULL) {
+            continue;
+        }
+
+        /* Written by a build with another layout: take the full path */
+        if (len != items[i].len) {
+            return 0;
+        }
+
+        ssize_t ret = read_cb(cb_arg, items[i].value, items[i].len);
+        if (ret < 0) {
+            return (int)ret;
+        }
+
+        valid |= BIT(i);
+        stats.loaded |= BIT(i);
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(fast_boot, "fboot", NULL,
+                               fast_boot_settings_set, NULL, NULL);
+
+static void item_path(enum fast_boot_item item, char *path, size_t size)
+{
+    snprintk(path, size, "fboot/%s", items[item].key);
+}
+#endif
+
+int fast_boot_init(void)
+{
+    valid = 0;
+    memset(&stats, 0, sizeof(stats));
+
+#ifdef CONFIG_APP_FAST_BOOT
+    int ret = settings_subsys_init();
+    if (ret == 0) {
+        ret = settings_load_subtree("fboot");
+    }
+    if (ret != 0) {
+        LOG_WRN("Connection cache unavailable, taking the full path: %d", ret);
+        valid = 0;
+        stats.loaded = 0;
+        return ret;
+    }
+
+    LOG_INF("Cached link/lease/broker: %s/%s/%s",
+            (valid & BIT(FAST_BOOT_LINK)) ? "yes" : "no",
+            (valid & BIT(FAST_BOOT_LEASE)) ? "yes" : "no",
+            (valid & BIT(FAST_BOOT_BROKER)) ? "yes" : "no");
+#endif
+    return 0;
+}
+
+bool fast_boot_get(enum fast_boot_item item, void *value, size_t len)
+{
+    if (!(valid & BIT(item)) || len != items[item].len) {
+        return false;
+    }
+
+    memcpy(value, items[item].value, len);
+    stats.used |= BIT(item);
+    return true;
+}
+
+int fast_boot_save(enum fast_boot_item item, const void *value, size_t len)
+{
+    if (len != items[item].len) {
+        return -EINVAL;
+    }
+
+#ifdef CONFIG_APP_FAST_BOOT
+    /* Flash is only written when the network changed */
+    if ((valid & BIT(item)) && memcmp(items[item].value, value, len) == 0) {
+        return 0;
+    }
+
+    char path[16];
+
+    memcpy(items[item].value, value, len);
+    valid |= BIT(item);
+    item_path(item, path, sizeof(path));
+
+    int ret = settings_save_one(path, value, len);
+    if (ret != 0) {
+        LOG_ERR("Failed to cache %s: %d", items[item].key, ret);
+        return ret;
+    }
+    stats.saves++;
+#endif
+    return 0;
+}
+
+void fast_boot_forget(enum fast_boot_item item)
+{
+    if (!(valid & BIT(item))) {
+        return;
+    }
+
+    valid &= ~BIT(item);
+    stats.failed |= BIT(item);
+    LOG_WRN("Cached %s failed, using the full path", items[item].key);
+
+#ifdef CONFIG_APP_FAST_BOOT
+    char path[16];
+
+    item_path(item, path, sizeof(path));
+    settings_delete(path);
+#endif
+}
+
+bool fast_boot_lease_apply(struct net_if *iface, struct in_addr *addr)
+{
+    struct fast_boot_lease lease;
+    struct in_addr netmask;
+    struct in_addr gateway;
+
+    if (!fast_boot_get(FAST_BOOT_LEASE, &lease, sizeof(lease))) {
+        return false;
+    }
+
+    memcpy(addr, lease.addr, sizeof(*addr));
+    memcpy(&netmask, lease.netmask, sizeof(netmask));
+    memcpy(&gateway, lease.gateway, sizeof(gateway));
+
+    if (!net_if_ipv4_addr_add(iface, addr, NET_ADDR_MANUAL, 0)) {
+        LOG_WRN("Cached address rejected, waiting for DHCP");
+        return false;
+    }
+    net_if_ipv4_set_netmask_by_addr(iface, addr, &netmask);
+    net_if_ipv4_set_gw(iface, &gateway);
+    return true;
+}
+
+bool fast_boot_lease_bound(struct net_if *iface, const struct in_addr *cached,
+                           const struct in_addr *bound, uint32_t lease_time)
+{
+    struct in_addr addr = *bound;
+    struct in_addr netmask;
+    struct net_if_addr *ifaddr;
+
+    if (!net_ipv4_addr_cmp(cached, bound)) {
+        /* DHCP gave another address: the cached one was stale */
+        fast_boot_forget(FAST_BOOT_LEASE);
+        net_if_ipv4_addr_rm(iface, cached);
+        return false;
+    }
+
+    /* DHCP's own add found the manual address and left it manual, with no
+     * lifetime; take it out and put it back as DHCP's */
+    netmask = net_if_ipv4_get_netmask_by_addr(iface, cached);
+    net_if_ipv4_addr_rm(iface, cached);
+
+    ifaddr = net_if_ipv4_addr_add(iface, &addr, NET_ADDR_DHCP, lease_time);
+    if (!ifaddr) {
+        LOG_ERR("Failed to re-add the DHCP address");
+        return false;
+    }
+
+    /* A socket still holding the entry gets it back as it was */
+    ifaddr->addr_type = NET_ADDR_DHCP;
+    net_if_ipv4_set_netmask_by_addr(iface, &addr, &netmask);
+    return true;
+}
+
+void fast_boot_mark(enum fast_boot_mark mark)
+{
+    if (stats.mark_ms[mark] != 0) {
+        return;
+    }
+
+    /* 0 means not reached yet */
+    stats.mark_ms[mark] = MAX(k_uptime_get_32(), 1);
+
+    if (mark == FAST_BOOT_MARK_PUBLISH) {
+        LOG_INF("Boot to first publish: %u ms (link %u, IP %u, broker %u) | "
+                "cached link/lease/broker used: %s/%s/%s",
+                stats.mark_ms[FAST_BOOT_MARK_PUBLISH],
+                stats.mark_ms[FAST_BOOT_MARK_LINK],
+                stats.mark_ms[FAST_BOOT_MARK_IP],
+                stats.mark_ms[FAST_BOOT_MARK_BROKER],
+                (stats.used & ~stats.failed & BIT(FAST_BOOT_LINK)) ? "yes" : "no",
+                (stats.used & ~stats.failed & BIT(FAST_BOOT_LEASE)) ? "yes" : "no",
+                (stats.used & ~stats.failed & BIT(FAST_BOOT_BROKER)) ? "yes" : "no");
+    }
+}
+
+void fast_boot_get_stats(struct fast_boot_stats *out)
+{
+    *out = stats;
+}
@@ -1,14 +1,90 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/logging/log.h>
+#include <ctype.h>
+#include <math.h>
 #include "app_config.h"
 #include "sensor_manager.h"
 #include "power_manager.h"
 #include "ble_service.h"
 #include "mqtt_client.h"
+#include "conn_manager.h"
+#include "text_writer.h"
+#include "sample_drain.h"
+
+#ifdef CONFIG_APP_STATS
+#include "sample_stats.h"
+#endif
+
+#ifdef CONFIG_APP_REPORT_FILTER
+#include "report_filter.h"
+#endif
+
+#ifdef CONFIG_APP_VIBRATION
+#include "vibration.h"
+#endif
+
+#ifdef CONFIG_APP_STORE_FORWARD
+#include "store_forward.h"
+#endif
+
+#ifdef CONFIG_APP_MQTT_QOS1
+#include "mqtt_qos1.h"
+#endif
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
+/* Raw samples go to MQTT one by one unless only summaries, spectra or batches are uplinked */
+#define MQTT_PER_SAMPLE (!IS_ENABLED(CONFIG_APP_STATS_PUBLISH_ONLY) &&     \
+                         !IS_ENABLED(CONFIG_APP_VIBRATION_PUBLISH_ONLY) && \
+                         !IS_ENABLED(CONFIG_APP_PAYLOAD_BATCH))
+
+/* History ring positions of the per-sample uplinks */
+static sensor_cursor_t ble_cursor;
+static struct sample_drain mqtt_drain;
+
+#ifdef CONFIG_APP_MQTT_QOS1
+#define MQTT_WINDOW_WAIT_MS CONFIG_APP_MQTT_QOS1_WINDOW_WAIT_MS
+#else
+#define MQTT_WINDOW_WAIT_MS 0
+#endif
+
+static const struct sample_drain_ops mqtt_drain_ops;
+
+#ifdef CONFIG_APP_REPORT_FILTER
+/* Send-on-delta state, one per uplink */
+static struct report_filter ble_filter;
+static struct report_filter mqtt_filter;
+#endif
+
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+BUILD_ASSERT(CONFIG_APP_PAYLOAD_BATCH_SIZE <= SENSOR_HISTORY_SIZE,
+             "A batch cannot hold more than the sample history ring");
+
+/* Samples read from the history ring, not yet published */
+static sensor_cursor_t batch_cursor;
+static sensor_sample_t batch[CONFIG_APP_PAYLOAD_BATCH_SIZE];
+static size_t batch_count;
+#endif
+
+#ifdef CONFIG_APP_STORE_FORWARD
+/* Replay credit is capped at this many samples */
+#define REPLAY_CREDIT_MAX (4 * CONFIG_APP_STORE_FORWARD_REPLAY_SIZE)
+
+/* One replayed group, read back from flash */
+static sensor_sample_t replay[CONFIG_APP_STORE_FORWARD_REPLAY_SIZE];
+static uint32_t replay_credit;
+static int64_t replay_credit_at;
+
+/* Group awaiting its PUBACKs, tagged with the sequence number of its last record */
+static atomic_t replay_seq;     /* 0 if none */
+static uint32_t replay_confirm; /* Last record published, confirmed once all are acked */
+static uint32_t replay_sent;    /* Samples of the group published */
+static atomic_t replay_acked;   /* ...and acknowledged, counted on the MQTT I/O thread */
+
+static void replay_ack_handler(uint32_t tag, size_t samples);
+#endif
+
 /*    INITIALIZATION FUNCTIONS        */
 
 static int init_power_manager(void)
@@ -28,11 +104,16 @@ static int init_mqtt_client(void)
         return ret;
     }
     
+#ifdef CONFIG_APP_STORE_FORWARD
+    mqtt_client_set_ack_callback(replay_ack_handler);
+#endif
+    
     LOG_INF("MQTT initialized - connecting...");
     
-    ret = mqtt_client_connect();
+    /* Reconnects run in the background; this only bounds the startup wait */
+    ret = mqtt_client_wait_connected(K_MSEC(CONN_BOOT_TIMEOUT_MS));
     if (ret != 0) {
-        LOG_ERR("MQTT connection failed: %d", ret);
+        LOG_ERR("MQTT not connected after %d ms", CONN_BOOT_TIMEOUT_MS);
         return ret;
     }
     
@@ -67,6 +148,27 @@ static int init_sensor_manager(void)
         return ret;
     }
     
+#ifdef CONFIG_APP_STATS
+    /* Subscribe before sampling starts so no window misses samples */
+    ret = sample_stats_start();
+    if (ret != 0) {
+        LOG_WRN("Statistics disabled: %d", ret);
+    }
+#endif
+    
+#ifdef CONFIG_APP_VIBRATION
+    ret = vibration_start();
+    if (ret != 0) {
+        LOG_WRN("Vibration spectrum disabled: %d", ret);
+    }
+#endif
+    
+    sensor_manager_cursor_init(&ble_cursor);
+    sample_drain_init(&mqtt_drain, &mqtt_drain_ops, NULL, MQTT_WINDOW_WAIT_MS);
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+    sensor_manager_cursor_init(&batch_cursor);
+#endif
+    
     ret = sensor_manager_start();
     if (ret != 0) {
         LOG_ERR("Sensor manager start failed: %d", ret);
@@ -76,91 +178,452 @@ static int init_sensor_manager(void)
     return 0;
 }
 
+#ifdef CONFIG_APP_STORE_FORWARD
+static int init_store_forward(void)
+{
+    int ret = store_forward_init();
+    if (ret != 0) {
+        LOG_ERR("Store-and-forward log unavailable: %d", ret);
+    }
+    return ret;
+}
+#endif
+
 /*      DATA DISPLAY FUNCTIONS           */
 
+/* "%+6.2f" without FP printf: explicit sign, then right-aligned by printk */
+static const char *format_signed(char *buf, size_t size, float value)
+{
+    struct text_writer w;
+
+    text_writer_init(&w, buf, size);
+    if (!signbit(value)) {
+        text_put_char(&w, '+');
+    }
+    text_put_fixed(&w, value, 2);
+    text_finish(&w);
+    return buf;
+}
+
 static void display_sensor_data(const sensor_data_t *data, int counter)
 {
+    char num[TEXT_FIXED_MAX_LEN];
+
     printk("\n=== Sensor Data [%d] ===\n", counter);
-    printk(" Temperature: %.1f °C\n", (double)data->temperature_c);
-    printk(" Accelerometer:\n");
-    printk("    X: %+6.2f m/s²\n", (double)data->accel_x);
-    printk("    Y: %+6.2f m/s²\n", (double)data->accel_y);
-    printk("    Z: %+6.2f m/s²\n", (double)data->accel_z);
-    printk(" Battery: %.2f V\n", (double)data->battery_voltage);
+
+    /* Scalars on one line; vectors one signed component per line */
+#define SHOW_FIELD(name, type, n, value, mul, div, unit, label, json, keys, dec, cdec, ...) \
+    if ((n) == 1) {                                                             \
+        text_format_fixed(num, sizeof(num), *(const float *)&data->value, cdec); \
+        printk(" " label ": %s " unit "\n", num);                               \
+    } else {                                                                    \
+        printk(" " label ":\n");                                                \
+        for (int i = 0; i < (n); i++) {                                         \
+            printk("    %c: %6s " unit "\n", toupper((unsigned char)keys[i]),   \
+                   format_signed(num, sizeof(num), ((const float *)&data->value)[i])); \
+        }                                                                       \
+    }
+    SAMPLE_FIELDS(SHOW_FIELD)
+#undef SHOW_FIELD
 }
 
 /*     BLE NOTIFICATION HANDLER           */
 
-static void handle_ble_notification(const sensor_data_t *data, int counter)
+/* Move a cursor past every sample published so far, keeping its overflow count */
+static void skip_to_newest(sensor_cursor_t *cursor)
 {
+    uint32_t dropped = cursor->dropped;
+    
+    sensor_manager_cursor_init(cursor);
+    cursor->dropped = dropped;
+}
+
+/* Notify every sample since the last call; one left unsent waits in the ring */
+static void handle_ble_notifications(int counter)
+{
+    sensor_cursor_t next = ble_cursor;
+    sensor_sample_t sample;
+    unsigned int sent = 0;
+    unsigned int unchanged = 0;
+    
     if (!ble_service_is_connected()) {
         printk(" BLE: Not connected\n");
+#ifdef CONFIG_APP_REPORT_FILTER
+        report_filter_reset(&ble_filter);
+#endif
+        /* Live data only: skip what was sampled while disconnected */
+        skip_to_newest(&ble_cursor);
         return;
     }
     
     if (counter == 0) {
         printk(" BLE: Waiting for MTU negotiation...\n");
+        skip_to_newest(&ble_cursor);
         return;
     }
     
-    int ret = ble_service_notify(data);
-    if (ret == 0) {
-        printk("✓ BLE notification sent!\n");
-    } else if (ret == -EAGAIN) {
-        printk(" BLE: MTU not ready yet\n");
-    } else {
-        printk(" BLE notification failed: %d\n", ret);
+    while (sensor_manager_read_since(&next, &sample, 1) == 1) {
+        if (sample.valid_mask == 0) {
+            ble_cursor = next;
+            continue;
+        }
+        
+#ifdef CONFIG_APP_REPORT_FILTER
+        if (!report_filter_check(&ble_filter, &sample)) {
+            unchanged++;
+            ble_cursor = next;
+            continue;
+        }
+#endif
+        
+        int ret = ble_service_notify(&sample);
+        if (ret == -EAGAIN) {
+            printk(" BLE: MTU not ready yet\n");
+            break;
+        }
+        
+        if (ret == 0) {
+#ifdef CONFIG_APP_REPORT_FILTER
+            report_filter_commit(&ble_filter, &sample);
+#endif
+            sent++;
+        } else {
+            printk(" BLE notification failed: %d\n", ret);
+        }
+        ble_cursor = next;
+    }
+    
+    if (sent > 0) {
+        printk("✓ BLE: %u notifications sent, %u unchanged\n", sent, unchanged);
+    } else if (unchanged > 0) {
+        printk(" BLE: No significant change (%u samples)\n", unchanged);
     }
 }
 
 /*   MQTT PUBLICATION HANDLER   */
 
-static void handle_mqtt_publication(const sensor_data_t *data)
+/* Per-pass counts of the MQTT drain's send callback */
+struct mqtt_pass {
+    unsigned int published;
+    unsigned int unchanged;
+};
+
+static int mqtt_drain_send(const sensor_sample_t *sample, void *ctx)
 {
-    if (!mqtt_client_is_connected()) {
+    struct mqtt_pass *pass = ctx;
+    
+    if (sample->valid_mask == 0) {
+        return 0;
+    }
+    
+#ifdef CONFIG_APP_REPORT_FILTER
+    if (!report_filter_check(&mqtt_filter, sample)) {
+        pass->unchanged++;
+        return 0;
+    }
+#endif
+    
+    int ret = mqtt_client_publish_sensor_data(sample);
+    if (ret != 0) {
+        return ret;
+    }
+    
+#ifdef CONFIG_APP_REPORT_FILTER
+    report_filter_commit(&mqtt_filter, sample);
+#endif
+    pass->published++;
+    return 0;
+}
+
+#ifdef CONFIG_APP_MQTT_QOS1
+static int mqtt_drain_wait(k_timeout_t timeout, void *ctx)
+{
+    ARG_UNUSED(ctx);
+    return mqtt_client_wait_window(timeout);
+}
+#endif
+
+#ifdef CONFIG_APP_STORE_FORWARD
+/* Keep a sample MQTT could not take, for replay after reconnect */
+static int mqtt_drain_store(const sensor_sample_t *sample, void *ctx)
+{
+    ARG_UNUSED(ctx);
+    return sample->valid_mask == 0 ? 0 : store_forward_append(sample, 1);
+}
+#endif
+
+static const struct sample_drain_ops mqtt_drain_ops = {
+    .send = mqtt_drain_send,
+#ifdef CONFIG_APP_MQTT_QOS1
+    .wait = mqtt_drain_wait,
+#endif
+#ifdef CONFIG_APP_STORE_FORWARD
+    .store = mqtt_drain_store,
+#endif
+};
+
+/* Publish every sample since the last call. A full QoS 1 window is
+ * waited on for a bounded time; what a stalled window or a lost broker
+ * cannot take goes to flash, or waits in the ring without it. */
+static void handle_mqtt_publication(void)
+{
+    struct mqtt_pass pass = {0};
+    struct sample_drain_stats before = mqtt_drain.stats;
+    bool connected = mqtt_client_is_connected();
+    
+    if (!connected) {
         printk(" MQTT: Not connected\n");
-        return;
+#ifdef CONFIG_APP_REPORT_FILTER
+        report_filter_reset(&mqtt_filter);
+#endif
     }
     
-    int ret = mqtt_client_publish_sensor_data(data);
-    if (ret == 0) {
-        printk(" MQTT data published!\n");
-    } else {
-        printk(" MQTT publish failed: %d\n", ret);
+    mqtt_drain.ctx = &pass;
+    sample_drain_run(&mqtt_drain, connected);
+    
+    uint32_t stored = mqtt_drain.stats.stored - before.stored;
+    uint32_t lost = mqtt_drain.stats.lost - before.lost;
+    
+    if (pass.published > 0) {
+        printk(" MQTT: %u samples published, %u unchanged\n",
+               pass.published, pass.unchanged);
+    } else if (pass.unchanged > 0) {
+        printk(" MQTT: No significant change (%u samples)\n", pass.unchanged);
+    }
+    if (mqtt_drain.stats.stalls != before.stalls) {
+        printk(" MQTT: Window still full after %u ms\n", mqtt_drain.wait_budget_ms);
+    }
+#ifdef CONFIG_APP_STORE_FORWARD
+    if (stored > 0 || lost > 0) {
+        printk(" MQTT: %u samples stored, %u lost (%u to replay)\n",
+               stored, lost, store_forward_pending());
+    }
+#else
+    if (lost > 0) {
+        printk(" MQTT: %u samples lost\n", lost);
+    }
+    ARG_UNUSED(stored);
+#endif
+}
+
+/*   BATCH PUBLICATION HANDLER   */
+
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+static void handle_batch_publication(void)
+{
+    while (1) {
+        int n = sensor_manager_read_since(&batch_cursor, &batch[batch_count],
+                                          ARRAY_SIZE(batch) - batch_count);
+        if (n > 0) {
+            batch_count += n;
+        }
+        
+        bool full = (batch_count == ARRAY_SIZE(batch));
+        bool stale = (batch_count > 0 &&
+                      k_uptime_get_32() - batch[0].timestamp_ms >=
+                      CONFIG_APP_PAYLOAD_BATCH_MAX_AGE_MS);
+        if (!full && !stale) {
+            return;
+        }
+        
+        /* Keep the batch; newer samples wait in the ring meanwhile */
+        if (!mqtt_client_is_connected()) {
+#ifdef CONFIG_APP_STORE_FORWARD
+            /* ...or in flash, so the ring never overflows during an outage */
+            int ret = store_forward_append(batch, batch_count);
+            if (ret != 0) {
+                printk(" MQTT batch store failed: %d\n", ret);
+                return;
+            }
+            printk(" MQTT batch of %u samples stored (%u to replay)\n",
+                   (unsigned int)batch_count, store_forward_pending());
+            batch_count = 0;
+            continue;
+#else
+            return;
+#endif
+        }
+        
+        int ret = mqtt_client_publish_batch(batch, batch_count);
+        if (ret != 0) {
+            printk(" MQTT batch publish failed: %d\n", ret);
+            return;
+        }
+        
+        printk(" MQTT batch of %u samples published!\n", (unsigned int)batch_count);
+        batch_count = 0;
+    }
+}
+#endif
+
+/*   STORE-AND-FORWARD REPLAY HANDLER   */
+
+#ifdef CONFIG_APP_STORE_FORWARD
+/* PUBACK of a replayed PUBLISH; runs on the MQTT I/O thread */
+static void replay_ack_handler(uint32_t tag, size_t samples)
+{
+    if (tag == (uint32_t)atomic_get(&replay_seq)) {
+        atomic_add(&replay_acked, (atomic_val_t)samples);
+    }
+}
+
+/* Confirm the group in flash once the broker acknowledged all of it */
+static bool replay_group_done(void)
+{
+    uint32_t seq = (uint32_t)atomic_get(&replay_seq);
+
+    if (seq == 0) {
+        return true;
+    }
+    if ((uint32_t)atomic_get(&replay_acked) < replay_sent) {
+        return false;
     }
+
+    int ret = store_forward_ack(replay_confirm);
+    if (ret != 0) {
+        printk(" Replay cursor not saved: %d\n", ret);
+    }
+    atomic_set(&replay_seq, 0);
+    printk(" MQTT replay of %u samples acknowledged (%u left)\n",
+           replay_sent, store_forward_pending());
+    return true;
 }
 
+/*
+ * Oldest stored samples first, as fast as the replay credit allows. One
+ * group is in flight at a time: the next is only read once every PUBLISH
+ * of the last one got its PUBACK. Unacknowledged PUBLISHes are resent by
+ * the QoS 1 window, across reconnects; after a reset the group is read
+ * from flash again.
+ */
+static void handle_backlog_replay(void)
+{
+    int64_t now = k_uptime_get();
+    uint32_t earned = (uint32_t)MIN((now - replay_credit_at) *
+                                    CONFIG_APP_STORE_FORWARD_REPLAY_RATE / 1000,
+                                    REPLAY_CREDIT_MAX);
+
+    if (earned > 0) {
+        replay_credit = MIN(replay_credit + earned, REPLAY_CREDIT_MAX);
+        replay_credit_at = now;
+    }
+
+    while (replay_group_done() && mqtt_client_is_connected() &&
+           store_forward_pending() > 0) {
+        size_t want = MIN(ARRAY_SIZE(replay), store_forward_pending());
+        uint32_t seq;
+
+        if (replay_credit < want) {
+            return;
+        }
+
+        int n = store_forward_peek(replay, want, &seq);
+        if (n <= 0) {
+            return;
+        }
+
+        /* Armed first: a PUBACK may come before the publish returns */
+        atomic_set(&replay_acked, 0);
+        atomic_set(&replay_seq, seq);
+
+        int sent = mqtt_client_publish_replay(replay, n, seq);
+        if (sent < 0) {
+            atomic_set(&replay_seq, 0);
+            printk(" MQTT replay failed: %d\n", sent);
+            return;
+        }
+
+        replay_sent = sent;
+        replay_confirm = seq;
+        if (sent < n) {
+            /* Window full part way: only the samples sent are confirmed */
+            store_forward_peek(replay, sent, &replay_confirm);
+        }
+        replay_credit -= sent;
+        printk(" MQTT replayed %d stored samples, awaiting PUBACK\n", sent);
+    }
+}
+#endif
+
+/*   STATISTICS PUBLICATION HANDLER   */
+
+#ifdef CONFIG_APP_STATS
+static void handle_stats_publication(void)
+{
+    struct stats_summary summary;
+    
+    while (sample_stats_get_summary(&summary, K_NO_WAIT) == 0) {
+        if (!mqtt_client_is_connected()) {
+            continue;
+        }
+        
+        int ret = mqtt_client_publish_stats(&summary);
+        if (ret == 0) {
+            printk(" MQTT %u ms summary published!\n", summary.window_ms);
+        } else {
+            printk(" MQTT summary publish failed: %d\n", ret);
+        }
+    }
+}
+#endif
+
+/*   VIBRATION PUBLICATION HANDLER   */
+
+#ifdef CONFIG_APP_VIBRATION
+static void handle_spectrum_publication(void)
+{
+    struct vibration_spectrum spectrum;
+    
+    while (vibration_get_spectrum(&spectrum, K_NO_WAIT) == 0) {
+        if (!mqtt_client_is_connected()) {
+            continue;
+        }
+        
+        int ret = mqtt_client_publish_spectrum(&spectrum);
+        if (ret == 0) {
+            char peak[TEXT_FIXED_MAX_LEN];
+            
+            text_format_fixed(peak, sizeof(peak),
+                              spectrum.peak_count ? spectrum.peaks[0].freq_hz : 0.0f, 1);
+            printk(" MQTT spectrum published (peak %s Hz)\n", peak);
+        } else {
+            printk(" MQTT spectrum publish failed: %d\n", ret);
+        }
+    }
+}
+#endif
+
 /*   MAIN LOOP FUNCTIONS       */
 
 static void process_sensor_data(int counter)
 {
+    sensor_sample_t sample;
     sensor_data_t data;
-    int ret = sensor_manager_get_data(&data);
+    int ret = sensor_manager_get_sample(&sample);
     
+    if (ret == 0) {
+        sensor_sample_to_data(&sample, &data);
+    }
     if (ret != 0 || !data.valid) {
         printk(" No valid sensor data (ret=%d)\n", ret);
-        return;
+    } else {
+        // Display the newest sample
+        display_sensor_data(&data, counter);
     }
     
-    // Display sensor data
-    display_sensor_data(&data, counter);
-    
     // Send via BLE
-    handle_ble_notification(&data, counter);
+    handle_ble_notifications(counter);
     
     // Publish via MQTT
-    handle_mqtt_publication(&data);
+    if (MQTT_PER_SAMPLE) {
+        handle_mqtt_publication();
+    }
     
     printk("\n");
 }
 
 static void process_maintenance_tasks(int counter)
 {
-    // Process MQTT events
-    if (mqtt_client_is_connected()) {
-        mqtt_client_process();
-    }
-    
     // Feed watchdog
     power_manager_feed_watchdog();
     
@@ -169,6 +632,55 @@ static void process_maintenance_tasks(int counter)
             counter,
             ble_service_is_connected() ? "✓" : "✗",
             mqtt_client_is_connected() ? "✓" : "✗");
+    
+#ifdef CONFIG_APP_REPORT_FILTER
+    LOG_INF("Reports sent/suppressed | BLE: %u/%u | MQTT: %u/%u",
+            ble_filter.sent, ble_filter.suppressed,
+            mqtt_filter.sent, mqtt_filter.suppressed);
+#endif
+    
+    struct conn_stats conn;
+    
+    conn_manager_get_stats(&conn);
+    LOG_INF("Losses link/IP/broker: %u/%u/%u | last recovery %u/%u/%u ms | "
+            "%u associations, %u DHCP restarts, %u broker connects",
+            conn.losses[CONN_LOSS_LINK], conn.losses[CONN_LOSS_IP],
+            conn.losses[CONN_LOSS_BROKER], conn.recovery_ms[CONN_LOSS_LINK],
+            conn.recovery_ms[CONN_LOSS_IP], conn.recovery_ms[CONN_LOSS_BROKER],
+            conn.link_attempts, conn.ip_renewals, conn.broker_attempts);
+    
+#ifdef CONFIG_APP_MQTT_QOS1
+    struct mqtt_qos1_stats qos1;
+    
+    if (mqtt_client_get_qos1_stats(&qos1) == 0) {
+        LOG_INF("MQTT QoS 1: %u in flight (peak %u) | %u sent / %u acked / %u resent, "
+                "%u window full | RTT %u ms (avg %u, max %u)",
+                qos1.in_flight, qos1.in_flight_peak, qos1.sent, qos1.acked,
+                qos1.retransmits, qos1.window_full,
+                qos1.rtt_last_ms, qos1.rtt_avg_ms, qos1.rtt_max_ms);
+    }
+    if (MQTT_PER_SAMPLE) {
+        LOG_INF("MQTT drain: %u sent / %u stored / %u lost | %u window waits, %u stalls",
+                mqtt_drain.stats.sent, mqtt_drain.stats.stored, mqtt_drain.stats.lost,
+                mqtt_drain.stats.waits, mqtt_drain.stats.stalls);
+    }
+#endif
+    
+    LOG_INF("Lost to history overflow | BLE: %u | MQTT: %u",
+            ble_cursor.dropped, MQTT_PER_SAMPLE ? mqtt_drain.cursor.dropped : 0U);
+    
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+    LOG_INF("Batch: %u pending, %u lost to history overflow",
+            (unsigned int)batch_count, batch_cursor.dropped);
+#endif
+    
+#ifdef CONFIG_APP_STORE_FORWARD
+    struct store_forward_stats store;
+    
+    store_forward_get_stats(&store);
+    LOG_INF("Flash log: %u to replay | %u stored / %u replayed / %u dropped, %u erases",
+            store.pending, store.stored, store.replayed, store.dropped, store.erased);
+#endif
 }
 
 static void sleep_cycle(void)
@@ -190,6 +702,15 @@ int main(void)
     // Initialize all subsystems
     init_power_manager();
     
+#ifdef CONFIG_APP_STORE_FORWARD
+    init_store_forward();
+#endif
+    
+#ifdef CONFIG_APP_REPORT_FILTER
+    report_filter_init(&ble_filter, "ble", &report_filter_default_config);
+    report_filter_init(&mqtt_filter, "mqtt", &report_filter_default_config);
+#endif
+    
     ret = init_mqtt_client();
     if (ret != 0) {
         LOG_WRN("Continuing without MQTT...");
@@ -210,6 +731,18 @@ int main(void)
     
     while (1) {
         process_sensor_data(counter);
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+        handle_batch_publication();
+#endif
+#ifdef CONFIG_APP_STATS
+        handle_stats_publication();
+#endif
+#ifdef CONFIG_APP_VIBRATION
+        handle_spectrum_publication();
+#endif
+#ifdef CONFIG_APP_STORE_FORWARD
+        handle_backlog_replay();
+#endif
         process_maintenance_tasks(counter);
         counter++;
         sleep_cycle();
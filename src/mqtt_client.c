@@ -10,11 +10,37 @@
 #include <zephyr/net/net_ip.h>
 #include <zephyr/net/net_if.h>
 #include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/net/dhcpv4.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/random/random.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/zvfs/eventfd.h>
 
 #include "mqtt_client.h"
 #include "app_config.h"
+#include "conn_manager.h"
+#include "fast_boot.h"
+
+#ifdef CONFIG_APP_PAYLOAD_TS_COMPRESS
+#include "ts_compress.h"
+#endif
+
+#ifdef CONFIG_APP_PAYLOAD_LZ
+#include "lz_compress.h"
+#endif
+
+#if defined(CONFIG_APP_MQTT_STREAM_PUBLISH) || defined(CONFIG_APP_PAYLOAD_LZ)
+#include "text_writer.h"
+#endif
+
+#ifdef CONFIG_APP_MQTT_QOS1
+#include "mqtt_qos1.h"
+#endif
+
+#ifdef CONFIG_APP_VIBRATION
+#include "vibration.h"
+#endif
 
 LOG_MODULE_REGISTER(app_mqtt, LOG_LEVEL_INF);
 
@@ -23,6 +49,44 @@ extern int json_encode_sensor_data_with_metadata(const sensor_data_t *data,
                                                  char *buffer,
                                                  size_t buffer_size,
                                                  const char *device_id);
+extern int json_encode_stats_summary(const struct stats_summary *summary,
+                                     char *buffer,
+                                     size_t buffer_size,
+                                     const char *device_id);
+extern int json_encode_vibration_spectrum(const struct vibration_spectrum *spectrum,
+                                          char *buffer,
+                                          size_t buffer_size,
+                                          const char *device_id);
+extern int json_encode_sensor_batch(const sensor_sample_t *samples,
+                                    size_t count,
+                                    char *buffer,
+                                    size_t buffer_size,
+                                    const char *device_id);
+#if defined(CONFIG_APP_MQTT_STREAM_PUBLISH) || defined(CONFIG_APP_PAYLOAD_LZ)
+extern void json_write_sensor_batch(struct text_writer *w,
+                                    const sensor_sample_t *samples,
+                                    size_t count,
+                                    const char *device_id);
+#endif
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+extern void json_write_stats_summary(struct text_writer *w,
+                                     const struct stats_summary *summary,
+                                     const char *device_id);
+extern void json_write_vibration_spectrum(struct text_writer *w,
+                                          const struct vibration_spectrum *spectrum,
+                                          const char *device_id);
+#endif
+
+/* CBOR encoder */
+extern int cbor_encode_sensor_data_with_metadata(const sensor_data_t *data,
+                                                 uint8_t *buffer,
+                                                 size_t buffer_size,
+                                                 const char *device_id);
+extern int cbor_encode_sensor_batch(const sensor_sample_t *samples,
+                                    size_t count,
+                                    uint8_t *buffer,
+                                    size_t buffer_size,
+                                    const char *device_id);
 
 /* MQTT client context */
 static struct mqtt_client client;
@@ -31,19 +95,141 @@ static uint8_t tx_buffer[512];
 
 static struct mqtt_utf8 client_id_utf8;
 static struct mqtt_utf8 pub_topic_utf8;
+static struct mqtt_utf8 cbor_topic_utf8;
+static struct mqtt_utf8 stats_topic_utf8;
+static struct mqtt_utf8 vibration_topic_utf8;
+static struct mqtt_utf8 batch_topic_utf8;
+static struct mqtt_utf8 batch_cbor_topic_utf8;
+static struct mqtt_utf8 batch_lz_topic_utf8;
+static struct mqtt_utf8 batch_cbor_lz_topic_utf8;
+static struct mqtt_utf8 batch_ts_topic_utf8;
+
+#ifdef CONFIG_APP_VIBRATION
+/* Longest spectrum JSON, which outgrows JSON_BUFFER_SIZE with many bands */
+#define SPECTRUM_JSON_SIZE (SPECTRUM_HEADER_MAX_LEN + sizeof(MQTT_CLIENT_ID) + \
+                            VIBRATION_BAND_COUNT * SPECTRUM_BAND_MAX_LEN + \
+                            VIBRATION_PEAK_COUNT * SPECTRUM_PEAK_MAX_LEN)
+#define MESSAGE_PAYLOAD_SIZE MAX(JSON_BUFFER_SIZE, SPECTRUM_JSON_SIZE)
+#else
+#define MESSAGE_PAYLOAD_SIZE JSON_BUFFER_SIZE
+#endif
+
+/* Too large for the caller's stack; only the main loop publishes samples,
+ * statistics and spectra */
+static uint8_t message_payload[MESSAGE_PAYLOAD_SIZE];
+
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+/* Longest JSON batch */
+#define BATCH_JSON_SIZE (BATCH_HEADER_MAX_LEN + CONFIG_APP_PAYLOAD_BATCH_SIZE * BATCH_ROW_MAX_LEN)
+
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+/* JSON batches are streamed, so only the CBOR form is buffered */
+#define BATCH_PAYLOAD_SIZE (BATCH_HEADER_MAX_LEN + \
+                            CONFIG_APP_PAYLOAD_BATCH_SIZE * BATCH_CBOR_ROW_MAX_LEN)
+#elif defined(CONFIG_APP_PAYLOAD_LZ)
+/* Room for an incompressible JSON batch; CBOR ones are compressed in place */
+#define BATCH_PAYLOAD_SIZE LZ_COMPRESS_BOUND(BATCH_JSON_SIZE)
+#else
+#define BATCH_PAYLOAD_SIZE BATCH_JSON_SIZE
+#endif
+
+/* Too large for the caller's stack; only the main loop publishes batches */
+#if defined(CONFIG_APP_PAYLOAD_CBOR) || !defined(CONFIG_APP_MQTT_STREAM_PUBLISH)
+static uint8_t batch_payload[BATCH_PAYLOAD_SIZE];
+#endif
+
+#ifdef CONFIG_APP_PAYLOAD_LZ
+BUILD_ASSERT(CONFIG_APP_PAYLOAD_LZ_LOOKAHEAD_BITS < CONFIG_APP_PAYLOAD_LZ_WINDOW_BITS,
+             "LZ matches must be shorter than the window");
+
+#ifdef CONFIG_APP_PAYLOAD_CBOR
+BUILD_ASSERT(BATCH_PAYLOAD_SIZE - LZ_COMPRESS_IN_PLACE_OFFSET(BATCH_PAYLOAD_SIZE) >=
+             BATCH_HEADER_MAX_LEN + CONFIG_APP_PAYLOAD_BATCH_SIZE * BATCH_CBOR_ROW_MAX_LEN,
+             "No room to compress a CBOR batch in place");
+#endif
+
+static uint8_t lz_work[LZ_COMPRESS_WORK_SIZE(CONFIG_APP_PAYLOAD_LZ_WINDOW_BITS)];
+#endif
+#endif
 
 static struct sockaddr_storage broker;
+static bool broker_resolved;    /* Connection manager thread only */
 static bool mqtt_connected = false;
+static enum payload_format payload_format = PAYLOAD_FORMAT_DEFAULT;
 
 /* WiFi - TWO SEPARATE CALLBACKS like working test_wifi */
 static struct net_mgmt_event_callback wifi_cb;
 static struct net_mgmt_event_callback ipv4_cb;  // ✅ SEPARATE callback for IPv4
 
-static K_SEM_DEFINE(wifi_connected_sem, 0, 1);
-static K_SEM_DEFINE(ipv4_assigned, 0, 1);
+static bool wifi_associated;
+
+/* Boot-time shortcuts from the connection cache */
+static bool link_cache_tried;   /* Only the first association after boot */
+static bool link_from_cache;    /* Association in progress uses the cached BSSID */
+static bool lease_from_cache;   /* Cached address in use until DHCP confirms it */
+static struct in_addr lease_addr;
+static bool broker_from_cache;  /* Connection manager thread only */
+
+/* Ties a cached item to the name it was found for */
+static uint32_t name_crc(const char *name)
+{
+    return crc32_ieee((const uint8_t *)name, strlen(name));
+}
+
+/* MQTT I/O thread: the only thread that touches the broker socket */
+static K_THREAD_STACK_DEFINE(io_stack, MQTT_THREAD_STACK_SIZE);
+static struct k_thread io_thread;
+
+/* Socket work run on the I/O thread while the caller waits */
+struct io_request {
+    int (*op)(const void *arg);
+    const void *arg;
+    int result;
+    struct k_sem done;
+};
+
+K_MSGQ_DEFINE(mqtt_io_queue, sizeof(struct io_request *), MQTT_IO_QUEUE_SIZE, 4);
+
+static int io_wake_fd = -1;     /* eventfd written after each queued request */
+static bool sock_open;          /* Connecting or connected; I/O thread only */
+static K_SEM_DEFINE(connack_sem, 0, 1);
+
+#ifdef CONFIG_APP_MQTT_QOS1
+/* Largest payload a QoS 1 PUBLISH can keep for retransmission */
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+#define QOS1_PAYLOAD_SIZE MAX(MESSAGE_PAYLOAD_SIZE, MAX(BATCH_JSON_SIZE, BATCH_PAYLOAD_SIZE))
+#else
+#define QOS1_PAYLOAD_SIZE MESSAGE_PAYLOAD_SIZE
+#endif
+
+/* Copy of a PUBLISH waiting for its PUBACK, indexed like the window slots */
+struct qos1_message {
+    struct mqtt_utf8 topic;
+    uint32_t tag;               /* Reported to ack_cb on PUBACK; 0 if untagged */
+    uint16_t samples;           /* Samples the payload carries, for ack_cb */
+    uint16_t len;
+    uint8_t payload[QOS1_PAYLOAD_SIZE];
+};
+
+/* I/O thread only */
+static struct mqtt_qos1_window qos1_window;
+static struct qos1_message qos1_messages[CONFIG_APP_MQTT_QOS1_WINDOW];
+static K_SEM_DEFINE(window_sem, 0, 1);  /* Given when a window slot frees */
+static bool qos1_resend;        /* Resend the window after CONNACK */
+
+static mqtt_client_ack_cb_t ack_cb;
+#endif
 
-/* Forward declarations */
-static int wifi_connect(void);
+/* A PUBLISH handed to the I/O thread */
+struct publish_job {
+    struct mqtt_publish_param param;
+    uint32_t tag;
+    uint16_t samples;
+};
+
+/* Tag of the replay being published; publishing thread only */
+static uint32_t publish_tag;
+static uint16_t publish_samples;
 
 /**
  * @brief Handle IPv4 address assignment - COPIED FROM WORKING test_wifi
@@ -63,12 +249,55 @@ static void handle_ipv4_result(struct net_if *iface)
             LOG_INF("========================================");
             LOG_INF("ESP32-S3 IP Address: %s", ip_addr);
             LOG_INF("========================================");
-            k_sem_give(&ipv4_assigned);  // ✅ Signal IP is ready!
+            fast_boot_mark(FAST_BOOT_MARK_IP);
+            conn_manager_notify(CONN_EVENT_IP_UP);
             return;
         }
     }
 }
 
+/**
+ * @brief Take the cached lease right after a cached association
+ *
+ * The driver's DHCP client still runs; handle_dhcp_bound() hands the
+ * address over to it.
+ */
+static void apply_cached_lease(struct net_if *iface)
+{
+    char ip_addr[NET_IPV4_ADDR_LEN];
+
+    if (!fast_boot_lease_apply(iface, &lease_addr)) {
+        return;
+    }
+    lease_from_cache = true;
+
+    net_addr_ntop(AF_INET, &lease_addr, ip_addr, sizeof(ip_addr));
+    LOG_INF("Using cached address %s until DHCP answers", ip_addr);
+    fast_boot_mark(FAST_BOOT_MARK_IP);
+    conn_manager_notify(CONN_EVENT_IP_UP);
+}
+
+/**
+ * @brief Drop the manual cached address once DHCP is bound
+ *
+ * A different address from DHCP has already come up through
+ * handle_ipv4_result(), and the stale one is removed. The same address was
+ * left manual by DHCP's add, and is re-added as DHCP's.
+ */
+static void handle_dhcp_bound(struct net_if *iface)
+{
+    if (!lease_from_cache) {
+        return;
+    }
+    lease_from_cache = false;
+
+    if (fast_boot_lease_bound(iface, &lease_addr,
+                              &iface->config.dhcpv4.requested_ip,
+                              iface->config.dhcpv4.lease_time)) {
+        LOG_INF("DHCP confirmed the cached address");
+    }
+}
+
 /**
  * @brief WiFi event handler
  */
@@ -82,18 +311,26 @@ static void wifi_mgmt_event_handler(struct net_mgmt_event_callback *cb,
             const struct wifi_status *status = (const struct wifi_status *)cb->info;
             if (status->status) {
                 LOG_ERR("WiFi connection failed (status: %d)", status->status);
+                conn_manager_notify(CONN_EVENT_LINK_FAILED);
             } else {
                 LOG_INF("WiFi connected successfully");
-                k_sem_give(&wifi_connected_sem);
+                wifi_associated = true;
+                fast_boot_mark(FAST_BOOT_MARK_LINK);
+                conn_manager_notify(CONN_EVENT_LINK_UP);
+                if (link_from_cache) {
+                    link_from_cache = false;
+                    apply_cached_lease(iface);
+                }
             }
         }
         break;
 
     case NET_EVENT_WIFI_DISCONNECT_RESULT:
         LOG_WRN("WiFi disconnected");
+        wifi_associated = false;
+        /* The session is dead too, though TCP has not noticed yet */
         mqtt_connected = false;
-        k_sem_reset(&wifi_connected_sem);
-        k_sem_reset(&ipv4_assigned);
+        conn_manager_notify(CONN_EVENT_LINK_DOWN);
         break;
 
     default:
@@ -110,11 +347,29 @@ static void ipv4_mgmt_event_handler(struct net_mgmt_event_callback *cb,
 {
     if (mgmt_event == NET_EVENT_IPV4_ADDR_ADD) {  // ✅ This event WORKS!
         handle_ipv4_result(iface);
+    } else if (mgmt_event == NET_EVENT_IPV4_DHCP_BOUND) {
+        handle_dhcp_bound(iface);
+    } else if (mgmt_event == NET_EVENT_IPV4_ADDR_DEL) {
+        struct net_if *owner;
+
+        if (cb->info != NULL && net_if_ipv4_addr_lookup(cb->info, &owner)) {
+            /* Removed and added back, e.g. the cached lease handed to DHCP */
+            return;
+        }
+
+        LOG_WRN("IPv4 address removed");
+        mqtt_connected = false;
+        if (net_if_ipv4_get_global_addr(iface, NET_ADDR_PREFERRED)) {
+            /* Replaced, e.g. the cached lease by DHCP's: only the session is lost */
+            conn_manager_notify(CONN_EVENT_BROKER_DOWN);
+        } else {
+            conn_manager_notify(CONN_EVENT_IP_DOWN);
+        }
     }
 }
 
 /**
- * @brief Connect to WiFi
+ * @brief Request WiFi association; the outcome arrives as a net_mgmt event
  */
 static int wifi_connect(void)
 {
@@ -123,7 +378,21 @@ static int wifi_connect(void)
 
     if (!iface) {
         LOG_ERR("No default network interface found");
-        return -1;
+        return -ENODEV;
+    }
+
+    broker_resolved = false;
+
+    if (link_from_cache) {
+        /* The cached access point did not answer: scan from now on */
+        link_from_cache = false;
+        fast_boot_forget(FAST_BOOT_LINK);
+    }
+
+    if (wifi_associated) {
+        /* Associated but without an address: start over */
+        net_mgmt(NET_REQUEST_WIFI_DISCONNECT, iface, NULL, 0);
+        wifi_associated = false;
     }
 
     params.ssid = WIFI_SSID;
@@ -133,25 +402,46 @@ static int wifi_connect(void)
     params.channel = WIFI_CHANNEL_ANY;
     params.security = WIFI_SECURITY_TYPE_PSK;
 
+    struct fast_boot_link link;
+
+    if (!link_cache_tried && fast_boot_get(FAST_BOOT_LINK, &link, sizeof(link))) {
+        if (link.ssid_crc == name_crc(WIFI_SSID)) {
+            /* Skip the scan: straight to the access point that worked last */
+            memcpy(params.bssid, link.bssid, sizeof(link.bssid));
+            params.channel = link.channel;
+            link_from_cache = true;
+            LOG_INF("Associating with cached %02x:%02x:%02x:%02x:%02x:%02x on channel %u",
+                    link.bssid[0], link.bssid[1], link.bssid[2],
+                    link.bssid[3], link.bssid[4], link.bssid[5], link.channel);
+        } else {
+            fast_boot_forget(FAST_BOOT_LINK);
+        }
+    }
+    link_cache_tried = true;
+
     LOG_INF("Connecting to WiFi SSID: %s", WIFI_SSID);
 
     if (net_mgmt(NET_REQUEST_WIFI_CONNECT, iface, &params, sizeof(params))) {
         LOG_ERR("WiFi connection request failed");
-        return -1;
+        return -EIO;
     }
 
-    // Wait for WiFi connection (optional, can skip to IP wait)
-    // k_sem_take(&wifi_connected_sem, K_SECONDS(30));
+    return 0;
+}
 
-    // ✅ Wait for IP address assignment
-    LOG_INF("Waiting for IP address...");
-    int ret = k_sem_take(&ipv4_assigned, K_SECONDS(30));
-    if (ret != 0) {
-        LOG_ERR("DHCP timeout - no IP address assigned");
-        return -ETIMEDOUT;
+/* Ask for an address again on the current association */
+static int dhcp_restart(void)
+{
+    struct net_if *iface = net_if_get_default();
+
+    if (!iface) {
+        return -ENODEV;
     }
 
-    LOG_INF("✓ WiFi connected with IP assigned!");
+    LOG_INF("Restarting DHCP");
+    /* The new network may resolve the broker differently */
+    broker_resolved = false;
+    net_dhcpv4_restart(iface);
     return 0;
 }
 
@@ -167,27 +457,67 @@ static void mqtt_evt_handler(struct mqtt_client *mqtt,
         } else {
             mqtt_connected = true;
             LOG_INF("✓ MQTT connected");
+            fast_boot_mark(FAST_BOOT_MARK_BROKER);
+#ifdef CONFIG_APP_MQTT_QOS1
+            qos1_resend = true;
+#endif
         }
+        k_sem_give(&connack_sem);
         break;
 
     case MQTT_EVT_DISCONNECT:
         LOG_INF("MQTT disconnected");
         mqtt_connected = false;
+        sock_open = false;
+        /* A session closed before CONNACK fails the connect at once */
+        k_sem_give(&connack_sem);
+#ifdef CONFIG_APP_MQTT_QOS1
+        /* Nor should a publisher keep waiting on a window that won't drain */
+        k_sem_give(&window_sem);
+#endif
+        conn_manager_notify(CONN_EVENT_BROKER_DOWN);
+        break;
+
+#ifdef CONFIG_APP_MQTT_QOS1
+    case MQTT_EVT_PUBACK: {
+        int slot = mqtt_qos1_ack(&qos1_window, evt->param.puback.message_id,
+                                 k_uptime_get_32());
+        if (slot < 0) {
+            LOG_WRN("PUBACK for unknown packet %u", evt->param.puback.message_id);
+            break;
+        }
+        if (qos1_messages[slot].tag != 0 && ack_cb != NULL) {
+            ack_cb(qos1_messages[slot].tag, qos1_messages[slot].samples);
+        }
+        k_sem_give(&window_sem);
         break;
+    }
+#endif
 
     default:
         break;
     }
 }
 
-/* Resolve broker hostname */
+/* Resolve broker hostname, or take the address it resolved to last time */
 static int broker_init(void)
 {
     struct sockaddr_in *b = (struct sockaddr_in *)&broker;
+    struct fast_boot_broker cached;
 
     b->sin_family = AF_INET;
     b->sin_port = htons(MQTT_BROKER_PORT);
 
+    broker_from_cache = false;
+    if (fast_boot_get(FAST_BOOT_BROKER, &cached, sizeof(cached))) {
+        if (cached.name_crc == name_crc(MQTT_BROKER_ADDR)) {
+            memcpy(&b->sin_addr, cached.addr, sizeof(b->sin_addr));
+            broker_from_cache = true;
+            return 0;
+        }
+        fast_boot_forget(FAST_BOOT_BROKER);
+    }
+
     struct zsock_addrinfo hints = {
         .ai_family = AF_INET,
         .ai_socktype = SOCK_STREAM,
@@ -207,33 +537,418 @@ static int broker_init(void)
     return 0;
 }
 
-/* Reconnection thread */
-static K_THREAD_STACK_DEFINE(reconnect_stack, 2048);
-static struct k_thread reconnect_thread;
+/* Inbound packets; the library drops the session itself on a read error */
+static void io_handle_socket(short revents)
+{
+    if (revents & ZSOCK_POLLIN) {
+        int ret = mqtt_input(&client);
+        if (ret < 0 && ret != -EAGAIN && sock_open) {
+            LOG_ERR("MQTT input failed: %d", ret);
+            mqtt_abort(&client);
+        }
+    }
+
+    if (sock_open && (revents & (ZSOCK_POLLERR | ZSOCK_POLLHUP | ZSOCK_POLLNVAL))) {
+        LOG_WRN("Broker socket closed (revents 0x%x)", revents);
+        mqtt_abort(&client);
+    }
+}
+
+#ifdef CONFIG_APP_MQTT_QOS1
+static int qos1_transmit(int slot, bool dup)
+{
+    struct qos1_message *msg = &qos1_messages[slot];
+    struct mqtt_publish_param param = {
+        .message.topic.topic = msg->topic,
+        .message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+        .message.payload.data = msg->payload,
+        .message.payload.len = msg->len,
+        .message_id = qos1_window.slots[slot].id,
+        .dup_flag = dup,
+        .retain_flag = 0,
+    };
+
+    return mqtt_publish(&client, &param);
+}
+
+/* First transmission of a filled slot; the slot is freed if it fails */
+static int qos1_send(int slot)
+{
+    int ret = qos1_transmit(slot, false);
+    if (ret < 0) {
+        mqtt_qos1_release(&qos1_window, slot);
+        return ret;
+    }
+
+    mqtt_qos1_sent(&qos1_window, slot, k_uptime_get_32());
+    return 0;
+}
+
+/* Copy the payload into a free slot and send it; -EAGAIN if none is free */
+static int qos1_publish(const struct publish_job *job)
+{
+    const struct mqtt_publish_param *param = &job->param;
+    uint16_t id;
+
+    if (!mqtt_connected) {
+        return -ENOTCONN;
+    }
+    if (param->message.payload.len > QOS1_PAYLOAD_SIZE) {
+        return -EMSGSIZE;
+    }
+
+    int slot = mqtt_qos1_reserve(&qos1_window, &id);
+    if (slot < 0) {
+        return slot;
+    }
+
+    struct qos1_message *msg = &qos1_messages[slot];
+
+    msg->topic = param->message.topic.topic;
+    msg->tag = job->tag;
+    msg->samples = job->samples;
+    msg->len = param->message.payload.len;
+    memcpy(msg->payload, param->message.payload.data, msg->len);
+
+    return qos1_send(slot);
+}
+
+/**
+ * @brief Resend the window after a reconnect, and any overdue PUBLISH
+ * @return Time until the next PUBACK falls due, or -1 if none is awaited
+ */
+static int qos1_retransmit(void)
+{
+    uint32_t now = k_uptime_get_32();
+    int32_t wait;
+    int slot;
+
+    if (!mqtt_connected) {
+        return -1;
+    }
+
+    if (qos1_resend) {
+        qos1_resend = false;
+        for (int i = 0; i < CONFIG_APP_MQTT_QOS1_WINDOW; i++) {
+            const struct mqtt_qos1_slot *s = &qos1_window.slots[i];
+
+            if (s->id != 0 && s->sent && qos1_transmit(i, true) == 0) {
+                mqtt_qos1_resent(&qos1_window, i, now, false);
+            }
+        }
+    }
+
+    while ((slot = mqtt_qos1_next_due(&qos1_window, now, &wait)) >= 0) {
+        uint16_t id = qos1_window.slots[slot].id;
+
+        /* Still no PUBACK: the session is dead, and the reconnect resends */
+        if (qos1_window.slots[slot].retries >= CONFIG_APP_MQTT_QOS1_MAX_RETRIES) {
+            LOG_WRN("No PUBACK for packet %u, dropping the session", id);
+            mqtt_abort(&client);
+            return -1;
+        }
+
+        int ret = qos1_transmit(slot, true);
+        if (ret < 0) {
+            LOG_ERR("Retransmission of packet %u failed: %d", id, ret);
+            mqtt_abort(&client);
+            return -1;
+        }
+        mqtt_qos1_resent(&qos1_window, slot, now, true);
+    }
+
+    return wait;
+}
+#endif
+
+/* Shorter of two poll timeouts, where -1 waits forever */
+static int timeout_min(int a, int b)
+{
+    if (a < 0) {
+        return b;
+    }
+    if (b < 0) {
+        return a;
+    }
+    return MIN(a, b);
+}
 
-static void reconnect_thread_func(void *a, void *b, void *c)
+/**
+ * @brief MQTT I/O thread
+ *
+ * Sleeps in zsock_poll() on the broker socket and the wake-up eventfd.
+ * It wakes when the broker sends something, when the keepalive falls due
+ * or when another thread queues a request, so CONNACK, PUBACK and PINGRESP
+ * are handled as they arrive and nothing polls on a timer.
+ */
+static void io_thread_func(void *a, void *b, void *c)
 {
+    struct zsock_pollfd fds[2] = {
+        {.fd = io_wake_fd, .events = ZSOCK_POLLIN},
+        {.events = ZSOCK_POLLIN},
+    };
+    struct io_request *req;
+
     ARG_UNUSED(a);
     ARG_UNUSED(b);
     ARG_UNUSED(c);
-    
+
     while (1) {
-        k_sleep(K_SECONDS(30));
-        
-        if (!mqtt_connected) {
-            LOG_WRN("MQTT disconnected, attempting reconnection...");
-            
-            int ret = wifi_connect();
-            if (ret == 0) {
-                ret = mqtt_client_connect();
-                if (ret == 0) {
-                    LOG_INF("✓ Reconnected to MQTT broker");
-                }
+        int nfds = 1;
+        int timeout = -1;
+
+#ifdef CONFIG_APP_MQTT_QOS1
+        /* May drop the session, so before the socket is picked */
+        if (sock_open) {
+            timeout = qos1_retransmit();
+        }
+#endif
+
+        if (sock_open) {
+            fds[1].fd = client.transport.tcp.sock;
+            nfds = 2;
+            /* Wake for the next PINGREQ too; -1 with keepalive off */
+            timeout = timeout_min(timeout, mqtt_keepalive_time_left(&client));
+        }
+
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        if (zsock_poll(fds, nfds, timeout) < 0) {
+            LOG_ERR("poll failed: %d", errno);
+            k_sleep(K_MSEC(100));
+        }
+
+        if (nfds == 2 && fds[1].revents != 0) {
+            io_handle_socket(fds[1].revents);
+        }
+
+        if (sock_open) {
+            int ret = mqtt_live(&client);
+            if (ret < 0 && ret != -EAGAIN) {
+                LOG_ERR("MQTT keepalive failed: %d", ret);
+                mqtt_abort(&client);
             }
         }
+
+        /* Clear the wake-up first: a request queued after it wakes us again */
+        if (fds[0].revents & ZSOCK_POLLIN) {
+            zvfs_eventfd_t count;
+
+            zvfs_eventfd_read(io_wake_fd, &count);
+        }
+
+        while (k_msgq_get(&mqtt_io_queue, &req, K_NO_WAIT) == 0) {
+            req->result = req->op(req->arg);
+            k_sem_give(&req->done);
+        }
+    }
+}
+
+static int io_start(void)
+{
+    io_wake_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+    if (io_wake_fd < 0) {
+        int err = -errno;
+
+        LOG_ERR("MQTT wake-up eventfd failed: %d", err);
+        return err;
+    }
+
+    k_thread_create(&io_thread, io_stack, K_THREAD_STACK_SIZEOF(io_stack),
+                    io_thread_func, NULL, NULL, NULL,
+                    MQTT_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&io_thread, "mqtt_io");
+    return 0;
+}
+
+/* Run op on the I/O thread and return its result */
+static int io_call(int (*op)(const void *arg), const void *arg)
+{
+    struct io_request req = {.op = op, .arg = arg};
+    struct io_request *ptr = &req;
+
+    if (io_wake_fd < 0) {
+        return -ENODEV;
+    }
+
+    k_sem_init(&req.done, 0, 1);
+
+    int ret = k_msgq_put(&mqtt_io_queue, &ptr, K_FOREVER);
+    if (ret != 0) {
+        return ret;
+    }
+
+    zvfs_eventfd_write(io_wake_fd, 1);
+    k_sem_take(&req.done, K_FOREVER);
+    return req.result;
+}
+
+static int io_connect(const void *arg)
+{
+    ARG_UNUSED(arg);
+
+    if (sock_open) {
+        /* Stale session, e.g. WiFi dropped under it */
+        mqtt_abort(&client);
+    }
+
+    k_sem_reset(&connack_sem);
+
+    int ret = mqtt_connect(&client);
+    if (ret == 0) {
+        sock_open = true;
+    }
+    return ret;
+}
+
+static int io_abort(const void *arg)
+{
+    ARG_UNUSED(arg);
+
+    if (sock_open) {
+        mqtt_abort(&client);
+    }
+    return 0;
+}
+
+static int io_disconnect(const void *arg)
+{
+    struct mqtt_disconnect_param disc_param = {0};
+
+    ARG_UNUSED(arg);
+
+    if (!sock_open) {
+        return 0;
+    }
+    return mqtt_disconnect(&client, &disc_param);
+}
+
+static int io_publish(const void *arg)
+{
+    const struct publish_job *job = arg;
+
+#ifdef CONFIG_APP_MQTT_QOS1
+    if (job->param.message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+        return qos1_publish(job);
+    }
+#endif
+    return mqtt_publish(&client, &job->param);
+}
+
+#ifdef CONFIG_APP_MQTT_QOS1
+static int io_get_qos1_stats(const void *arg)
+{
+    struct mqtt_qos1_stats *stats = (struct mqtt_qos1_stats *)arg;
+
+    *stats = qos1_window.stats;
+    return 0;
+}
+
+static int io_set_ack_callback(const void *arg)
+{
+    ack_cb = *(const mqtt_client_ack_cb_t *)arg;
+    return 0;
+}
+#endif
+
+static int mqtt_client_connect(void)
+{
+    int ret = io_call(io_connect, NULL);
+    if (ret < 0) {
+        LOG_ERR("mqtt_connect failed: %d", ret);
+        return ret;
+    }
+
+    /* The I/O thread handles CONNACK the moment it arrives */
+    if (k_sem_take(&connack_sem, K_MSEC(MQTT_CONNACK_TIMEOUT_MS)) != 0) {
+        LOG_ERR("MQTT connection timeout");
+        io_call(io_abort, NULL);
+        return -ETIMEDOUT;
+    }
+
+    if (!mqtt_connected) {
+        LOG_ERR("MQTT connection refused");
+        return -ECONNREFUSED;
+    }
+
+    return 0;
+}
+
+/* Keep what just worked for the next boot */
+static void cache_connection(void)
+{
+    struct net_if *iface = net_if_get_default();
+    struct wifi_iface_status status = {0};
+    struct in_addr *addr;
+
+    if (net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS, iface, &status, sizeof(status)) == 0) {
+        struct fast_boot_link link = {
+            .ssid_crc = name_crc(WIFI_SSID),
+            .channel = status.channel,
+        };
+
+        memcpy(link.bssid, status.bssid, sizeof(link.bssid));
+        fast_boot_save(FAST_BOOT_LINK, &link, sizeof(link));
+    }
+
+    addr = net_if_ipv4_get_global_addr(iface, NET_ADDR_PREFERRED);
+    if (addr) {
+        struct fast_boot_lease lease;
+        struct in_addr netmask = net_if_ipv4_get_netmask_by_addr(iface, addr);
+
+        memcpy(lease.addr, addr, sizeof(lease.addr));
+        memcpy(lease.netmask, &netmask, sizeof(lease.netmask));
+        memcpy(lease.gateway, &iface->config.ip.ipv4->gw, sizeof(lease.gateway));
+        fast_boot_save(FAST_BOOT_LEASE, &lease, sizeof(lease));
+    }
+
+    struct fast_boot_broker cached = {
+        .name_crc = name_crc(MQTT_BROKER_ADDR),
+    };
+
+    memcpy(cached.addr, &((struct sockaddr_in *)&broker)->sin_addr, sizeof(cached.addr));
+    fast_boot_save(FAST_BOOT_BROKER, &cached, sizeof(cached));
+}
+
+/* Layer actions for the connection manager, run on its thread */
+static int broker_connect(void)
+{
+    /* Resolved once per address; a broker reconnect skips DNS */
+    if (!broker_resolved) {
+        int ret = broker_init();
+        if (ret < 0) {
+            return ret;
+        }
+        broker_resolved = true;
     }
+
+    int ret = mqtt_client_connect();
+    if (ret < 0) {
+        if (broker_from_cache) {
+            /* Maybe the broker moved: look it up on the next try */
+            broker_from_cache = false;
+            broker_resolved = false;
+            fast_boot_forget(FAST_BOOT_BROKER);
+        }
+        return ret;
+    }
+
+    cache_connection();
+    return 0;
 }
 
+static bool broker_connected(void)
+{
+    return mqtt_connected;
+}
+
+static const struct conn_ops conn_ops = {
+    .link_connect = wifi_connect,
+    .ip_renew = dhcp_restart,
+    .broker_connect = broker_connect,
+    .broker_connected = broker_connected,
+};
+
 /**
  * @brief Initialize MQTT client
  */
@@ -241,6 +956,18 @@ int app_mqtt_client_init(void)
 {
     LOG_INF("Initializing MQTT client...");
 
+    /* Before WiFi, so the first association can use it */
+    fast_boot_init();
+
+#ifdef CONFIG_APP_MQTT_QOS1
+    mqtt_qos1_init(&qos1_window, CONFIG_APP_MQTT_QOS1_ACK_TIMEOUT_MS);
+#endif
+
+    int ret = io_start();
+    if (ret < 0) {
+        return ret;
+    }
+
     /* ✅ Register WiFi events callback */
     net_mgmt_init_event_callback(&wifi_cb, wifi_mgmt_event_handler,
                                 NET_EVENT_WIFI_CONNECT_RESULT |
@@ -248,24 +975,13 @@ int app_mqtt_client_init(void)
     
     /* ✅ Register IPv4 events callback - SEPARATE! */
     net_mgmt_init_event_callback(&ipv4_cb, ipv4_mgmt_event_handler,
-                                NET_EVENT_IPV4_ADDR_ADD);  // ✅ This works!
+                                NET_EVENT_IPV4_ADDR_ADD |
+                                NET_EVENT_IPV4_ADDR_DEL |
+                                NET_EVENT_IPV4_DHCP_BOUND);
 
     net_mgmt_add_event_callback(&wifi_cb);
     net_mgmt_add_event_callback(&ipv4_cb);
 
-    /* Give system time to initialize */
-    k_sleep(K_SECONDS(1));
-
-    /* Connect to WiFi */
-    int ret = wifi_connect();
-    if (ret < 0) {
-        return ret;
-    }
-
-    /* Setup broker address */
-    ret = broker_init();
-    if (ret < 0) return ret;
-
     /* Prepare client */
     mqtt_client_init(&client);
 
@@ -288,80 +1004,496 @@ int app_mqtt_client_init(void)
     /* Publish topic */
     pub_topic_utf8.utf8 = (uint8_t *)MQTT_PUB_TOPIC;
     pub_topic_utf8.size = strlen(MQTT_PUB_TOPIC);
+    cbor_topic_utf8.utf8 = (uint8_t *)MQTT_PUB_TOPIC_CBOR;
+    cbor_topic_utf8.size = strlen(MQTT_PUB_TOPIC_CBOR);
 
-    /* Start reconnection thread */
-    k_thread_create(&reconnect_thread, reconnect_stack,
-                    K_THREAD_STACK_SIZEOF(reconnect_stack),
-                    reconnect_thread_func,
-                    NULL, NULL, NULL,
-                    7, 0, K_NO_WAIT);
-    k_thread_name_set(&reconnect_thread, "mqtt_reconnect");
+    stats_topic_utf8.utf8 = (uint8_t *)MQTT_STATS_TOPIC;
+    stats_topic_utf8.size = strlen(MQTT_STATS_TOPIC);
+    vibration_topic_utf8.utf8 = (uint8_t *)MQTT_VIBRATION_TOPIC;
+    vibration_topic_utf8.size = strlen(MQTT_VIBRATION_TOPIC);
+    batch_topic_utf8.utf8 = (uint8_t *)MQTT_BATCH_TOPIC;
+    batch_topic_utf8.size = strlen(MQTT_BATCH_TOPIC);
+    batch_cbor_topic_utf8.utf8 = (uint8_t *)MQTT_BATCH_TOPIC_CBOR;
+    batch_cbor_topic_utf8.size = strlen(MQTT_BATCH_TOPIC_CBOR);
+    batch_lz_topic_utf8.utf8 = (uint8_t *)MQTT_BATCH_TOPIC_LZ;
+    batch_lz_topic_utf8.size = strlen(MQTT_BATCH_TOPIC_LZ);
+    batch_cbor_lz_topic_utf8.utf8 = (uint8_t *)MQTT_BATCH_TOPIC_CBOR_LZ;
+    batch_cbor_lz_topic_utf8.size = strlen(MQTT_BATCH_TOPIC_CBOR_LZ);
+    batch_ts_topic_utf8.utf8 = (uint8_t *)MQTT_BATCH_TOPIC_TS;
+    batch_ts_topic_utf8.size = strlen(MQTT_BATCH_TOPIC_TS);
 
-    return 0;
+    /* WiFi, DHCP and the broker are brought up, and kept up, in the background */
+    return conn_manager_start(&conn_ops);
 }
 
-int mqtt_client_connect(void)
+int mqtt_client_wait_connected(k_timeout_t timeout)
 {
-    int ret = mqtt_connect(&client);
-    if (ret < 0) {
-        LOG_ERR("mqtt_connect failed: %d", ret);
-        return ret;
+    return conn_manager_wait_up(timeout);
+}
+
+void app_mqtt_disconnect(void)
+{
+    if (mqtt_connected) {
+        io_call(io_disconnect, NULL);
+        mqtt_connected = false;
+        LOG_INF("MQTT disconnected");
     }
+}
+
+/* Publish an encoded payload on the given topic */
+static int publish_payload(const struct mqtt_utf8 *topic, void *payload, int len)
+{
+    struct publish_job job = {
+        .param = {
+            .message.topic.topic = *topic,
+            .message.topic.qos = MQTT_QOS,
+            .message.payload.data = payload,
+            .message.payload.len = len,
+            .dup_flag = 0,
+            .retain_flag = 0,
+        },
+        .tag = publish_tag,
+        .samples = publish_samples,
+    };
 
-    /* Wait for connection */
-    for (int i = 0; i < 50 && !mqtt_connected; i++) {
-        mqtt_input(&client);
-        k_msleep(100);
+    int ret = io_call(io_publish, &job);
+    if (ret == 0) {
+        fast_boot_mark(FAST_BOOT_MARK_PUBLISH);
     }
+    return ret;
+}
+
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+struct stream_job {
+    const struct mqtt_utf8 *topic;
+    void (*write_payload)(struct text_writer *w, const void *arg);
+    const void *arg;
+    uint32_t tag;
+    uint16_t samples;
+};
+
+#ifdef CONFIG_APP_MQTT_QOS1
+/**
+ * @brief Publish a payload produced by a writer function, written into its window slot
+ *
+ * A QoS 1 PUBLISH keeps its payload in the slot until acked anyway, so the
+ * writer fills the slot directly instead of a caller buffer that would be
+ * copied into it. -EMSGSIZE if the payload does not fit a slot.
+ */
+static int io_publish_stream(const void *job_arg)
+{
+    const struct stream_job *job = job_arg;
+    struct text_writer w;
+    uint16_t id;
 
     if (!mqtt_connected) {
-        LOG_ERR("MQTT connection timeout");
-        return -ETIMEDOUT;
+        return -ENOTCONN;
+    }
+
+    int slot = mqtt_qos1_reserve(&qos1_window, &id);
+    if (slot < 0) {
+        return slot;
+    }
+
+    struct qos1_message *msg = &qos1_messages[slot];
+
+    text_writer_init(&w, (char *)msg->payload, sizeof(msg->payload));
+    job->write_payload(&w, job->arg);
+
+    int len = text_finish(&w);
+    if (len < 0) {
+        mqtt_qos1_release(&qos1_window, slot);
+        return -EMSGSIZE;
+    }
+
+    msg->topic = *job->topic;
+    msg->tag = job->tag;
+    msg->samples = job->samples;
+    msg->len = len;
+
+    return qos1_send(slot);
+}
+#else
+/* First byte of a QoS 0 PUBLISH without DUP or RETAIN */
+#define MQTT_PUBLISH_QOS0 0x30
+
+/* Longest MQTT "remaining length" the four-byte varint can carry */
+#define MQTT_MAX_REMAINING_LEN 268435455U
+
+/* Writes staged bytes onto the broker socket */
+static int socket_sink(const char *data, size_t len, void *ctx)
+{
+    ARG_UNUSED(ctx);
+
+    while (len > 0) {
+        ssize_t sent = zsock_send(client.transport.tcp.sock, data, len, 0);
+
+        if (sent < 0) {
+            return -errno;
+        }
+        data += sent;
+        len -= sent;
     }
 
     return 0;
 }
 
-void app_mqtt_disconnect(void)
+/**
+ * @brief Publish a payload produced by a writer function, without buffering it
+ *
+ * The payload is generated twice: once into a zero-size writer to learn its
+ * length for the fixed header, then through a MQTT_STREAM_CHUNK_SIZE buffer
+ * onto the socket, after a QoS 0 PUBLISH header built here. The MQTT library
+ * never sees the packet; running on the I/O thread keeps every other write
+ * off the socket meanwhile. Its keepalive timer just isn't reset by
+ * streamed packets.
+ */
+static int io_publish_stream(const void *job_arg)
 {
-    if (mqtt_connected) {
-        struct mqtt_disconnect_param disc_param = {0};
-        mqtt_disconnect(&client, &disc_param);
+    const struct stream_job *job = job_arg;
+    const struct mqtt_utf8 *topic = job->topic;
+    const void *arg = job->arg;
+    char chunk[MQTT_STREAM_CHUNK_SIZE];
+    struct text_writer w;
+
+    if (!mqtt_connected) {
+        return -ENOTCONN;
+    }
+
+    text_writer_init(&w, chunk, 0);
+    job->write_payload(&w, arg);
+    size_t payload_len = w.len;
+    size_t remaining = sizeof(uint16_t) + topic->size + payload_len;
+
+    if (remaining > MQTT_MAX_REMAINING_LEN) {
+        return -EMSGSIZE;
+    }
+
+    text_writer_init_stream(&w, chunk, sizeof(chunk), socket_sink, NULL);
+
+    /* Fixed header, then the remaining length as a varint */
+    text_put_char(&w, (char)MQTT_PUBLISH_QOS0);
+    do {
+        uint8_t byte = remaining & 0x7F;
+
+        remaining >>= 7;
+        text_put_char(&w, (char)(remaining ? byte | 0x80 : byte));
+    } while (remaining > 0);
+
+    /* Variable header: topic; QoS 0 has no packet identifier */
+    uint8_t topic_len[2];
+
+    sys_put_be16(topic->size, topic_len);
+    text_put_char(&w, (char)topic_len[0]);
+    text_put_char(&w, (char)topic_len[1]);
+    for (uint32_t i = 0; i < topic->size; i++) {
+        text_put_char(&w, (char)topic->utf8[i]);
+    }
+
+    size_t header_len = w.len;
+
+    job->write_payload(&w, arg);
+
+    int ret = text_finish(&w);
+    if (ret < 0) {
+        /* The broker saw part of a packet, so the session is unusable */
+        LOG_ERR("Streamed publish failed: %d", ret);
+        mqtt_abort(&client);
         mqtt_connected = false;
-        LOG_INF("MQTT disconnected");
+        return ret;
+    }
+
+    if ((size_t)ret - header_len != payload_len) {
+        /* Same input must give the same output; anything else is a bug */
+        LOG_ERR("Streamed payload changed length (%u != %u)",
+                (unsigned int)(ret - header_len), (unsigned int)payload_len);
+        mqtt_abort(&client);
+        mqtt_connected = false;
+        return -EIO;
+    }
+
+    return 0;
+}
+#endif /* CONFIG_APP_MQTT_QOS1 */
+
+static int publish_stream(const struct mqtt_utf8 *topic,
+                          void (*write_payload)(struct text_writer *w, const void *arg),
+                          const void *arg)
+{
+    struct stream_job job = {
+        .topic = topic,
+        .write_payload = write_payload,
+        .arg = arg,
+        .tag = publish_tag,
+        .samples = publish_samples,
+    };
+
+    int ret = io_call(io_publish_stream, &job);
+    if (ret == 0) {
+        fast_boot_mark(FAST_BOOT_MARK_PUBLISH);
     }
+    return ret;
+}
+#endif
+
+int mqtt_client_set_format(enum payload_format format)
+{
+    if (format == PAYLOAD_FORMAT_CBOR && !IS_ENABLED(CONFIG_APP_PAYLOAD_CBOR)) {
+        return -ENOTSUP;
+    }
+
+    payload_format = format;
+    return 0;
 }
 
-int mqtt_client_publish_sensor_data(const sensor_data_t *data)
+int mqtt_client_publish_sensor_data(const sensor_sample_t *sample)
 {
-    char payload[JSON_BUFFER_SIZE];
-    int len = json_encode_sensor_data_with_metadata(data,
-                                                    payload,
-                                                    sizeof(payload),
+    sensor_data_t data;
+
+    sensor_sample_to_data(sample, &data);
+
+#ifdef CONFIG_APP_PAYLOAD_CBOR
+    if (payload_format == PAYLOAD_FORMAT_CBOR) {
+        int len = cbor_encode_sensor_data_with_metadata(&data, message_payload,
+                                                        sizeof(message_payload),
+                                                        MQTT_CLIENT_ID);
+        if (len < 0) return len;
+
+        return publish_payload(&cbor_topic_utf8, message_payload, len);
+    }
+#endif
+
+    int len = json_encode_sensor_data_with_metadata(&data, (char *)message_payload,
+                                                    sizeof(message_payload),
                                                     MQTT_CLIENT_ID);
     if (len < 0) return len;
 
-    struct mqtt_publish_param param = {
-        .message.topic = pub_topic_utf8,
-        .message.payload.data = payload,
-        .message.payload.len = len,
-        .message_id = sys_rand32_get() & 0xFFFF,
-        .dup_flag = 0,
-        .retain_flag = 0,
-    };
+    return publish_payload(&pub_topic_utf8, message_payload, len);
+}
 
-    return mqtt_publish(&client, &param);
+#ifdef CONFIG_APP_STATS
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+static void write_stats_json(struct text_writer *w, const void *arg)
+{
+    json_write_stats_summary(w, arg, MQTT_CLIENT_ID);
+}
+#endif
+
+int mqtt_client_publish_stats(const struct stats_summary *summary)
+{
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+    if (summary == NULL) return -EINVAL;
+
+    return publish_stream(&stats_topic_utf8, write_stats_json, summary);
+#else
+    int len = json_encode_stats_summary(summary,
+                                        (char *)message_payload,
+                                        sizeof(message_payload),
+                                        MQTT_CLIENT_ID);
+    if (len < 0) return len;
+
+    return publish_payload(&stats_topic_utf8, message_payload, len);
+#endif
+}
+#endif
+
+#ifdef CONFIG_APP_VIBRATION
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+static void write_spectrum_json(struct text_writer *w, const void *arg)
+{
+    json_write_vibration_spectrum(w, arg, MQTT_CLIENT_ID);
+}
+#endif
+
+int mqtt_client_publish_spectrum(const struct vibration_spectrum *spectrum)
+{
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+    if (spectrum == NULL) return -EINVAL;
+
+    return publish_stream(&vibration_topic_utf8, write_spectrum_json, spectrum);
+#else
+    int len = json_encode_vibration_spectrum(spectrum,
+                                             (char *)message_payload,
+                                             sizeof(message_payload),
+                                             MQTT_CLIENT_ID);
+    if (len < 0) return len;
+
+    return publish_payload(&vibration_topic_utf8, message_payload, len);
+#endif
+}
+#endif
+
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+#ifdef CONFIG_APP_MQTT_STREAM_PUBLISH
+struct batch_ref {
+    const sensor_sample_t *samples;
+    size_t count;
+};
+
+static void write_batch_json(struct text_writer *w, const void *arg)
+{
+    const struct batch_ref *batch = arg;
+
+    json_write_sensor_batch(w, batch->samples, batch->count, MQTT_CLIENT_ID);
+}
+#endif
+
+#ifdef CONFIG_APP_PAYLOAD_LZ
+static int lz_start(struct lz_compressor *lz)
+{
+    return lz_compress_init(lz, lz_work, CONFIG_APP_PAYLOAD_LZ_WINDOW_BITS,
+                            CONFIG_APP_PAYLOAD_LZ_LOOKAHEAD_BITS,
+                            batch_payload, sizeof(batch_payload));
 }
 
+#ifdef CONFIG_APP_PAYLOAD_CBOR
+/* Encoded into the tail of the batch buffer, then compressed into its head */
+static int publish_batch_cbor_lz(const sensor_sample_t *samples, size_t count)
+{
+    const size_t offset = LZ_COMPRESS_IN_PLACE_OFFSET(sizeof(batch_payload));
+    struct lz_compressor lz;
+    int len;
+    int ret;
+
+    len = cbor_encode_sensor_batch(samples, count, &batch_payload[offset],
+                                   sizeof(batch_payload) - offset, MQTT_CLIENT_ID);
+    if (len < 0) return len;
+
+    ret = lz_start(&lz);
+    if (ret < 0) return ret;
+
+    ret = lz_compress_feed(&lz, &batch_payload[offset], len);
+    if (ret < 0) return ret;
+
+    ret = lz_compress_finish(&lz);
+    if (ret < 0) return ret;
+
+    return publish_payload(&batch_cbor_lz_topic_utf8, batch_payload, ret);
+}
+#endif
+
+/* JSON rows go through a small chunk into the compressor, never whole into RAM */
+static int publish_batch_lz(const sensor_sample_t *samples, size_t count)
+{
+    char chunk[MQTT_STREAM_CHUNK_SIZE];
+    struct text_writer w;
+    struct lz_compressor lz;
+    int ret;
+
+    ret = lz_start(&lz);
+    if (ret < 0) return ret;
+
+    text_writer_init_stream(&w, chunk, sizeof(chunk), lz_compress_sink, &lz);
+    json_write_sensor_batch(&w, samples, count, MQTT_CLIENT_ID);
+    ret = text_finish(&w);
+    if (ret < 0) return ret;
+
+    ret = lz_compress_finish(&lz);
+    if (ret < 0) return ret;
+
+    return publish_payload(&batch_lz_topic_utf8, batch_payload, ret);
+}
+#endif
+
+int mqtt_client_publish_batch(const sensor_sample_t *samples, size_t count)
+{
+#ifdef CONFIG_APP_PAYLOAD_TS_COMPRESS
+    struct ts_compressor ts;
+
+    ts_compress_init(&ts, batch_payload, sizeof(batch_payload));
+    for (size_t i = 0; i < count; i++) {
+        int ret = ts_compress_append(&ts, &samples[i]);
+        if (ret < 0) return ret;
+    }
+
+    return publish_payload(&batch_ts_topic_utf8, batch_payload, ts_compress_finish(&ts));
+#else
+#ifdef CONFIG_APP_PAYLOAD_CBOR
+    if (payload_format == PAYLOAD_FORMAT_CBOR) {
+#ifdef CONFIG_APP_PAYLOAD_LZ
+        return publish_batch_cbor_lz(samples, count);
+#else
+        int len = cbor_encode_sensor_batch(samples, count, batch_payload,
+                                           sizeof(batch_payload), MQTT_CLIENT_ID);
+        if (len < 0) return len;
+
+        return publish_payload(&batch_cbor_topic_utf8, batch_payload, len);
+#endif
+    }
+#endif
+
+#if defined(CONFIG_APP_PAYLOAD_LZ)
+    if (samples == NULL || count == 0) return -EINVAL;
+
+    return publish_batch_lz(samples, count);
+#elif defined(CONFIG_APP_MQTT_STREAM_PUBLISH)
+    if (samples == NULL || count == 0) return -EINVAL;
+
+    struct batch_ref batch = {.samples = samples, .count = count};
+
+    return publish_stream(&batch_topic_utf8, write_batch_json, &batch);
+#else
+    int len = json_encode_sensor_batch(samples, count, (char *)batch_payload,
+                                       sizeof(batch_payload), MQTT_CLIENT_ID);
+    if (len < 0) return len;
+
+    return publish_payload(&batch_topic_utf8, batch_payload, len);
+#endif
+#endif
+}
+#endif
+
 bool mqtt_client_is_connected(void)
 {
     return mqtt_connected;
 }
 
-void mqtt_client_process(void)
+#ifdef CONFIG_APP_MQTT_QOS1
+int mqtt_client_get_qos1_stats(struct mqtt_qos1_stats *stats)
 {
-    if (mqtt_connected) {
-        mqtt_input(&client);
-        mqtt_live(&client);
+    return io_call(io_get_qos1_stats, stats);
+}
+
+int mqtt_client_wait_window(k_timeout_t timeout)
+{
+    if (!mqtt_connected) {
+        return -ENOTCONN;
     }
-}
\ No newline at end of file
+
+    return k_sem_take(&window_sem, timeout) == 0 ? 0 : -EAGAIN;
+}
+
+int mqtt_client_set_ack_callback(mqtt_client_ack_cb_t cb)
+{
+    return io_call(io_set_ack_callback, &cb);
+}
+
+int mqtt_client_publish_replay(const sensor_sample_t *samples, size_t count, uint32_t tag)
+{
+    int ret;
+
+    if (samples == NULL || count == 0 || tag == 0) {
+        return -EINVAL;
+    }
+
+    publish_tag = tag;
+#ifdef CONFIG_APP_PAYLOAD_BATCH
+    publish_samples = count;
+    ret = mqtt_client_publish_batch(samples, count);
+    ret = (ret == 0) ? (int)count : ret;
+#else
+    publish_samples = 1;
+    ret = (int)count;
+    for (size_t i = 0; i < count; i++) {
+        int err = mqtt_client_publish_sensor_data(&samples[i]);
+        if (err != 0) {
+            ret = (i > 0) ? (int)i : err;
+            break;
+        }
+    }
+#endif
+    publish_tag = 0;
+    publish_samples = 0;
+    return ret;
+}
+#endif
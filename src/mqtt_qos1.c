@@ -0,0 +1,133 @@
+/**
+ * @file mqtt_qos1.c
+ * @brief In-flight window of QoS 1 PUBLISH packets
+ */
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include "mqtt_qos1.h"
+
+static bool id_in_flight(const struct mqtt_qos1_window *window, uint16_t id)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(window->slots); i++) {
+        if (window->slots[i].id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void mqtt_qos1_init(struct mqtt_qos1_window *window, uint32_t timeout_ms)
+{
+    *window = (struct mqtt_qos1_window){
+        .timeout_ms = timeout_ms,
+    };
+}
+
+int mqtt_qos1_reserve(struct mqtt_qos1_window *window, uint16_t *id)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(window->slots); i++) {
+        struct mqtt_qos1_slot *slot = &window->slots[i];
+
+        if (slot->id != 0) {
+            continue;
+        }
+
+        /* Next identifier after the last one, wrapping past 0 (not allowed) */
+        do {
+            window->last_id = window->last_id == UINT16_MAX ? 1 : window->last_id + 1;
+        } while (id_in_flight(window, window->last_id));
+
+        *slot = (struct mqtt_qos1_slot){.id = window->last_id};
+        *id = slot->id;
+        return (int)i;
+    }
+
+    window->stats.window_full++;
+    return -EAGAIN;
+}
+
+void mqtt_qos1_sent(struct mqtt_qos1_window *window, int slot, uint32_t now_ms)
+{
+    window->slots[slot].sent_ms = now_ms;
+    window->slots[slot].sent = true;
+    window->stats.sent++;
+    window->stats.in_flight++;
+    window->stats.in_flight_peak = MAX(window->stats.in_flight_peak,
+                                       window->stats.in_flight);
+}
+
+void mqtt_qos1_release(struct mqtt_qos1_window *window, int slot)
+{
+    window->slots[slot].id = 0;
+}
+
+int mqtt_qos1_ack(struct mqtt_qos1_window *window, uint16_t id, uint32_t now_ms)
+{
+    struct mqtt_qos1_stats *stats = &window->stats;
+
+    if (id == 0) {
+        return -ENOENT;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(window->slots); i++) {
+        struct mqtt_qos1_slot *slot = &window->slots[i];
+
+        if (slot->id != id || !slot->sent) {
+            continue;
+        }
+
+        if (!slot->dup) {
+            uint32_t rtt = now_ms - slot->sent_ms;
+
+            stats->rtt_last_ms = rtt;
+            stats->rtt_max_ms = MAX(stats->rtt_max_ms, rtt);
+            stats->rtt_avg_ms = stats->acked == 0 ? rtt :
+                                (uint32_t)(((uint64_t)stats->rtt_avg_ms * 7 + rtt) / 8);
+        }
+
+        slot->id = 0;
+        stats->acked++;
+        stats->in_flight--;
+        return (int)i;
+    }
+
+    return -ENOENT;
+}
+
+int mqtt_qos1_next_due(const struct mqtt_qos1_window *window, uint32_t now_ms,
+                       int32_t *wait_ms)
+{
+    int32_t wait = -1;
+
+    for (size_t i = 0; i < ARRAY_SIZE(window->slots); i++) {
+        const struct mqtt_qos1_slot *slot = &window->slots[i];
+
+        if (slot->id == 0 || !slot->sent) {
+            continue;
+        }
+
+        int32_t left = (int32_t)(slot->sent_ms + window->timeout_ms - now_ms);
+
+        if (left <= 0) {
+            return (int)i;
+        }
+        if (wait < 0 || left < wait) {
+            wait = left;
+        }
+    }
+
+    *wait_ms = wait;
+    return -ENOENT;
+}
+
+void mqtt_qos1_resent(struct mqtt_qos1_window *window, int slot, uint32_t now_ms,
+                      bool timeout)
+{
+    struct mqtt_qos1_slot *s = &window->slots[slot];
+
+    s->sent_ms = now_ms;
+    s->dup = true;
+    s->retries = timeout ? s->retries + 1 : 0;
+    window->stats.retransmits++;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file report_filter.c
+ * @brief Send-on-delta filter for sensor uplinks
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdlib.h>
+#include "report_filter.h"
+
+LOG_MODULE_REGISTER(report_filter, LOG_LEVEL_INF);
+
+const struct report_filter_config report_filter_default_config = {
+    .deadband = {
+        [SENSOR_CHANNEL_TEMP] = {
+            .absolute = CONFIG_APP_REPORT_TEMP_DEADBAND_CC,
+            .relative_permille = CONFIG_APP_REPORT_TEMP_DEADBAND_PERMILLE,
+        },
+        [SENSOR_CHANNEL_ACCEL] = {
+            .absolute = CONFIG_APP_REPORT_ACCEL_DEADBAND_MG,
+            .relative_permille = CONFIG_APP_REPORT_ACCEL_DEADBAND_PERMILLE,
+        },
+        [SENSOR_CHANNEL_BATTERY] = {
+            .absolute = CONFIG_APP_REPORT_BATTERY_DEADBAND_MV,
+            .relative_permille = CONFIG_APP_REPORT_BATTERY_DEADBAND_PERMILLE,
+        },
+    },
+    .heartbeat_ms = CONFIG_APP_REPORT_HEARTBEAT_MS,
+};
+
+void report_filter_init(struct report_filter *filter, const char *name,
+                        const struct report_filter_config *config)
+{
+    filter->name = name;
+    filter->config = config;
+    filter->has_reference = false;
+    filter->sent = 0;
+    filter->suppressed = 0;
+    filter->heartbeats = 0;
+}
+
+/**
+ * @brief Check one value against its deadband around the reference
+ */
+static bool exceeds_deadband(const struct report_deadband *db, int32_t value, int32_t reference)
+{
+    uint32_t delta = (uint32_t)abs(value - reference);
+    uint32_t threshold = db->absolute;
+
+    if (db->relative_permille != 0) {
+        uint32_t relative = (uint32_t)abs(reference) * db->relative_permille / 1000U;
+        threshold = MAX(threshold, relative);
+    }
+
+    return delta > threshold;
+}
+
+/**
+ * @brief Check whether any valid channel changed significantly
+ */
+static bool significant_change(const struct report_filter *filter, const sensor_sample_t *sample)
+{
+    const struct report_deadband *db = filter->config->deadband;
+    const sensor_sample_t *ref = &filter->reference;
+
+    /* A channel that just became valid is always news */
+    if ((sample->valid_mask & ~ref->valid_mask) != 0) {
+        return true;
+    }
+
+    /* Every component of every valid field, against its channel's deadband */
+#define CHECK_FIELD(name, type, n, value, mul, div, unit, label, json, keys, dec, cdec, \
+                    cbor, chan)                                                         \
+    if (sample->valid_mask & SENSOR_FIELD(SENSOR_CHANNEL_##chan)) {                     \
+        for (int i = 0; i < (n); i++) {                                                 \
+            if (exceeds_deadband(&db[SENSOR_CHANNEL_##chan],                            \
+                                 SAMPLE_COMPONENTS(sample, name, type)[i],              \
+                                 SAMPLE_COMPONENTS(ref, name, type)[i])) {              \
+                return true;                                                            \
+            }                                                                           \
+        }                                                                               \
+    }
+    SAMPLE_FIELDS(CHECK_FIELD)
+#undef CHECK_FIELD
+
+    return false;
+}
+
+bool report_filter_check(struct report_filter *filter, const sensor_sample_t *sample)
+{
+    if (!filter->has_reference || significant_change(filter, sample)) {
+        return true;
+    }
+
+    uint32_t heartbeat_ms = filter->config->heartbeat_ms;
+    if (heartbeat_ms != 0 &&
+        sample->timestamp_ms - filter->reference.timestamp_ms >= heartbeat_ms) {
+        filter->heartbeats++;
+        return true;
+    }
+
+    filter->suppressed++;
+    LOG_DBG("%s: suppressed (%u so far)", filter->name, filter->suppressed);
+    return false;
+}
+
+void report_filter_commit(struct report_filter *filter, const sensor_sample_t *sample)
+{
+    filter->reference = *sample;
+    filter->has_reference = true;
+    filter->sent++;
+}
+
+void report_filter_reset(struct report_filter *filter)
+{
+    filter->has_reference = false;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file sample_bus.c
+ * @brief Multi-subscriber fan-out of sensor samples
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "sample_bus.h"
+#include "app_config.h"
+
+LOG_MODULE_REGISTER(sample_bus, LOG_LEVEL_INF);
+
+/* Buffer pool shared by all subscribers */
+K_MEM_SLAB_DEFINE_STATIC(sample_pool, sizeof(struct sample_buf),
+                         SAMPLE_BUS_POOL_SIZE, sizeof(void *));
+
+/* Subscribers sorted by priority */
+static sys_slist_t subscribers = SYS_SLIST_STATIC_INIT(&subscribers);
+static K_MUTEX_DEFINE(subscribers_mutex);
+
+static struct sample_bus_stats bus_stats;
+
+/**
+ * @brief Queue a buffer to one subscriber, applying its overflow policy
+ */
+static void deliver(struct sample_bus_subscriber *sub, struct sample_buf *buf)
+{
+    atomic_inc(&buf->refcount);
+
+    if (k_msgq_put(sub->queue, &buf, K_NO_WAIT) == 0) {
+        sub->delivered++;
+        return;
+    }
+
+    if (sub->overflow == SAMPLE_BUS_DROP_OLDEST) {
+        struct sample_buf *oldest;
+
+        if (k_msgq_get(sub->queue, &oldest, K_NO_WAIT) == 0) {
+            sample_bus_release(oldest);
+            sub->dropped++;
+        }
+        if (k_msgq_put(sub->queue, &buf, K_NO_WAIT) == 0) {
+            sub->delivered++;
+            return;
+        }
+    }
+
+    /* Incoming sample dropped for this subscriber */
+    sample_bus_release(buf);
+    sub->dropped++;
+}
+
+int sample_bus_subscribe(struct sample_bus_subscriber *sub)
+{
+    if (sub == NULL || sub->queue == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&subscribers_mutex, K_FOREVER);
+
+    /* Insert after every subscriber of the same or higher priority */
+    sys_snode_t *prev = NULL;
+    sys_snode_t *node;
+
+    SYS_SLIST_FOR_EACH_NODE(&subscribers, node) {
+        struct sample_bus_subscriber *cur =
+            CONTAINER_OF(node, struct sample_bus_subscriber, node);
+
+        if (cur == sub) {
+            k_mutex_unlock(&subscribers_mutex);
+            return -EALREADY;
+        }
+        if (cur->priority > sub->priority) {
+            break;
+        }
+        prev = node;
+    }
+
+    if (prev == NULL) {
+        sys_slist_prepend(&subscribers, &sub->node);
+    } else {
+        sys_slist_insert(&subscribers, prev, &sub->node);
+    }
+
+    k_mutex_unlock(&subscribers_mutex);
+
+    LOG_INF("Subscriber '%s' attached (priority %u, depth %u)",
+            sub->name, sub->priority, sub->queue->max_msgs);
+    return 0;
+}
+
+int sample_bus_unsubscribe(struct sample_bus_subscriber *sub)
+{
+    if (sub == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&subscribers_mutex, K_FOREVER);
+    bool found = sys_slist_find_and_remove(&subscribers, &sub->node);
+    k_mutex_unlock(&subscribers_mutex);
+
+    if (!found) {
+        return -ENOENT;
+    }
+
+    struct sample_buf *buf;
+
+    while (k_msgq_get(sub->queue, &buf, K_NO_WAIT) == 0) {
+        sample_bus_release(buf);
+    }
+
+    LOG_INF("Subscriber '%s' detached", sub->name);
+    return 0;
+}
+
+int sample_bus_publish(const sensor_sample_t *sample)
+{
+    struct sample_buf *buf;
+
+    if (sample == NULL) {
+        return -EINVAL;
+    }
+
+    if (k_mem_slab_alloc(&sample_pool, (void **)&buf, K_NO_WAIT) != 0) {
+        bus_stats.no_buffer++;
+        return -ENOMEM;
+    }
+
+    /* Publisher holds one reference until every queue has been served */
+    atomic_set(&buf->refcount, 1);
+    buf->sample = *sample;
+
+    k_mutex_lock(&subscribers_mutex, K_FOREVER);
+
+    sys_snode_t *node;
+
+    SYS_SLIST_FOR_EACH_NODE(&subscribers, node) {
+        deliver(CONTAINER_OF(node, struct sample_bus_subscriber, node), buf);
+    }
+
+    k_mutex_unlock(&subscribers_mutex);
+
+    bus_stats.published++;
+    sample_bus_release(buf);
+    return 0;
+}
+
+struct sample_buf *sample_bus_receive(struct sample_bus_subscriber *sub,
+                                      k_timeout_t timeout)
+{
+    struct sample_buf *buf;
+
+    if (sub == NULL || k_msgq_get(sub->queue, &buf, timeout) != 0) {
+        return NULL;
+    }
+
+    return buf;
+}
+
+void sample_bus_release(struct sample_buf *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    if (atomic_dec(&buf->refcount) == 1) {
+        k_mem_slab_free(&sample_pool, buf);
+    }
+}
+
+void sample_bus_get_stats(struct sample_bus_stats *stats)
+{
+    if (stats != NULL) {
+        *stats = bus_stats;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file sample_drain.c
+ * @brief Drain the sample history ring into a windowed uplink
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "sample_drain.h"
+
+LOG_MODULE_REGISTER(sample_drain, LOG_LEVEL_INF);
+
+void sample_drain_init(struct sample_drain *drain, const struct sample_drain_ops *ops,
+                       void *ctx, uint32_t wait_budget_ms)
+{
+    sensor_manager_cursor_init(&drain->cursor);
+    drain->ops = ops;
+    drain->ctx = ctx;
+    drain->wait_budget_ms = wait_budget_ms;
+    drain->stats = (struct sample_drain_stats){0};
+}
+
+/**
+ * @brief Send one sample, waiting for window slots until the deadline
+ * @return send()'s result; -EAGAIN once the deadline has passed
+ */
+static int send_windowed(struct sample_drain *drain, const sensor_sample_t *sample,
+                         int64_t deadline)
+{
+    int ret = drain->ops->send(sample, drain->ctx);
+
+    while (ret == -EAGAIN && drain->ops->wait != NULL) {
+        int64_t left = deadline - k_uptime_get();
+
+        if (left <= 0) {
+            break;
+        }
+
+        drain->stats.waits++;
+        if (drain->ops->wait(K_MSEC(left), drain->ctx) != 0) {
+            break;
+        }
+        ret = drain->ops->send(sample, drain->ctx);
+    }
+
+    return ret;
+}
+
+int sample_drain_run(struct sample_drain *drain, bool connected)
+{
+    const struct sample_drain_ops *ops = drain->ops;
+    int64_t deadline = k_uptime_get() + drain->wait_budget_ms;
+    sensor_cursor_t next = drain->cursor;
+    sensor_sample_t sample;
+    bool stalled = !connected;
+    int consumed = 0;
+
+    while (sensor_manager_read_since(&next, &sample, 1) == 1) {
+        int ret = -ENOTCONN;
+
+        if (!stalled) {
+            ret = send_windowed(drain, &sample, deadline);
+            if (ret == -EAGAIN) {
+                drain->stats.stalls++;
+            } else if (ret < 0) {
+                LOG_WRN("Uplink failed: %d", ret);
+            }
+            /* Whatever stopped this send stops the rest of the pass */
+            stalled = (ret != 0);
+        }
+
+        if (ret == 0) {
+            drain->stats.sent++;
+        } else if (ops->store == NULL && (ret == -EAGAIN || ret == -ENOTCONN)) {
+            /* Nowhere else to keep it: leave it and the rest in the ring */
+            break;
+        } else if (ops->store != NULL && ops->store(&sample, drain->ctx) == 0) {
+            drain->stats.stored++;
+        } else {
+            drain->stats.lost++;
+        }
+
+        drain->cursor = next;
+        consumed++;
+    }
+
+    return consumed;
+}
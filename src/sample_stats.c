@@ -0,0 +1,255 @@
+/**
+ * @file sample_stats.c
+ * @brief Streaming windowed statistics over sensor samples
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <math.h>
+#include "sample_stats.h"
+#include "sample_bus.h"
+#include "app_config.h"
+
+LOG_MODULE_REGISTER(sample_stats, LOG_LEVEL_INF);
+
+BUILD_ASSERT(CONFIG_APP_STATS_WINDOW2_MS % CONFIG_APP_STATS_WINDOW1_MS == 0 &&
+             CONFIG_APP_STATS_WINDOW3_MS % CONFIG_APP_STATS_WINDOW2_MS == 0,
+             "Each statistics window must be a multiple of the previous one");
+
+/* Integer accumulator of one channel, exact and mergeable */
+struct channel_acc {
+    uint32_t count;
+    int16_t min;
+    int16_t max;
+    int64_t sum;
+    uint64_t sum_sq;
+};
+
+/* One window length and its running accumulators */
+struct stats_window {
+    uint32_t length_ms;
+    uint32_t start_ms;
+    struct channel_acc acc[STATS_CHANNEL_COUNT];
+};
+
+static struct stats_window windows[STATS_WINDOW_COUNT] = {
+    {.length_ms = CONFIG_APP_STATS_WINDOW1_MS},
+    {.length_ms = CONFIG_APP_STATS_WINDOW2_MS},
+    {.length_ms = CONFIG_APP_STATS_WINDOW3_MS},
+};
+static bool windows_started;
+
+/* Latest closed summary per window, and the uplink queue */
+static struct stats_summary latest[STATS_WINDOW_COUNT];
+static bool latest_valid[STATS_WINDOW_COUNT];
+static K_MUTEX_DEFINE(latest_mutex);
+K_MSGQ_DEFINE(stats_uplink_queue, sizeof(struct stats_summary),
+              STATS_UPLINK_QUEUE_SIZE, 4);
+
+/* Bus subscription and thread */
+SAMPLE_BUS_SUBSCRIBER_DEFINE(stats_sub, STATS_SUBSCRIBER_DEPTH, 1, SAMPLE_BUS_DROP_OLDEST);
+static struct k_thread stats_thread_data;
+static K_THREAD_STACK_DEFINE(stats_thread_stack, STATS_THREAD_STACK_SIZE);
+
+/* Fixed-point unit of each channel, converted at the edge */
+static const float channel_scale[STATS_CHANNEL_COUNT] = {
+    [STATS_CHANNEL_TEMP] = 0.01f,                 /* centi-°C -> °C */
+    [STATS_CHANNEL_ACCEL_X] = SENSOR_MS2_PER_MG,  /* mg -> m/s² */
+    [STATS_CHANNEL_ACCEL_Y] = SENSOR_MS2_PER_MG,
+    [STATS_CHANNEL_ACCEL_Z] = SENSOR_MS2_PER_MG,
+};
+
+static void acc_reset(struct channel_acc *acc)
+{
+    acc->count = 0;
+    acc->min = INT16_MAX;
+    acc->max = INT16_MIN;
+    acc->sum = 0;
+    acc->sum_sq = 0;
+}
+
+static inline void acc_add(struct channel_acc *acc, int16_t value)
+{
+    acc->count++;
+    acc->min = MIN(acc->min, value);
+    acc->max = MAX(acc->max, value);
+    acc->sum += value;
+    acc->sum_sq += (uint64_t)((int32_t)value * value);
+}
+
+static void acc_merge(struct channel_acc *dst, const struct channel_acc *src)
+{
+    if (src->count == 0) {
+        return;
+    }
+
+    dst->count += src->count;
+    dst->min = MIN(dst->min, src->min);
+    dst->max = MAX(dst->max, src->max);
+    dst->sum += src->sum;
+    dst->sum_sq += src->sum_sq;
+}
+
+/**
+ * @brief Turn an integer accumulator into a float summary
+ */
+static void acc_summarize(const struct channel_acc *acc, float scale,
+                          struct stats_channel_summary *out)
+{
+    out->count = acc->count;
+
+    if (acc->count == 0) {
+        *out = (struct stats_channel_summary){0};
+        return;
+    }
+
+    float n = (float)acc->count;
+    /* n²·variance computed exactly in integers, then scaled */
+    int64_t var_num = (int64_t)acc->count * (int64_t)acc->sum_sq - acc->sum * acc->sum;
+
+    out->min = acc->min * scale;
+    out->max = acc->max * scale;
+    out->mean = ((float)acc->sum / n) * scale;
+    out->variance = ((float)var_num / (n * n)) * scale * scale;
+    out->rms = sqrtf((float)acc->sum_sq / n) * scale;
+    out->peak_to_peak = (acc->max - acc->min) * scale;
+}
+
+/**
+ * @brief Publish the closed window, merge it upward and restart it at @p now_ms
+ */
+static void window_close(int w, uint32_t now_ms)
+{
+    struct stats_window *win = &windows[w];
+    struct stats_summary summary = {
+        .window_ms = win->length_ms,
+        .start_ms = win->start_ms,
+    };
+    bool has_data = false;
+
+    for (int ch = 0; ch < STATS_CHANNEL_COUNT; ch++) {
+        acc_summarize(&win->acc[ch], channel_scale[ch], &summary.ch[ch]);
+        has_data |= (win->acc[ch].count != 0);
+
+        if (w + 1 < STATS_WINDOW_COUNT) {
+            acc_merge(&windows[w + 1].acc[ch], &win->acc[ch]);
+        }
+        acc_reset(&win->acc[ch]);
+    }
+
+    win->start_ms = now_ms - (now_ms % win->length_ms);
+
+    if (has_data) {
+        k_mutex_lock(&latest_mutex, K_FOREVER);
+        latest[w] = summary;
+        latest_valid[w] = true;
+        k_mutex_unlock(&latest_mutex);
+
+        if (w == CONFIG_APP_STATS_UPLINK_WINDOW &&
+            k_msgq_put(&stats_uplink_queue, &summary, K_NO_WAIT) != 0) {
+            LOG_WRN("Statistics uplink queue full, summary dropped");
+        }
+    }
+
+    /* A longer window can only end where a shorter one ends */
+    if (w + 1 < STATS_WINDOW_COUNT &&
+        now_ms - windows[w + 1].start_ms >= windows[w + 1].length_ms) {
+        window_close(w + 1, now_ms);
+    }
+}
+
+void sample_stats_add(const sensor_sample_t *sample)
+{
+    uint32_t now = sample->timestamp_ms;
+
+    if (!windows_started) {
+        for (int w = 0; w < STATS_WINDOW_COUNT; w++) {
+            for (int ch = 0; ch < STATS_CHANNEL_COUNT; ch++) {
+                acc_reset(&windows[w].acc[ch]);
+            }
+            windows[w].start_ms = now - (now % windows[w].length_ms);
+        }
+        windows_started = true;
+    }
+
+    if (now - windows[0].start_ms >= windows[0].length_ms) {
+        window_close(0, now);
+    }
+
+    struct channel_acc *acc = windows[0].acc;
+
+    if (sample->fresh_mask & SENSOR_FIELD(SENSOR_CHANNEL_TEMP)) {
+        acc_add(&acc[STATS_CHANNEL_TEMP], sample->temperature_cc);
+    }
+    if (sample->fresh_mask & SENSOR_FIELD(SENSOR_CHANNEL_ACCEL)) {
+        acc_add(&acc[STATS_CHANNEL_ACCEL_X], sample->accel_mg[0]);
+        acc_add(&acc[STATS_CHANNEL_ACCEL_Y], sample->accel_mg[1]);
+        acc_add(&acc[STATS_CHANNEL_ACCEL_Z], sample->accel_mg[2]);
+    }
+}
+
+/**
+ * @brief Statistics thread: drains the sample bus into the engine
+ */
+static void stats_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    LOG_INF("Statistics thread started");
+
+    while (1) {
+        struct sample_buf *buf = sample_bus_receive(&stats_sub, K_FOREVER);
+        if (buf == NULL) {
+            continue;
+        }
+
+        sample_stats_add(&buf->sample);
+        sample_bus_release(buf);
+    }
+}
+
+int sample_stats_start(void)
+{
+    int ret = sample_bus_subscribe(&stats_sub);
+    if (ret != 0) {
+        LOG_ERR("Failed to subscribe to sample bus: %d", ret);
+        return ret;
+    }
+
+    k_tid_t tid = k_thread_create(&stats_thread_data, stats_thread_stack,
+                                  K_THREAD_STACK_SIZEOF(stats_thread_stack),
+                                  stats_thread, NULL, NULL, NULL,
+                                  STATS_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "sample_stats");
+
+    LOG_INF("Statistics windows: %u/%u/%u ms", windows[0].length_ms,
+            windows[1].length_ms, windows[2].length_ms);
+    return 0;
+}
+
+int sample_stats_get_latest(int window, struct stats_summary *summary)
+{
+    if (window < 0 || window >= STATS_WINDOW_COUNT || summary == NULL) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&latest_mutex, K_FOREVER);
+    bool valid = latest_valid[window];
+    if (valid) {
+        *summary = latest[window];
+    }
+    k_mutex_unlock(&latest_mutex);
+
+    return valid ? 0 : -ENODATA;
+}
+
+int sample_stats_get_summary(struct stats_summary *summary, k_timeout_t timeout)
+{
+    if (summary == NULL) {
+        return -EINVAL;
+    }
+
+    return (k_msgq_get(&stats_uplink_queue, summary, timeout) == 0) ? 0 : -EAGAIN;
+}
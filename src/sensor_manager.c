@@ -5,23 +5,70 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/barrier.h>
 #include "sensor_manager.h"
+#include "sensor_manager_internal.h"
+#include "sensor_drivers.h"
+#include "sample_bus.h"
 #include "app_config.h"
 
+#ifdef CONFIG_APP_VIBRATION
+#include "vibration.h"
+#endif
+
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+#include "sensor_pipeline.h"
+#endif
+
 LOG_MODULE_REGISTER(sensor_mgr, LOG_LEVEL_INF);
 
-/* External sensor functions */
-extern int i2c_temp_sensor_init(void);
-extern int i2c_temp_sensor_read(float *temp_c);
-extern int spi_accel_sensor_init(void);
-extern int spi_accel_sensor_read(float *x, float *y, float *z);
-extern int adc_battery_init(void);
-extern int adc_battery_read(float *voltage_v);
+BUILD_ASSERT((SENSOR_HISTORY_SIZE & (SENSOR_HISTORY_SIZE - 1)) == 0,
+             "SENSOR_HISTORY_SIZE must be a power of two");
+
+BUILD_ASSERT(sizeof(sensor_sample_t) == sizeof(uint32_t) + SAMPLE_VALUE_BYTES + 2,
+             "sensor_sample_t must stay packed");
+
+/*
+ * History ring slot. The sequence word is 2n+1 while sample n is being
+ * written and 2n+2 once it is published, so readers can detect both a
+ * torn copy and a slot that has already been reused (seqlock).
+ */
+struct sample_slot {
+    atomic_t seq;
+    sensor_sample_t sample;
+};
 
 /* Internal state */
-static sensor_data_t latest_data = {0};
-static K_MUTEX_DEFINE(data_mutex);
-static sensor_data_callback_t data_callback = NULL;
+static struct sample_slot history[SENSOR_HISTORY_SIZE] __aligned(SENSOR_CACHE_LINE_SIZE);
+static atomic_t published = ATOMIC_INIT(0);   /* Samples published so far */
+
+/* Per-channel sampling schedule, deadlines in absolute uptime ms */
+struct sensor_schedule {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t phase_ms;
+    int64_t next_ms;
+};
+
+static struct sensor_schedule schedule[SENSOR_CHANNEL_COUNT] = {
+    [SENSOR_CHANNEL_TEMP] = {
+        .name = "temperature",
+        .period_ms = CONFIG_APP_SENSOR_TEMP_PERIOD_MS,
+        .phase_ms = CONFIG_APP_SENSOR_TEMP_PHASE_MS,
+    },
+    [SENSOR_CHANNEL_ACCEL] = {
+        .name = "accelerometer",
+        .period_ms = CONFIG_APP_SENSOR_ACCEL_PERIOD_MS,
+        .phase_ms = CONFIG_APP_SENSOR_ACCEL_PHASE_MS,
+    },
+    [SENSOR_CHANNEL_BATTERY] = {
+        .name = "battery",
+        .period_ms = CONFIG_APP_SENSOR_BATTERY_PERIOD_MS,
+        .phase_ms = CONFIG_APP_SENSOR_BATTERY_PHASE_MS,
+    },
+};
+static struct k_spinlock schedule_lock;
+static K_SEM_DEFINE(schedule_changed, 0, 1);
 
 /* Thread control */
 static struct k_thread sensor_thread_data;
@@ -29,8 +76,335 @@ static K_THREAD_STACK_DEFINE(sensor_thread_stack, SENSOR_THREAD_STACK_SIZE);
 static k_tid_t sensor_thread_tid = NULL;
 static bool thread_running = false;
 
+/**
+ * @brief Publish a sample into the history ring (sensor thread only)
+ */
+SENSOR_MGR_INTERNAL void history_publish(const sensor_sample_t *sample)
+{
+    uint32_t n = (uint32_t)atomic_get(&published);
+    struct sample_slot *slot = &history[n & (SENSOR_HISTORY_SIZE - 1)];
+
+    atomic_set(&slot->seq, (atomic_val_t)(2U * n + 1U));
+    barrier_dmem_fence_full();
+    memcpy(&slot->sample, sample, sizeof(sensor_sample_t));
+    barrier_dmem_fence_full();
+    atomic_set(&slot->seq, (atomic_val_t)(2U * n + 2U));
+    atomic_set(&published, (atomic_val_t)(n + 1U));
+}
+
+/**
+ * @brief Copy sample n out of the history ring
+ * @return 0 on success, -EAGAIN if the slot was reused before or during the copy
+ */
+static int history_read(uint32_t n, sensor_sample_t *sample)
+{
+    const struct sample_slot *slot = &history[n & (SENSOR_HISTORY_SIZE - 1)];
+    const uint32_t expected = 2U * n + 2U;
+
+    if ((uint32_t)atomic_get(&slot->seq) != expected) {
+        return -EAGAIN;
+    }
+    barrier_dmem_fence_full();
+    memcpy(sample, &slot->sample, sizeof(sensor_sample_t));
+    barrier_dmem_fence_full();
+
+    return ((uint32_t)atomic_get(&slot->seq) == expected) ? 0 : -EAGAIN;
+}
+
+/*
+ * Raw results of the overlapped bus reads of one sampling cycle. Bus
+ * completions only store integers here; conversion to physical units
+ * happens in the sensor thread once the last transfer is done.
+ */
+static struct {
+    int16_t temp_raw;
+    struct accel_raw_frame accel_raw;
+    uint16_t battery_mv;
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+    int16_t accel_mg[3];        /* Newest pipeline output this cycle */
+    bool accel_emitted;
+#endif
+    int result[SENSOR_CHANNEL_COUNT];
+} cycle;
+
+static atomic_t reads_pending;
+static atomic_t cycle_gen;
+static K_SEM_DEFINE(reads_done, 0, 1);
+
+/* Completion tag: cycle generation in the upper bits, channel in the low byte */
+#define CYCLE_TAG(gen, ch)   ((void *)(uintptr_t)((((gen) & 0xFFFFFFU) << 8) | (ch)))
+#define CYCLE_TAG_GEN(tag)   ((uint32_t)((uintptr_t)(tag) >> 8))
+#define CYCLE_TAG_CH(tag)    ((uint32_t)((uintptr_t)(tag) & 0xFFU))
+
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+/**
+ * @brief Run one accelerometer frame through the per-axis chains
+ * @return true if the (shared) decimator emitted a value into @p mg
+ */
+static bool accel_pipeline_process(const struct accel_raw_frame *frame, int16_t mg[3])
+{
+    bool emitted = sensor_pipeline_process(PIPELINE_CHANNEL_ACCEL_X, frame->x, &mg[0]);
+    
+    sensor_pipeline_process(PIPELINE_CHANNEL_ACCEL_Y, frame->y, &mg[1]);
+    sensor_pipeline_process(PIPELINE_CHANNEL_ACCEL_Z, frame->z, &mg[2]);
+    return emitted;
+}
+#endif
+
+#ifdef CONFIG_APP_ACCEL_STREAM
+/* Frames drained from the accelerometer FIFO on each accel period */
+static struct accel_raw_frame accel_batch[ACCEL_FIFO_DEPTH];
+
+/**
+ * @brief Drain the accelerometer FIFO, the cycle keeps the newest frame
+ * @return 0 on success, -ENODATA if the FIFO was empty, negative errno on failure
+ */
+static int read_accel_stream(void)
+{
+    int count = spi_accel_sensor_fifo_read(accel_batch, ARRAY_SIZE(accel_batch));
+    if (count <= 0) {
+        return (count == 0) ? -ENODATA : count;
+    }
+    
+    cycle.accel_raw = accel_batch[count - 1];
+    
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+    /* Every frame goes through the filters, not just the newest */
+    cycle.accel_emitted = false;
+    for (int i = 0; i < count; i++) {
+        cycle.accel_emitted |= accel_pipeline_process(&accel_batch[i], cycle.accel_mg);
+    }
+#endif
+    
+#ifdef CONFIG_APP_VIBRATION
+    vibration_feed(accel_batch, count);
+#endif
+    return 0;
+}
+#endif
+
+/**
+ * @brief Bus completion callback, may run in interrupt context
+ */
+static void read_complete(int result, void *user_data)
+{
+    /* Ignore stragglers from a cycle that already timed out */
+    if (CYCLE_TAG_GEN(user_data) != ((uint32_t)atomic_get(&cycle_gen) & 0xFFFFFFU)) {
+        return;
+    }
+    
+    cycle.result[CYCLE_TAG_CH(user_data)] = result;
+    
+    if (atomic_dec(&reads_pending) == 1) {
+        k_sem_give(&reads_done);
+    }
+}
+
+/**
+ * @brief Start the bus transfer for one channel
+ */
+static int submit_read(sensor_channel_t channel, void *tag)
+{
+    switch (channel) {
+    case SENSOR_CHANNEL_TEMP:
+        return i2c_temp_sensor_read_async(&cycle.temp_raw, read_complete, tag);
+    case SENSOR_CHANNEL_ACCEL:
+        return spi_accel_sensor_read_async(&cycle.accel_raw, read_complete, tag);
+    case SENSOR_CHANNEL_BATTERY:
+        return adc_battery_read_async(&cycle.battery_mv, read_complete, tag);
+    default:
+        return -EINVAL;
+    }
+}
+
+/**
+ * @brief Fold one channel's result into the record and update its masks
+ */
+static void apply_result(sensor_channel_t channel, sensor_sample_t *sample)
+{
+    int ret = cycle.result[channel];
+    
+    if (ret == -ENODATA) {
+        /* Nothing new in the accelerometer FIFO yet, keep previous value */
+        return;
+    }
+    
+    if (ret != 0) {
+        LOG_WRN("Failed to read %s: %d", schedule[channel].name,
+                ret == -EINPROGRESS ? -ETIMEDOUT : ret);
+        sample->valid_mask &= ~SENSOR_FIELD(channel);
+        return;
+    }
+    
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+    /* A read absorbed by the decimator leaves the channel untouched */
+    switch (channel) {
+    case SENSOR_CHANNEL_TEMP:
+        if (!sensor_pipeline_process(PIPELINE_CHANNEL_TEMP, cycle.temp_raw,
+                                     &sample->temperature_cc)) {
+            return;
+        }
+        break;
+    case SENSOR_CHANNEL_ACCEL:
+        if (!IS_ENABLED(CONFIG_APP_ACCEL_STREAM)) {
+            cycle.accel_emitted = accel_pipeline_process(&cycle.accel_raw, cycle.accel_mg);
+        }
+        if (!cycle.accel_emitted) {
+            return;
+        }
+        memcpy(sample->accel_mg, cycle.accel_mg, sizeof(sample->accel_mg));
+        break;
+    case SENSOR_CHANNEL_BATTERY: {
+        int16_t mv;
+        
+        if (!sensor_pipeline_process(PIPELINE_CHANNEL_BATTERY, cycle.battery_mv, &mv)) {
+            return;
+        }
+        sample->battery_mv = (uint16_t)mv;
+        break;
+    }
+    default:
+        return;
+    }
+#else
+    switch (channel) {
+    case SENSOR_CHANNEL_TEMP:
+        sample->temperature_cc = i2c_temp_sensor_raw_to_cc(cycle.temp_raw);
+        break;
+    case SENSOR_CHANNEL_ACCEL:
+        sample->accel_mg[0] = spi_accel_sensor_raw_to_mg(cycle.accel_raw.x);
+        sample->accel_mg[1] = spi_accel_sensor_raw_to_mg(cycle.accel_raw.y);
+        sample->accel_mg[2] = spi_accel_sensor_raw_to_mg(cycle.accel_raw.z);
+        break;
+    case SENSOR_CHANNEL_BATTERY:
+        sample->battery_mv = cycle.battery_mv;
+        break;
+    default:
+        return;
+    }
+#endif
+    
+    sample->valid_mask |= SENSOR_FIELD(channel);
+    sample->fresh_mask |= SENSOR_FIELD(channel);
+}
+
+/**
+ * @brief Sample the due channels with all bus transfers in flight together
+ *
+ * I²C, SPI and ADC transfers are submitted back to back and the thread
+ * sleeps until the last one completes, so the cycle costs the slowest
+ * bus instead of the sum of all three.
+ */
+SENSOR_MGR_INTERNAL void sample_channels(uint8_t due, sensor_sample_t *sample)
+{
+    uint32_t gen = ((uint32_t)atomic_inc(&cycle_gen) + 1U) & 0xFFFFFFU;
+    uint8_t async_due = due;
+    uint32_t start = k_cycle_get_32();
+    
+#ifdef CONFIG_APP_ACCEL_STREAM
+    /* The FIFO burst is drained below while the other buses are busy */
+    async_due &= ~SENSOR_FIELD(SENSOR_CHANNEL_ACCEL);
+#endif
+    
+    k_sem_reset(&reads_done);
+    
+    /* Hold one count so early completions cannot end the cycle mid-submit */
+    atomic_set(&reads_pending, 1);
+    
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        if (!(async_due & SENSOR_FIELD(ch))) {
+            continue;
+        }
+        
+        cycle.result[ch] = -EINPROGRESS;
+        atomic_inc(&reads_pending);
+        
+        int ret = submit_read(ch, CYCLE_TAG(gen, ch));
+        if (ret < 0) {
+            cycle.result[ch] = ret;
+            atomic_dec(&reads_pending);
+        }
+    }
+    
+#ifdef CONFIG_APP_ACCEL_STREAM
+    if (due & SENSOR_FIELD(SENSOR_CHANNEL_ACCEL)) {
+        cycle.result[SENSOR_CHANNEL_ACCEL] = read_accel_stream();
+    }
+#endif
+    
+    if (atomic_dec(&reads_pending) != 1 &&
+        k_sem_take(&reads_done, K_MSEC(SENSOR_READ_TIMEOUT_MS)) != 0) {
+        /* Invalidate the late completions of this cycle */
+        atomic_inc(&cycle_gen);
+    }
+    
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        if (due & SENSOR_FIELD(ch)) {
+            apply_result(ch, sample);
+        }
+    }
+    
+    LOG_DBG("Sampling cycle 0x%02x took %u us", due,
+            k_cyc_to_us_floor32(k_cycle_get_32() - start));
+}
+
+/**
+ * @brief Earliest pending deadline over all enabled channels
+ * @return Absolute uptime in ms, or -1 if every channel is disabled
+ */
+static int64_t next_deadline(void)
+{
+    int64_t earliest = -1;
+    k_spinlock_key_t key = k_spin_lock(&schedule_lock);
+    
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        if (schedule[ch].period_ms == 0) {
+            continue;
+        }
+        if (earliest < 0 || schedule[ch].next_ms < earliest) {
+            earliest = schedule[ch].next_ms;
+        }
+    }
+    
+    k_spin_unlock(&schedule_lock, key);
+    return earliest;
+}
+
+/**
+ * @brief Collect the channels due at @p now and advance their deadlines
+ * @return Bitmask of due channels
+ */
+static uint8_t take_due_channels(int64_t now)
+{
+    uint8_t due = 0;
+    k_spinlock_key_t key = k_spin_lock(&schedule_lock);
+    
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        struct sensor_schedule *sched = &schedule[ch];
+        
+        if (sched->period_ms == 0 || sched->next_ms > now) {
+            continue;
+        }
+        
+        due |= SENSOR_FIELD(ch);
+        
+        /* Stay on the period grid; skip slots missed while overloaded */
+        do {
+            sched->next_ms += sched->period_ms;
+        } while (sched->next_ms <= now);
+    }
+    
+    k_spin_unlock(&schedule_lock, key);
+    return due;
+}
+
 /**
  * @brief Sensor sampling thread
+ *
+ * Sleeps until the earliest channel deadline (or a schedule change),
+ * then samples only the channels that are due. Channels not sampled
+ * keep their previous value and are left out of fresh_mask. Samples
+ * stay in fixed point; floats are only produced for callers.
  */
 static void sensor_thread(void *arg1, void *arg2, void *arg3)
 {
@@ -40,48 +414,52 @@ static void sensor_thread(void *arg1, void *arg2, void *arg3)
     
     LOG_INF("Sensor thread started");
     
+    sensor_sample_t sample = {0};
+    int64_t start = k_uptime_get();
+    
+    k_spinlock_key_t key = k_spin_lock(&schedule_lock);
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        schedule[ch].next_ms = start + schedule[ch].phase_ms;
+    }
+    k_spin_unlock(&schedule_lock, key);
+    
     while (thread_running) {
-        sensor_data_t data = {0};
-        data.timestamp_ms = k_uptime_get_32();
-        
-        /* Read temperature sensor */
-        int ret = i2c_temp_sensor_read(&data.temperature_c);
-        if (ret != 0) {
-            LOG_WRN("Failed to read temperature: %d", ret);
-        }
+        int64_t deadline = next_deadline();
+        int64_t now = k_uptime_get();
         
-        /* Read accelerometer */
-        ret = spi_accel_sensor_read(&data.accel_x, &data.accel_y, &data.accel_z);
-        if (ret != 0) {
-            LOG_WRN("Failed to read accelerometer: %d", ret);
+        if (deadline < 0 || deadline > now) {
+            /* Single timeout per cycle; woken early on schedule change */
+            k_sem_take(&schedule_changed,
+                       deadline < 0 ? K_FOREVER : K_TIMEOUT_ABS_MS(deadline));
+            continue;
         }
         
-        /* Read battery voltage */
-        ret = adc_battery_read(&data.battery_voltage);
-        if (ret != 0) {
-            LOG_WRN("Failed to read battery: %d", ret);
-        }
+        uint8_t due = take_due_channels(now);
         
-        /* Mark data as valid */
-        data.valid = true;
+        sample.timestamp_ms = (uint32_t)now;
+        sample.fresh_mask = 0;
         
-        /* Update latest data with mutex protection */
-        k_mutex_lock(&data_mutex, K_FOREVER);
-        memcpy(&latest_data, &data, sizeof(sensor_data_t));
-        k_mutex_unlock(&data_mutex);
+        uint8_t valid_before = sample.valid_mask;
         
-        LOG_INF("Sensor data: T=%.1f°C, Accel=(%.2f,%.2f,%.2f)m/s², Batt=%.2fV",
-                (double)data.temperature_c,
-                (double)data.accel_x, (double)data.accel_y, (double)data.accel_z,
-                (double)data.battery_voltage);
+        sample_channels(due, &sample);
         
-        /* Notify callback if registered */
-        if (data_callback != NULL) {
-            data_callback(&data);
+        /* Every read was absorbed by a decimator: nothing to publish */
+        if (sample.fresh_mask == 0 && sample.valid_mask == valid_before) {
+            continue;
         }
         
-        /* Sleep until next sample */
-        k_msleep(SENSOR_SAMPLE_INTERVAL_MS);
+        /* Publish to the history ring, readers never block us */
+        history_publish(&sample);
+        
+        LOG_DBG("Sensor data [0x%02x]: T=%d cC, Accel=(%d,%d,%d) mg, Batt=%u mV",
+                sample.fresh_mask, sample.temperature_cc,
+                sample.accel_mg[0], sample.accel_mg[1], sample.accel_mg[2],
+                sample.battery_mv);
+        
+        /* Fan out to subscribers; a full queue never blocks sampling */
+        if (sample_bus_publish(&sample) != 0) {
+            LOG_DBG("Sample bus pool exhausted");
+        }
     }
     
     LOG_INF("Sensor thread stopped");
@@ -105,6 +483,14 @@ int sensor_manager_init(void)
         /* Continue anyway for stub mode */
     }
     
+#ifdef CONFIG_APP_ACCEL_STREAM
+    ret = spi_accel_sensor_stream_start(CONFIG_APP_ACCEL_STREAM_ODR_HZ,
+                                        CONFIG_APP_ACCEL_FIFO_WATERMARK);
+    if (ret != 0) {
+        LOG_ERR("Failed to start accelerometer stream: %d", ret);
+    }
+#endif
+    
     /* Initialize ADC battery monitor */
     ret = adc_battery_init();
     if (ret != 0) {
@@ -112,6 +498,14 @@ int sensor_manager_init(void)
         /* Continue anyway for stub mode */
     }
     
+#ifdef CONFIG_APP_SENSOR_PIPELINE
+    ret = sensor_pipeline_init();
+    if (ret != 0) {
+        LOG_ERR("Failed to initialize sensor pipeline: %d", ret);
+        return ret;
+    }
+#endif
+    
     LOG_INF("Sensor manager initialized successfully");
     return 0;
 }
@@ -149,6 +543,7 @@ void sensor_manager_stop(void)
     }
     
     thread_running = false;
+    k_sem_give(&schedule_changed);
     
     if (sensor_thread_tid != NULL) {
         k_thread_join(sensor_thread_tid, K_FOREVER);
@@ -164,15 +559,101 @@ int sensor_manager_get_data(sensor_data_t *data)
         return -EINVAL;
     }
     
-    k_mutex_lock(&data_mutex, K_FOREVER);
-    memcpy(data, &latest_data, sizeof(sensor_data_t));
-    k_mutex_unlock(&data_mutex);
+    sensor_sample_t sample;
+    int ret = sensor_manager_get_sample(&sample);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    sensor_sample_to_data(&sample, data);
+    return data->valid ? 0 : -ENODATA;
+}
+
+int sensor_manager_get_sample(sensor_sample_t *sample)
+{
+    if (sample == NULL) {
+        return -EINVAL;
+    }
+    
+    /* Only fails if the producer laps the whole ring during the copy */
+    for (;;) {
+        uint32_t head = (uint32_t)atomic_get(&published);
+        if (head == 0) {
+            return -ENODATA;
+        }
+        if (history_read(head - 1U, sample) == 0) {
+            return 0;
+        }
+    }
+}
+
+void sensor_manager_cursor_init(sensor_cursor_t *cursor)
+{
+    if (cursor == NULL) {
+        return;
+    }
+    
+    cursor->next = (uint32_t)atomic_get(&published);
+    cursor->dropped = 0;
+}
+
+int sensor_manager_read_since(sensor_cursor_t *cursor, sensor_sample_t *buf, size_t n)
+{
+    if (cursor == NULL || (buf == NULL && n > 0)) {
+        return -EINVAL;
+    }
+    
+    size_t count = 0;
+    
+    while (count < n) {
+        uint32_t head = (uint32_t)atomic_get(&published);
+        uint32_t pending = head - cursor->next;
+        
+        if (pending == 0) {
+            break;
+        }
+        
+        /* Reader fell behind: skip to the oldest sample still stored */
+        if (pending > SENSOR_HISTORY_SIZE) {
+            cursor->dropped += pending - SENSOR_HISTORY_SIZE;
+            cursor->next = head - SENSOR_HISTORY_SIZE;
+        }
+        
+        if (history_read(cursor->next, &buf[count]) == 0) {
+            count++;
+        } else {
+            /* Overwritten while we were copying it */
+            cursor->dropped++;
+        }
+        cursor->next++;
+    }
     
-    return latest_data.valid ? 0 : -ENODATA;
+    return (int)count;
 }
 
-void sensor_manager_register_callback(sensor_data_callback_t callback)
+int sensor_manager_set_period(sensor_channel_t channel, uint32_t period_ms)
 {
-    data_callback = callback;
-    LOG_INF("Sensor data callback registered");
-}
\ No newline at end of file
+    if (channel >= SENSOR_CHANNEL_COUNT) {
+        return -EINVAL;
+    }
+    
+    k_spinlock_key_t key = k_spin_lock(&schedule_lock);
+    schedule[channel].period_ms = period_ms;
+    schedule[channel].next_ms = k_uptime_get() + period_ms;
+    k_spin_unlock(&schedule_lock, key);
+    
+    /* Let the sensor thread recompute its wake-up time */
+    k_sem_give(&schedule_changed);
+    
+    LOG_INF("%s period set to %u ms", schedule[channel].name, period_ms);
+    return 0;
+}
+
+uint32_t sensor_manager_get_period(sensor_channel_t channel)
+{
+    if (channel >= SENSOR_CHANNEL_COUNT) {
+        return 0;
+    }
+    
+    return schedule[channel].period_ms;
+}
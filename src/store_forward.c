@@ -0,0 +1,396 @@
+/**
+ * @file store_forward.c
+ * @brief Flash log of samples the MQTT uplink could not send
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#include <errno.h>
+#include "store_forward.h"
+
+#ifdef CONFIG_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
+
+LOG_MODULE_REGISTER(store_forward, LOG_LEVEL_INF);
+
+#if !FIXED_PARTITION_EXISTS(store_partition)
+#error "CONFIG_APP_STORE_FORWARD needs a store_partition in the devicetree"
+#endif
+
+#define STORE_AREA_ID FIXED_PARTITION_ID(store_partition)
+
+/* "SAF1": a change of record layout must change it, so old logs are wiped */
+#define STORE_MAGIC   0x53414631U
+
+/* One log record */
+struct store_record {
+    uint32_t seq;
+    sensor_sample_t sample;
+};
+
+static struct flash_sector sectors[CONFIG_APP_STORE_FORWARD_MAX_SECTORS];
+static struct fcb fcb;
+
+/* Last confirmed record; fe_sector NULL before the oldest one */
+static struct fcb_entry read_loc;
+
+static bool ready;
+static uint32_t acked_seq;      /* Sequence number of the last confirmed record */
+static uint32_t next_seq;
+static struct store_forward_stats stats;
+
+static int read_record(const struct fcb_entry *loc, struct store_record *record)
+{
+    if (loc->fe_data_len != sizeof(*record)) {
+        return -EBADMSG;
+    }
+
+    return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF((*loc)), record, sizeof(*record));
+}
+
+#ifdef CONFIG_SETTINGS
+static int store_settings_set(const char *name, size_t len,
+                              settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+
+    if (!settings_name_steq(name, "acked", &next) || next != NULL) {
+        return -ENOENT;
+    }
+
+    if (len != sizeof(acked_seq)) {
+        return -EINVAL;
+    }
+
+    ssize_t ret = read_cb(cb_arg, &acked_seq, sizeof(acked_seq));
+    return ret < 0 ? (int)ret : 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(store_forward, "saf", NULL,
+                               store_settings_set, NULL, NULL);
+#endif
+
+static int cursor_save(void)
+{
+#ifdef CONFIG_SETTINGS
+    int ret = settings_save_one("saf/acked", &acked_seq, sizeof(acked_seq));
+    if (ret != 0) {
+        LOG_ERR("Failed to store replay cursor: %d", ret);
+        return ret;
+    }
+#endif
+    return 0;
+}
+
+static void cursor_load(void)
+{
+    acked_seq = 0;
+#ifdef CONFIG_SETTINGS
+    int ret = settings_subsys_init();
+    if (ret == 0) {
+        ret = settings_load_subtree("saf");
+    }
+    if (ret != 0) {
+        LOG_WRN("Replay cursor unavailable, replaying the whole log: %d", ret);
+    }
+#endif
+}
+
+/* Pending records of one sector, counted before it is erased */
+static int count_pending(struct fcb_entry_ctx *ctx, void *arg)
+{
+    uint32_t *count = arg;
+    struct store_record record;
+
+    if (read_record(&ctx->loc, &record) == 0 && record.seq > acked_seq) {
+        (*count)++;
+    }
+    return 0;
+}
+
+/* Erase the oldest sector, moving the cursor off it */
+static int erase_oldest(bool confirmed)
+{
+    uint32_t unsent = 0;
+    int ret;
+
+    if (!confirmed) {
+        fcb_walk(&fcb, fcb.f_oldest, count_pending, &unsent);
+    }
+
+    if (read_loc.fe_sector == fcb.f_oldest) {
+        read_loc.fe_sector = NULL;
+    }
+
+    ret = fcb_rotate(&fcb);
+    if (ret != 0) {
+        LOG_ERR("Sector erase failed: %d", ret);
+        return ret;
+    }
+
+    stats.erased++;
+    if (unsent > 0) {
+        stats.dropped += unsent;
+        stats.pending -= MIN(unsent, stats.pending);
+        LOG_WRN("Log full, dropped %u unsent samples", unsent);
+    }
+    return 0;
+}
+
+/* Erase the sectors before the cursor's: all their records are confirmed */
+static int erase_confirmed(void)
+{
+    while (read_loc.fe_sector != NULL && fcb.f_oldest != read_loc.fe_sector) {
+        int ret = erase_oldest(true);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/* Find the cursor and the counters in the records on flash */
+static void scan(void)
+{
+    struct fcb_entry loc = {0};
+    struct store_record record;
+    uint32_t last_seq = acked_seq;
+
+    read_loc = (struct fcb_entry){0};
+    stats.pending = 0;
+
+    while (fcb_getnext(&fcb, &loc) == 0) {
+        if (read_record(&loc, &record) != 0) {
+            continue;
+        }
+        if (record.seq <= acked_seq) {
+            read_loc = loc;
+        } else {
+            stats.pending++;
+        }
+        last_seq = MAX(last_seq, record.seq);
+    }
+
+    next_seq = last_seq + 1;
+}
+
+int store_forward_init(void)
+{
+    uint32_t sector_cnt = ARRAY_SIZE(sectors);
+    const struct flash_area *fa;
+    int ret;
+
+    ready = false;
+    stats = (struct store_forward_stats){0};
+
+    ret = flash_area_get_sectors(STORE_AREA_ID, &sector_cnt, sectors);
+    if (ret != 0) {
+        LOG_ERR("Cannot map store partition: %d", ret);
+        return ret;
+    }
+    if (sector_cnt < 2) {
+        LOG_ERR("Store partition needs at least two sectors");
+        return -EINVAL;
+    }
+
+    fcb = (struct fcb){
+        .f_magic = STORE_MAGIC,
+        .f_version = 1,
+        .f_sector_cnt = (uint8_t)sector_cnt,
+        .f_sectors = sectors,
+    };
+
+    ret = fcb_init(STORE_AREA_ID, &fcb);
+    if (ret != 0) {
+        /* Not a log of ours: start a new one */
+        LOG_WRN("Formatting store partition (%d)", ret);
+
+        ret = flash_area_open(STORE_AREA_ID, &fa);
+        if (ret == 0) {
+            ret = flash_area_erase(fa, 0, flash_area_get_size(fa));
+            flash_area_close(fa);
+        }
+        if (ret == 0) {
+            ret = fcb_init(STORE_AREA_ID, &fcb);
+        }
+        if (ret != 0) {
+            LOG_ERR("Store partition unusable: %d", ret);
+            return ret;
+        }
+    }
+
+    cursor_load();
+    scan();
+
+    ret = erase_confirmed();
+    if (ret != 0) {
+        return ret;
+    }
+
+    ready = true;
+    LOG_INF("Store-and-forward log: %u sectors, %u samples to replay",
+            (unsigned int)sector_cnt, stats.pending);
+    return 0;
+}
+
+static int append_one(const sensor_sample_t *sample)
+{
+    struct store_record record = {.seq = next_seq, .sample = *sample};
+    struct fcb_entry loc;
+    int ret;
+
+    ret = fcb_append(&fcb, sizeof(record), &loc);
+    if (ret == -ENOSPC) {
+        ret = erase_oldest(false);
+        if (ret == 0) {
+            ret = fcb_append(&fcb, sizeof(record), &loc);
+        }
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), &record, sizeof(record));
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = fcb_append_finish(&fcb, &loc);
+    if (ret != 0) {
+        return ret;
+    }
+
+    next_seq++;
+    stats.stored++;
+    stats.pending++;
+    return 0;
+}
+
+int store_forward_append(const sensor_sample_t *samples, size_t count)
+{
+    if (samples == NULL) {
+        return -EINVAL;
+    }
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        int ret = append_one(&samples[i]);
+        if (ret != 0) {
+            LOG_ERR("Append failed: %d", ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int store_forward_peek(sensor_sample_t *samples, size_t max, uint32_t *last_seq)
+{
+    struct fcb_entry loc = read_loc;
+    struct store_record record;
+    size_t n = 0;
+
+    if (samples == NULL || last_seq == NULL) {
+        return -EINVAL;
+    }
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    while (n < max && fcb_getnext(&fcb, &loc) == 0) {
+        int ret = read_record(&loc, &record);
+        if (ret == -EBADMSG) {
+            continue;
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        samples[n++] = record.sample;
+        *last_seq = record.seq;
+    }
+
+    return (int)n;
+}
+
+int store_forward_ack(uint32_t seq)
+{
+    struct fcb_entry loc = read_loc;
+    struct fcb_entry next = read_loc;
+    struct store_record record;
+    size_t n = 0;
+
+    if (!ready) {
+        return -ENODEV;
+    }
+    if (seq <= acked_seq) {
+        return 0;
+    }
+    if (seq >= next_seq) {
+        return -EINVAL;
+    }
+
+    /*
+     * Skips the same records store_forward_peek() does. Records of the
+     * group erased meanwhile by a full log are already counted as dropped.
+     */
+    while (fcb_getnext(&fcb, &next) == 0) {
+        int ret = read_record(&next, &record);
+        if (ret == -EBADMSG) {
+            loc = next;
+            continue;
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        if (record.seq > seq) {
+            break;
+        }
+        loc = next;
+        n++;
+    }
+
+    read_loc = loc;
+    acked_seq = seq;
+    stats.replayed += n;
+    stats.pending -= MIN(n, stats.pending);
+
+    int ret = cursor_save();
+    if (ret != 0) {
+        return ret;
+    }
+
+    return erase_confirmed();
+}
+
+uint32_t store_forward_pending(void)
+{
+    return stats.pending;
+}
+
+int store_forward_clear(void)
+{
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    int ret = fcb_clear(&fcb);
+    if (ret != 0) {
+        return ret;
+    }
+
+    stats.dropped += stats.pending;
+    stats.pending = 0;
+    read_loc = (struct fcb_entry){0};
+    acked_seq = next_seq - 1;
+    return cursor_save();
+}
+
+void store_forward_get_stats(struct store_forward_stats *out)
+{
+    *out = stats;
+}
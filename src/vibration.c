@@ -0,0 +1,249 @@
+/**
+ * @file vibration.c
+ * @brief Vibration spectrum of the accelerometer stream
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <math.h>
+#include "vibration.h"
+#include "dsp.h"
+#include "app_config.h"
+
+LOG_MODULE_REGISTER(vibration, LOG_LEVEL_INF);
+
+#define FFT_SIZE  CONFIG_APP_VIBRATION_FFT_SIZE
+#define FFT_BINS  (FFT_SIZE / 2)
+
+BUILD_ASSERT(FFT_BINS % VIBRATION_BAND_COUNT == 0,
+             "FFT_SIZE / 2 must be a multiple of the band count");
+
+#define BINS_PER_BAND (FFT_BINS / VIBRATION_BAND_COUNT)
+
+/* Ping-pong windows: one filling from the FIFO, one being analysed */
+static int16_t window_buf[2][FFT_SIZE];
+static uint8_t fill_index;
+static size_t fill_count;
+static uint8_t ready_index;
+static atomic_t analysing;
+static uint32_t windows_dropped;
+static uint32_t next_window_ms;
+static K_SEM_DEFINE(window_ready, 0, 1);
+
+/* Analysis state, only touched by the vibration thread */
+static float hann[FFT_SIZE];
+static float power_scale;
+static float work[2 * FFT_SIZE];   /* The scalar FFT widens to complex */
+static float power[FFT_BINS + 1];
+
+K_MSGQ_DEFINE(vibration_uplink_queue, sizeof(struct vibration_spectrum),
+              VIBRATION_UPLINK_QUEUE_SIZE, 4);
+
+static K_THREAD_STACK_DEFINE(vibration_thread_stack, VIBRATION_THREAD_STACK_SIZE);
+static struct k_thread vibration_thread_data;
+
+static int16_t frame_axis(const struct accel_raw_frame *frame)
+{
+    switch (CONFIG_APP_VIBRATION_AXIS) {
+    case 0:
+        return frame->x;
+    case 1:
+        return frame->y;
+    default:
+        return frame->z;
+    }
+}
+
+void vibration_feed(const struct accel_raw_frame *frames, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        window_buf[fill_index][fill_count++] = spi_accel_sensor_raw_to_mg(frame_axis(&frames[i]));
+
+        if (fill_count < FFT_SIZE) {
+            continue;
+        }
+
+        fill_count = 0;
+
+        /* Only one window per reporting interval is analysed */
+        uint32_t now = k_uptime_get_32();
+        if ((int32_t)(now - next_window_ms) < 0) {
+            continue;
+        }
+
+        if (!atomic_cas(&analysing, 0, 1)) {
+            /* Previous window still in the FFT: reuse this buffer */
+            windows_dropped++;
+            LOG_DBG("Window dropped (%u so far)", windows_dropped);
+            continue;
+        }
+
+        next_window_ms = now + CONFIG_APP_VIBRATION_INTERVAL_MS;
+        ready_index = fill_index;
+        fill_index ^= 1U;
+        k_sem_give(&window_ready);
+    }
+}
+
+/**
+ * @brief Insert a peak into the list kept sorted by descending amplitude
+ */
+static void peak_insert(struct vibration_spectrum *spectrum, float freq_hz, float amplitude_mg)
+{
+    int pos = spectrum->peak_count;
+
+    if (pos == VIBRATION_PEAK_COUNT) {
+        if (amplitude_mg <= spectrum->peaks[pos - 1].amplitude_mg) {
+            return;
+        }
+        pos--;
+    } else {
+        spectrum->peak_count++;
+    }
+
+    while (pos > 0 && spectrum->peaks[pos - 1].amplitude_mg < amplitude_mg) {
+        spectrum->peaks[pos] = spectrum->peaks[pos - 1];
+        pos--;
+    }
+
+    spectrum->peaks[pos].freq_hz = freq_hz;
+    spectrum->peaks[pos].amplitude_mg = amplitude_mg;
+}
+
+int vibration_analyze(const int16_t *samples, struct vibration_spectrum *spectrum)
+{
+    if (samples == NULL || spectrum == NULL) {
+        return -EINVAL;
+    }
+
+    /* Remove DC (gravity) before windowing */
+    int32_t sum = 0;
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        sum += samples[i];
+    }
+    float mean = (float)sum / FFT_SIZE;
+
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        work[i] = ((float)samples[i] - mean) * hann[i];
+    }
+
+    int ret = dsp_rfft_power(work, FFT_SIZE, power);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* One-sided power in mg², so the bins of a band sum to its mean square */
+    for (size_t k = 0; k <= FFT_BINS; k++) {
+        power[k] *= power_scale;
+    }
+    power[0] *= 0.5f;
+    power[FFT_BINS] *= 0.5f;
+
+    float bin_hz = (float)CONFIG_APP_ACCEL_STREAM_ODR_HZ / FFT_SIZE;
+    float total = 0.0f;
+
+    spectrum->sample_rate_hz = CONFIG_APP_ACCEL_STREAM_ODR_HZ;
+    spectrum->fft_size = FFT_SIZE;
+    spectrum->axis = CONFIG_APP_VIBRATION_AXIS;
+    spectrum->band_width_hz = bin_hz * BINS_PER_BAND;
+    spectrum->peak_count = 0;
+
+    for (size_t band = 0; band < VIBRATION_BAND_COUNT; band++) {
+        float energy = 0.0f;
+
+        for (size_t k = band * BINS_PER_BAND; k < (band + 1) * BINS_PER_BAND; k++) {
+            energy += power[k];
+        }
+        spectrum->band_rms_mg[band] = sqrtf(energy);
+        total += energy;
+    }
+    spectrum->rms_mg = sqrtf(total + power[FFT_BINS]);
+
+    for (size_t k = 1; k < FFT_BINS; k++) {
+        float left = power[k - 1];
+        float centre = power[k];
+        float right = power[k + 1];
+
+        if (centre <= left || centre < right) {
+            continue;
+        }
+
+        /* Parabolic interpolation of the peak position between bins */
+        float denom = left - 2.0f * centre + right;
+        float offset = (denom != 0.0f) ? 0.5f * (left - right) / denom : 0.0f;
+
+        /* A Hann-windowed tone spreads over the peak bin and its neighbours */
+        peak_insert(spectrum, ((float)k + offset) * bin_hz, sqrtf(left + centre + right));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Vibration thread: analyses each completed window
+ */
+static void vibration_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    LOG_INF("Vibration thread started");
+
+    while (1) {
+        k_sem_take(&window_ready, K_FOREVER);
+
+        struct vibration_spectrum spectrum;
+        int ret = vibration_analyze(window_buf[ready_index], &spectrum);
+
+        atomic_clear(&analysing);
+
+        if (ret < 0) {
+            LOG_ERR("Spectrum analysis failed: %d", ret);
+            continue;
+        }
+
+        spectrum.timestamp_ms = k_uptime_get_32();
+
+        if (k_msgq_put(&vibration_uplink_queue, &spectrum, K_NO_WAIT) != 0) {
+            LOG_WRN("Vibration uplink queue full, spectrum dropped");
+        }
+    }
+}
+
+int vibration_start(void)
+{
+    int ret = dsp_fft_init();
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Periodic Hann window and the matching power normalisation */
+    float window_sq = 0.0f;
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        hann[i] = 0.5f - 0.5f * cosf(2.0f * 3.14159265f * (float)i / FFT_SIZE);
+        window_sq += hann[i] * hann[i];
+    }
+    power_scale = 2.0f / ((float)FFT_SIZE * window_sq);
+
+    k_tid_t tid = k_thread_create(&vibration_thread_data, vibration_thread_stack,
+                                  K_THREAD_STACK_SIZEOF(vibration_thread_stack),
+                                  vibration_thread, NULL, NULL, NULL,
+                                  VIBRATION_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "vibration");
+
+    LOG_INF("Vibration spectrum: %d-point FFT (%s) on axis %d, %d mHz bins",
+            FFT_SIZE, IS_ENABLED(CONFIG_APP_VIBRATION_FFT_SCALAR) ? "scalar" : "fast",
+            CONFIG_APP_VIBRATION_AXIS,
+            CONFIG_APP_ACCEL_STREAM_ODR_HZ * 1000 / FFT_SIZE);
+    return 0;
+}
+
+int vibration_get_spectrum(struct vibration_spectrum *spectrum, k_timeout_t timeout)
+{
+    if (spectrum == NULL) {
+        return -EINVAL;
+    }
+
+    return (k_msgq_get(&vibration_uplink_queue, spectrum, timeout) == 0) ? 0 : -EAGAIN;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file fft.c
+ * @brief Real-input FFT power spectrum, scalar and table-driven paths
+ */
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include "dsp.h"
+
+#define DSP_PI 3.14159265358979f
+
+BUILD_ASSERT((DSP_FFT_MAX_SIZE & (DSP_FFT_MAX_SIZE - 1)) == 0 && DSP_FFT_MAX_SIZE >= 4,
+             "FFT size must be a power of two");
+
+/* W_N^k = cos(2πk/N) - i·sin(2πk/N), k < N/2 */
+static float twiddle_cos[DSP_FFT_MAX_SIZE / 2];
+static float twiddle_sin[DSP_FFT_MAX_SIZE / 2];
+static bool twiddles_ready;
+
+static inline bool is_pow2(size_t n)
+{
+    return n >= 4 && (n & (n - 1)) == 0;
+}
+
+int dsp_fft_init(void)
+{
+    for (size_t k = 0; k < DSP_FFT_MAX_SIZE / 2; k++) {
+        float angle = 2.0f * DSP_PI * (float)k / (float)DSP_FFT_MAX_SIZE;
+
+        twiddle_cos[k] = cosf(angle);
+        twiddle_sin[k] = sinf(angle);
+    }
+
+    twiddles_ready = true;
+    return 0;
+}
+
+/**
+ * @brief Reorder m interleaved complex points into bit-reversed order
+ */
+static void bit_reverse(float *z, size_t m)
+{
+    for (size_t i = 1, j = 0; i < m; i++) {
+        size_t bit = m >> 1;
+
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            float re = z[2 * i];
+            float im = z[2 * i + 1];
+
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = re;
+            z[2 * j + 1] = im;
+        }
+    }
+}
+
+int dsp_rfft_power_scalar(float *data, size_t n, float *power)
+{
+    if (data == NULL || power == NULL || !is_pow2(n)) {
+        return -EINVAL;
+    }
+
+    /* Widen to interleaved complex, back to front so nothing is overwritten early */
+    for (size_t i = n; i-- > 0;) {
+        data[2 * i] = data[i];
+        data[2 * i + 1] = 0.0f;
+    }
+
+    bit_reverse(data, n);
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2;
+        float step_re = cosf(-2.0f * DSP_PI / (float)len);
+        float step_im = sinf(-2.0f * DSP_PI / (float)len);
+
+        for (size_t start = 0; start < n; start += len) {
+            float w_re = 1.0f;
+            float w_im = 0.0f;
+
+            for (size_t k = 0; k < half; k++) {
+                float *a = &data[2 * (start + k)];
+                float *b = &data[2 * (start + k + half)];
+                float t_re = b[0] * w_re - b[1] * w_im;
+                float t_im = b[0] * w_im + b[1] * w_re;
+
+                b[0] = a[0] - t_re;
+                b[1] = a[1] - t_im;
+                a[0] += t_re;
+                a[1] += t_im;
+
+                float next_re = w_re * step_re - w_im * step_im;
+                w_im = w_re * step_im + w_im * step_re;
+                w_re = next_re;
+            }
+        }
+    }
+
+    for (size_t k = 0; k <= n / 2; k++) {
+        power[k] = data[2 * k] * data[2 * k] + data[2 * k + 1] * data[2 * k + 1];
+    }
+
+    return 0;
+}
+
+int dsp_rfft_power_fast(float *data, size_t n, float *power)
+{
+    if (data == NULL || power == NULL || !is_pow2(n) || n > DSP_FFT_MAX_SIZE) {
+        return -EINVAL;
+    }
+    if (!twiddles_ready) {
+        return -EAGAIN;
+    }
+
+    /* Even samples are the real parts, odd samples the imaginary parts */
+    size_t m = n / 2;
+    size_t stride = DSP_FFT_MAX_SIZE / n;
+
+    bit_reverse(data, m);
+
+    /* First stage: W = 1 */
+    for (size_t i = 0; i < m; i += 2) {
+        float *a = &data[2 * i];
+        float *b = &data[2 * i + 2];
+        float t_re = b[0];
+        float t_im = b[1];
+
+        b[0] = a[0] - t_re;
+        b[1] = a[1] - t_im;
+        a[0] += t_re;
+        a[1] += t_im;
+    }
+
+    /* Twiddle outermost so each table load serves every group */
+    for (size_t len = 4; len <= m; len <<= 1) {
+        size_t half = len / 2;
+        size_t step = DSP_FFT_MAX_SIZE / len;
+
+        for (size_t k = 0; k < half; k++) {
+            float w_re = twiddle_cos[k * step];
+            float w_im = -twiddle_sin[k * step];
+
+            for (size_t start = k; start < m; start += len) {
+                float *a = &data[2 * start];
+                float *b = &data[2 * (start + half)];
+                float t_re = b[0] * w_re - b[1] * w_im;
+                float t_im = b[0] * w_im + b[1] * w_re;
+
+                b[0] = a[0] - t_re;
+                b[1] = a[1] - t_im;
+                a[0] += t_re;
+                a[1] += t_im;
+            }
+        }
+    }
+
+    /* Split the half-size complex spectrum Z into the real spectrum X */
+    float dc = data[0] + data[1];
+    float nyquist = data[0] - data[1];
+
+    power[0] = dc * dc;
+    power[m] = nyquist * nyquist;
+
+    for (size_t k = 1; k < m; k++) {
+        float z_re = data[2 * k];
+        float z_im = data[2 * k + 1];
+        float c_re = data[2 * (m - k)];
+        float c_im = data[2 * (m - k) + 1];
+
+        float even_re = 0.5f * (z_re + c_re);
+        float even_im = 0.5f * (z_im - c_im);
+        float odd_re = 0.5f * (z_im + c_im);
+        float odd_im = -0.5f * (z_re - c_re);
+
+        float w_re = twiddle_cos[k * stride];
+        float w_im = -twiddle_sin[k * stride];
+
+        float x_re = even_re + odd_re * w_re - odd_im * w_im;
+        float x_im = even_im + odd_re * w_im + odd_im * w_re;
+
+        power[k] = x_re * x_re + x_im * x_im;
+    }
+
+    return 0;
+}
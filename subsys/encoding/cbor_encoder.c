@@ -0,0 +1,357 @@
+/**
+ * @file cbor_encoder.c
+ * @brief CBOR (RFC 8949) encoding for sensor data payloads
+ *
+ * Same logical record as json_encode_sensor_data_with_metadata(), as a
+ * definite-length map with small integer keys:
+ *
+ *   1: device_id     text
+ *   2: version       [major, minor, patch]
+ *   3: timestamp     uint, ms
+ *   4: temperature   float, °C
+ *   5: accelerometer [x, y, z] floats, m/s²
+ *   6: battery       float, V
+ *
+ * Keys from 4 on are the cbor column of SAMPLE_FIELDS (sample_schema.h);
+ * multi-component fields are arrays.
+ *
+ * A batch (cbor_encode_sensor_batch) keeps keys 1-3, with 3 the first
+ * sample's timestamp, and adds
+ *
+ *   7: samples       [[dt, t, x, y, z, b, valid], ...] integer rows
+ *                    as in sample_batch.h
+ *
+ * Floats are written as half precision when that stays within the
+ * precision the JSON encoder prints for the field, else as single.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <math.h>
+#include <string.h>
+#include "sensor_manager.h"
+#include "app_config.h"
+#include "sample_batch.h"
+
+LOG_MODULE_REGISTER(cbor_encoder, LOG_LEVEL_DBG);
+
+/* Major types */
+#define CBOR_UINT   0
+#define CBOR_NINT   1
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+#define CBOR_SIMPLE 7
+
+/* Additional info for floats under major type 7 */
+#define CBOR_FLOAT16 25
+#define CBOR_FLOAT32 26
+
+#define CBOR_KEY_DEVICE_ID   1
+#define CBOR_KEY_VERSION     2
+#define CBOR_KEY_TIMESTAMP   3
+#define CBOR_KEY_SAMPLES     7
+
+/* Half of the last digit the JSON encoder prints with 0-4 decimals */
+static const float json_tolerance[] = {0.5f, 0.05f, 0.005f, 0.0005f, 0.00005f};
+
+/* Output cursor; len keeps counting past size so overflow is detected once */
+struct cbor_writer {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+};
+
+static inline void put_byte(struct cbor_writer *w, uint8_t byte)
+{
+    if (w->len < w->size) {
+        w->buf[w->len] = byte;
+    }
+    w->len++;
+}
+
+static void put_head(struct cbor_writer *w, uint8_t major, uint32_t value)
+{
+    uint8_t ib = (uint8_t)(major << 5);
+
+    if (value < 24) {
+        put_byte(w, ib | (uint8_t)value);
+    } else if (value <= UINT8_MAX) {
+        put_byte(w, ib | 24);
+        put_byte(w, (uint8_t)value);
+    } else if (value <= UINT16_MAX) {
+        put_byte(w, ib | 25);
+        put_byte(w, (uint8_t)(value >> 8));
+        put_byte(w, (uint8_t)value);
+    } else {
+        put_byte(w, ib | 26);
+        put_byte(w, (uint8_t)(value >> 24));
+        put_byte(w, (uint8_t)(value >> 16));
+        put_byte(w, (uint8_t)(value >> 8));
+        put_byte(w, (uint8_t)value);
+    }
+}
+
+static void put_int(struct cbor_writer *w, int32_t value)
+{
+    if (value < 0) {
+        put_head(w, CBOR_NINT, (uint32_t)(-1 - value));
+    } else {
+        put_head(w, CBOR_UINT, (uint32_t)value);
+    }
+}
+
+static void put_text(struct cbor_writer *w, const char *text)
+{
+    size_t len = strlen(text);
+
+    put_head(w, CBOR_TEXT, (uint32_t)len);
+    for (size_t i = 0; i < len; i++) {
+        put_byte(w, (uint8_t)text[i]);
+    }
+}
+
+/**
+ * @brief IEEE 754 single to half precision, round to nearest even
+ */
+static uint16_t float_to_half(float value)
+{
+    uint32_t f;
+
+    memcpy(&f, &value, sizeof(f));
+
+    uint16_t sign = (uint16_t)((f >> 16) & 0x8000U);
+    int32_t exp = (int32_t)((f >> 23) & 0xFFU) - 127 + 15;
+    uint32_t mant = f & 0x7FFFFFU;
+
+    if (((f >> 23) & 0xFFU) == 0xFFU) {
+        return sign | 0x7C00U | (mant != 0 ? 0x200U : 0);
+    }
+    if (exp >= 31) {
+        return sign | 0x7C00U;
+    }
+    if (exp <= 0) {
+        if (exp < -10) {
+            return sign;
+        }
+        /* Subnormal half: shift the implicit bit in */
+        mant |= 0x800000U;
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1U << shift) - 1U);
+        uint32_t halfway = 1U << (shift - 1U);
+
+        if (rem > halfway || (rem == halfway && (half & 1U))) {
+            half++;
+        }
+        return sign | (uint16_t)half;
+    }
+
+    uint32_t half = ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFFU;
+
+    /* A mantissa carry rolls into the exponent, which is what we want */
+    if (rem > 0x1000U || (rem == 0x1000U && (half & 1U))) {
+        half++;
+    }
+    return sign | (uint16_t)half;
+}
+
+static float half_to_float(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000U) << 16;
+    uint32_t exp = (half >> 10) & 0x1FU;
+    uint32_t mant = half & 0x3FFU;
+    uint32_t f;
+    float value;
+
+    if (exp == 0) {
+        value = (float)mant * 5.9604645e-8f;   /* 2^-24 */
+        return sign ? -value : value;
+    }
+
+    if (exp == 31) {
+        f = sign | 0x7F800000U | (mant << 13);
+    } else {
+        f = sign | ((exp - 15U + 127U) << 23) | (mant << 13);
+    }
+
+    memcpy(&value, &f, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Write a float as half precision if within @p tolerance, else single
+ */
+static void put_float(struct cbor_writer *w, float value, float tolerance)
+{
+    uint16_t half = float_to_half(value);
+
+    if (fabsf(half_to_float(half) - value) <= tolerance) {
+        put_byte(w, (CBOR_SIMPLE << 5) | CBOR_FLOAT16);
+        put_byte(w, (uint8_t)(half >> 8));
+        put_byte(w, (uint8_t)half);
+        return;
+    }
+
+    uint32_t f;
+
+    memcpy(&f, &value, sizeof(f));
+    put_byte(w, (CBOR_SIMPLE << 5) | CBOR_FLOAT32);
+    put_byte(w, (uint8_t)(f >> 24));
+    put_byte(w, (uint8_t)(f >> 16));
+    put_byte(w, (uint8_t)(f >> 8));
+    put_byte(w, (uint8_t)f);
+}
+
+static void put_metadata(struct cbor_writer *w, const char *device_id)
+{
+    put_head(w, CBOR_UINT, CBOR_KEY_DEVICE_ID);
+    put_text(w, device_id ? device_id : "unknown");
+
+    put_head(w, CBOR_UINT, CBOR_KEY_VERSION);
+    put_head(w, CBOR_ARRAY, 3);
+    put_head(w, CBOR_UINT, APP_VERSION_MAJOR);
+    put_head(w, CBOR_UINT, APP_VERSION_MINOR);
+    put_head(w, CBOR_UINT, APP_VERSION_PATCH);
+}
+
+static void put_sensors(struct cbor_writer *w, const sensor_data_t *data)
+{
+    put_head(w, CBOR_UINT, CBOR_KEY_TIMESTAMP);
+    put_head(w, CBOR_UINT, data->timestamp_ms);
+
+#define PUT_FIELD(name, type, n, value, mul, div, unit, label, json, keys, dec, cdec, cbor, ...) \
+    BUILD_ASSERT((cbor) > CBOR_KEY_TIMESTAMP && (cbor) != CBOR_KEY_SAMPLES,            \
+                 "CBOR key of " #name " clashes with a metadata key");                  \
+    put_head(w, CBOR_UINT, cbor);                                                       \
+    if ((n) > 1) {                                                                      \
+        put_head(w, CBOR_ARRAY, n);                                                     \
+    }                                                                                   \
+    for (int i = 0; i < (n); i++) {                                                     \
+        put_float(w, ((const float *)&data->value)[i], json_tolerance[dec]);            \
+    }
+    SAMPLE_FIELDS(PUT_FIELD)
+#undef PUT_FIELD
+}
+
+static int writer_finish(const struct cbor_writer *w)
+{
+    if (w->len > w->size) {
+        LOG_ERR("CBOR buffer too small (%u > %u)", (unsigned int)w->len,
+                (unsigned int)w->size);
+        return -ENOMEM;
+    }
+
+    return (int)w->len;
+}
+
+/**
+ * @brief Encode sensor data to CBOR (timestamp and sensor keys only)
+ * @param data Sensor data to encode
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @return Number of bytes written, or negative errno on failure
+ */
+int cbor_encode_sensor_data(const sensor_data_t *data, uint8_t *buffer, size_t buffer_size)
+{
+    if (data == NULL || buffer == NULL || buffer_size == 0) {
+        return -EINVAL;
+    }
+
+    if (!data->valid) {
+        LOG_WRN("Encoding invalid sensor data");
+        return -EINVAL;
+    }
+
+    struct cbor_writer w = {.buf = buffer, .size = buffer_size};
+
+    put_head(&w, CBOR_MAP, 1 + SAMPLE_FIELD_COUNT);
+    put_sensors(&w, data);
+
+    return writer_finish(&w);
+}
+
+/**
+ * @brief Encode sensor data to CBOR with metadata
+ * @param data Sensor data to encode
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @param device_id Device identifier string
+ * @return Number of bytes written, or negative errno on failure
+ */
+int cbor_encode_sensor_data_with_metadata(const sensor_data_t *data,
+                                          uint8_t *buffer,
+                                          size_t buffer_size,
+                                          const char *device_id)
+{
+    if (data == NULL || buffer == NULL || buffer_size == 0) {
+        return -EINVAL;
+    }
+
+    if (!data->valid) {
+        LOG_WRN("Encoding invalid sensor data");
+        return -EINVAL;
+    }
+
+    struct cbor_writer w = {.buf = buffer, .size = buffer_size};
+
+    put_head(&w, CBOR_MAP, 3 + SAMPLE_FIELD_COUNT);
+    put_metadata(&w, device_id);
+    put_sensors(&w, data);
+
+    int ret = writer_finish(&w);
+    if (ret > 0) {
+        LOG_DBG("Encoded CBOR with metadata (%d bytes)", ret);
+    }
+    return ret;
+}
+
+/**
+ * @brief Encode a batch of compact samples to CBOR with metadata
+ * @param samples Samples in time order
+ * @param count Number of samples
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @param device_id Device identifier string
+ * @return Number of bytes written, or negative errno on failure
+ */
+int cbor_encode_sensor_batch(const sensor_sample_t *samples,
+                             size_t count,
+                             uint8_t *buffer,
+                             size_t buffer_size,
+                             const char *device_id)
+{
+    if (samples == NULL || count == 0 || buffer == NULL || buffer_size == 0) {
+        return -EINVAL;
+    }
+
+    struct cbor_writer w = {.buf = buffer, .size = buffer_size};
+
+    put_head(&w, CBOR_MAP, 4);
+    put_metadata(&w, device_id);
+
+    put_head(&w, CBOR_UINT, CBOR_KEY_TIMESTAMP);
+    put_head(&w, CBOR_UINT, samples[0].timestamp_ms);
+
+    put_head(&w, CBOR_UINT, CBOR_KEY_SAMPLES);
+    put_head(&w, CBOR_ARRAY, (uint32_t)count);
+
+    for (size_t i = 0; i < count; i++) {
+        struct sample_batch_row row;
+
+        sample_batch_row(i ? &samples[i - 1] : NULL, &samples[i], &row);
+        put_head(&w, CBOR_ARRAY, SAMPLE_BATCH_VALUES + 2);
+        put_head(&w, CBOR_UINT, row.dt_ms);
+        for (int v = 0; v < SAMPLE_BATCH_VALUES; v++) {
+            put_int(&w, row.delta[v]);
+        }
+        put_head(&w, CBOR_UINT, row.valid_mask);
+    }
+
+    int ret = writer_finish(&w);
+    if (ret > 0) {
+        LOG_DBG("Encoded CBOR batch (%u samples, %d bytes)", (unsigned int)count, ret);
+    }
+    return ret;
+}
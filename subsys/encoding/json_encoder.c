@@ -4,33 +4,58 @@
  */
 
 #include <zephyr/kernel.h>
-#include <zephyr/data/json.h>
 #include <zephyr/logging/log.h>
-#include <stdio.h>
 #include <string.h>
 #include "sensor_manager.h"
 #include "app_config.h"
+#include "text_writer.h"
+#include "sample_batch.h"
+
+#ifdef CONFIG_APP_STATS
+#include "sample_stats.h"
+#endif
+
+#ifdef CONFIG_APP_VIBRATION
+#include "vibration.h"
+#endif
 
 LOG_MODULE_REGISTER(json_encoder, LOG_LEVEL_DBG);
 
-/* JSON descriptor for sensor data */
-static const struct json_obj_descr sensor_data_descr[] = {
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, temperature_c, JSON_TOK_FLOAT),
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, accel_x, JSON_TOK_FLOAT),
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, accel_y, JSON_TOK_FLOAT),
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, accel_z, JSON_TOK_FLOAT),
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, battery_voltage, JSON_TOK_FLOAT),
-    JSON_OBJ_DESCR_PRIM(sensor_data_t, timestamp_ms, JSON_TOK_NUMBER),
-};
+/**
+ * @brief Write one schema field of the "sensors" object
+ *
+ * A scalar is written as a number, a vector as an object keyed by @p keys.
+ * Called with constants from SAMPLE_FIELDS, so it unrolls per field.
+ */
+static inline void put_field(struct text_writer *w, const float *value, int n,
+                             const char *keys, unsigned int decimals)
+{
+    if (n == 1) {
+        text_put_fixed(w, value[0], decimals);
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        text_put_str(w, i ? ",\"" : "{\"");
+        text_put_char(w, keys[i]);
+        text_put_str(w, "\":");
+        text_put_fixed(w, value[i], decimals);
+    }
+    text_put_char(w, '}');
+}
 
 /**
- * @brief Encode sensor data to JSON string
+ * @brief Encode sensor data to JSON string with metadata
  * @param data Sensor data to encode
  * @param buffer Output buffer for JSON string
  * @param buffer_size Size of output buffer
+ * @param device_id Device identifier string
  * @return Number of bytes written, or negative errno on failure
  */
-int json_encode_sensor_data(const sensor_data_t *data, char *buffer, size_t buffer_size)
+int json_encode_sensor_data_with_metadata(const sensor_data_t *data, 
+                                          char *buffer, 
+                                          size_t buffer_size,
+                                          const char *device_id)
 {
     if (data == NULL || buffer == NULL || buffer_size == 0) {
         return -EINVAL;
@@ -41,74 +66,332 @@ int json_encode_sensor_data(const sensor_data_t *data, char *buffer, size_t buff
         return -EINVAL;
     }
     
-    /* Use Zephyr's JSON library for encoding */
-    int ret = json_obj_encode_buf(sensor_data_descr, ARRAY_SIZE(sensor_data_descr),
-                                   data, buffer, buffer_size);
+    /* Manual JSON construction with metadata */
+    struct text_writer w;
+    
+    text_writer_init(&w, buffer, buffer_size);
+    text_put_str(&w, "{\"device_id\":\"");
+    text_put_str(&w, device_id ? device_id : "unknown");
+    text_put_str(&w, "\",\"version\":\"");
+    text_put_int(&w, APP_VERSION_MAJOR);
+    text_put_char(&w, '.');
+    text_put_int(&w, APP_VERSION_MINOR);
+    text_put_char(&w, '.');
+    text_put_int(&w, APP_VERSION_PATCH);
+    text_put_str(&w, "\",\"timestamp\":");
+    text_put_uint(&w, data->timestamp_ms);
+    text_put_str(&w, ",\"sensors\":");
+    
+    char sep = '{';
+    
+#define PUT_FIELD(name, type, n, value, mul, div, unit, label, json, keys, dec, ...) \
+    text_put_char(&w, sep);                                                     \
+    sep = ',';                                                                  \
+    text_put_str(&w, "\"" json "\":");                                           \
+    put_field(&w, (const float *)&data->value, n, keys, dec);
+    SAMPLE_FIELDS(PUT_FIELD)
+#undef PUT_FIELD
+    
+    text_put_str(&w, "}}");
     
+    int ret = text_finish(&w);
     if (ret < 0) {
-        LOG_ERR("Failed to encode JSON: %d", ret);
+        LOG_ERR("Failed to format JSON");
         return ret;
     }
     
-    LOG_DBG("Encoded JSON (%d bytes): %s", ret, buffer);
+    LOG_DBG("Encoded JSON with metadata (%d bytes)", ret);
     return ret;
 }
 
 /**
- * @brief Encode sensor data to JSON string with metadata
+ * @brief Encode sensor data to the compact JSON sent over BLE
+ *
+ * {"t":°C,"x":m/s²,"y":m/s²,"z":m/s²,"b":V}, sized for one notification:
+ * one flat key per component, as listed in SAMPLE_FIELDS.
+ *
  * @param data Sensor data to encode
  * @param buffer Output buffer for JSON string
  * @param buffer_size Size of output buffer
- * @param device_id Device identifier string
  * @return Number of bytes written, or negative errno on failure
  */
-int json_encode_sensor_data_with_metadata(const sensor_data_t *data, 
-                                          char *buffer, 
-                                          size_t buffer_size,
-                                          const char *device_id)
+int json_encode_sensor_data_compact(const sensor_data_t *data, char *buffer, size_t buffer_size)
 {
     if (data == NULL || buffer == NULL || buffer_size == 0) {
         return -EINVAL;
     }
     
-    if (!data->valid) {
-        LOG_WRN("Encoding invalid sensor data");
+    struct text_writer w;
+    
+    text_writer_init(&w, buffer, buffer_size);
+    char sep = '{';
+    
+#define PUT_COMPACT(name, type, n, value, mul, div, unit, label, json, keys, dec, cdec, ...) \
+    for (int i = 0; i < (n); i++) {                                             \
+        text_put_char(&w, sep);                                                 \
+        sep = ',';                                                              \
+        text_put_char(&w, '"');                                                 \
+        text_put_char(&w, keys[i]);                                             \
+        text_put_str(&w, "\":");                                                \
+        text_put_fixed(&w, ((const float *)&data->value)[i], cdec);             \
+    }
+    SAMPLE_FIELDS(PUT_COMPACT)
+#undef PUT_COMPACT
+    
+    text_put_char(&w, '}');
+    
+    int len = text_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Failed to format compact JSON");
+    }
+    return len;
+}
+
+/**
+ * @brief Encode a batch of compact samples to JSON with metadata
+ *
+ * {"device_id":..,"version":..,"timestamp":<first sample>,"n":<count>,
+ *  "samples":[[dt,t,x,y,z,b,valid],...]}, rows as in sample_batch.h.
+ *
+ * Written through @p w, so the caller can count or stream the output.
+ *
+ * @param w Writer
+ * @param samples Samples in time order, at least one
+ * @param count Number of samples
+ * @param device_id Device identifier string
+ */
+void json_write_sensor_batch(struct text_writer *w,
+                             const sensor_sample_t *samples,
+                             size_t count,
+                             const char *device_id)
+{
+    text_put_str(w, "{\"device_id\":\"");
+    text_put_str(w, device_id ? device_id : "unknown");
+    text_put_str(w, "\",\"version\":\"");
+    text_put_int(w, APP_VERSION_MAJOR);
+    text_put_char(w, '.');
+    text_put_int(w, APP_VERSION_MINOR);
+    text_put_char(w, '.');
+    text_put_int(w, APP_VERSION_PATCH);
+    text_put_str(w, "\",\"timestamp\":");
+    text_put_uint(w, samples[0].timestamp_ms);
+    text_put_str(w, ",\"n\":");
+    text_put_uint(w, (uint32_t)count);
+    text_put_str(w, ",\"samples\":[");
+    
+    for (size_t i = 0; i < count; i++) {
+        struct sample_batch_row row;
+        
+        sample_batch_row(i ? &samples[i - 1] : NULL, &samples[i], &row);
+        text_put_str(w, i ? ",[" : "[");
+        text_put_uint(w, row.dt_ms);
+        for (int v = 0; v < SAMPLE_BATCH_VALUES; v++) {
+            text_put_char(w, ',');
+            text_put_int(w, row.delta[v]);
+        }
+        text_put_char(w, ',');
+        text_put_uint(w, row.valid_mask);
+        text_put_char(w, ']');
+    }
+    
+    text_put_str(w, "]}");
+}
+
+/**
+ * @brief Encode a batch of compact samples into a buffer
+ * @return Number of bytes written, or negative errno on failure
+ */
+int json_encode_sensor_batch(const sensor_sample_t *samples,
+                             size_t count,
+                             char *buffer,
+                             size_t buffer_size,
+                             const char *device_id)
+{
+    if (samples == NULL || count == 0 || buffer == NULL || buffer_size == 0) {
         return -EINVAL;
     }
     
-    /* Manual JSON construction with metadata */
-    int ret = snprintf(buffer, buffer_size,
-        "{"
-        "\"device_id\":\"%s\","
-        "\"version\":\"%d.%d.%d\","
-        "\"timestamp\":%u,"
-        "\"sensors\":{"
-            "\"temperature\":%.2f,"
-            "\"accelerometer\":{"
-                "\"x\":%.3f,"
-                "\"y\":%.3f,"
-                "\"z\":%.3f"
-            "},"
-            "\"battery\":%.2f"
-        "}"
-        "}",
-        device_id ? device_id : "unknown",
-        APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH,
-        data->timestamp_ms,
-        (double)data->temperature_c,
-        (double)data->accel_x,
-        (double)data->accel_y,
-        (double)data->accel_z,
-        (double)data->battery_voltage
-    );
-    
-    if (ret < 0 || ret >= buffer_size) {
-        LOG_ERR("Failed to format JSON");
-        return -ENOMEM;
+    struct text_writer w;
+    
+    text_writer_init(&w, buffer, buffer_size);
+    json_write_sensor_batch(&w, samples, count, device_id);
+    
+    int len = text_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Failed to format batch JSON (%u samples)", (unsigned int)count);
+        return len;
     }
     
-    LOG_DBG("Encoded JSON with metadata (%d bytes)", ret);
-    return ret;
+    LOG_DBG("Encoded batch JSON (%u samples, %d bytes)", (unsigned int)count, len);
+    return len;
+}
+
+#ifdef CONFIG_APP_STATS
+/* JSON keys of the statistics channels */
+static const char *const stats_channel_names[STATS_CHANNEL_COUNT] = {
+    [STATS_CHANNEL_TEMP] = "temperature",
+    [STATS_CHANNEL_ACCEL_X] = "accel_x",
+    [STATS_CHANNEL_ACCEL_Y] = "accel_y",
+    [STATS_CHANNEL_ACCEL_Z] = "accel_z",
+};
+
+/**
+ * @brief Write a window statistics summary as JSON with metadata
+ *
+ * Written through @p w, so the caller can count or stream the output.
+ *
+ * @param w Writer
+ * @param summary Summary to write
+ * @param device_id Device identifier string
+ */
+void json_write_stats_summary(struct text_writer *w,
+                              const struct stats_summary *summary,
+                              const char *device_id)
+{
+    text_put_str(w, "{\"device_id\":\"");
+    text_put_str(w, device_id ? device_id : "unknown");
+    text_put_str(w, "\",\"window_ms\":");
+    text_put_uint(w, summary->window_ms);
+    text_put_str(w, ",\"start\":");
+    text_put_uint(w, summary->start_ms);
+    text_put_str(w, ",\"stats\":{");
+    
+    for (int ch = 0; ch < STATS_CHANNEL_COUNT; ch++) {
+        const struct stats_channel_summary *c = &summary->ch[ch];
+        
+        text_put_str(w, ch == 0 ? "\"" : ",\"");
+        text_put_str(w, stats_channel_names[ch]);
+        text_put_str(w, "\":{\"n\":");
+        text_put_uint(w, c->count);
+        text_put_str(w, ",\"min\":");
+        text_put_fixed(w, c->min, 3);
+        text_put_str(w, ",\"max\":");
+        text_put_fixed(w, c->max, 3);
+        text_put_str(w, ",\"mean\":");
+        text_put_fixed(w, c->mean, 3);
+        text_put_str(w, ",\"var\":");
+        text_put_fixed(w, c->variance, 4);
+        text_put_str(w, ",\"rms\":");
+        text_put_fixed(w, c->rms, 3);
+        text_put_str(w, ",\"p2p\":");
+        text_put_fixed(w, c->peak_to_peak, 3);
+        text_put_char(w, '}');
+    }
+    text_put_str(w, "}}");
+}
+
+/**
+ * @brief Encode a window statistics summary to JSON with metadata
+ * @param summary Summary to encode
+ * @param buffer Output buffer for JSON string
+ * @param buffer_size Size of output buffer
+ * @param device_id Device identifier string
+ * @return Number of bytes written, or negative errno on failure
+ */
+int json_encode_stats_summary(const struct stats_summary *summary,
+                              char *buffer,
+                              size_t buffer_size,
+                              const char *device_id)
+{
+    if (summary == NULL || buffer == NULL || buffer_size == 0) {
+        return -EINVAL;
+    }
+    
+    struct text_writer w;
+    
+    text_writer_init(&w, buffer, buffer_size);
+    json_write_stats_summary(&w, summary, device_id);
+    
+    int len = text_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Failed to format statistics JSON");
+        return len;
+    }
+    
+    LOG_DBG("Encoded statistics JSON (%d bytes)", len);
+    return len;
 }
+#endif /* CONFIG_APP_STATS */
 
-/* Extended JSON encoder with metadata */
+#ifdef CONFIG_APP_VIBRATION
+/**
+ * @brief Write a vibration spectrum as JSON with metadata
+ *
+ * Written through @p w, so the caller can count or stream the output.
+ *
+ * @param w Writer
+ * @param spectrum Spectrum to write
+ * @param device_id Device identifier string
+ */
+void json_write_vibration_spectrum(struct text_writer *w,
+                                   const struct vibration_spectrum *spectrum,
+                                   const char *device_id)
+{
+    text_put_str(w, "{\"device_id\":\"");
+    text_put_str(w, device_id ? device_id : "unknown");
+    text_put_str(w, "\",\"timestamp\":");
+    text_put_uint(w, spectrum->timestamp_ms);
+    text_put_str(w, ",\"axis\":\"");
+    text_put_char(w, (char)('x' + spectrum->axis));
+    text_put_str(w, "\",\"fs\":");
+    text_put_uint(w, spectrum->sample_rate_hz);
+    text_put_str(w, ",\"n\":");
+    text_put_uint(w, spectrum->fft_size);
+    text_put_str(w, ",\"rms\":");
+    text_put_fixed(w, spectrum->rms_mg, 2);
+    text_put_str(w, ",\"band_hz\":");
+    text_put_fixed(w, spectrum->band_width_hz, 2);
+    text_put_str(w, ",\"bands\":[");
+    
+    for (int i = 0; i < VIBRATION_BAND_COUNT; i++) {
+        if (i > 0) {
+            text_put_char(w, ',');
+        }
+        text_put_fixed(w, spectrum->band_rms_mg[i], 2);
+    }
+    
+    text_put_str(w, "],\"peaks\":[");
+    
+    for (int i = 0; i < spectrum->peak_count; i++) {
+        text_put_str(w, i == 0 ? "{\"f\":" : ",{\"f\":");
+        text_put_fixed(w, spectrum->peaks[i].freq_hz, 2);
+        text_put_str(w, ",\"a\":");
+        text_put_fixed(w, spectrum->peaks[i].amplitude_mg, 2);
+        text_put_char(w, '}');
+    }
+    
+    text_put_str(w, "]}");
+}
+
+/**
+ * @brief Encode a vibration spectrum to JSON with metadata
+ * @param spectrum Spectrum to encode
+ * @param buffer Output buffer for JSON string
+ * @param buffer_size Size of output buffer
+ * @param device_id Device identifier string
+ * @return Number of bytes written, or negative errno on failure
+ */
+int json_encode_vibration_spectrum(const struct vibration_spectrum *spectrum,
+                                   char *buffer,
+                                   size_t buffer_size,
+                                   const char *device_id)
+{
+    if (spectrum == NULL || buffer == NULL || buffer_size == 0) {
+        return -EINVAL;
+    }
+    
+    struct text_writer w;
+    
+    text_writer_init(&w, buffer, buffer_size);
+    json_write_vibration_spectrum(&w, spectrum, device_id);
+    
+    int len = text_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Failed to format vibration JSON");
+        return len;
+    }
+    
+    LOG_DBG("Encoded vibration JSON (%d bytes)", len);
+    return len;
+}
+#endif /* CONFIG_APP_VIBRATION */
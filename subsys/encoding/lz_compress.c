@@ -0,0 +1,174 @@
+/**
+ * @file lz_compress.c
+ * @brief Streaming LZSS compression in a small fixed window
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+#include "lz_compress.h"
+
+static void put_bits(struct lz_compressor *c, uint32_t value, unsigned int count)
+{
+    c->bit_acc = (c->bit_acc << count) | (value & ((1U << count) - 1U));
+    c->bit_count += count;
+
+    while (c->bit_count >= 8) {
+        c->bit_count -= 8;
+        if (c->out_len >= c->out_size) {
+            c->error = -ENOMEM;
+            continue;
+        }
+        c->out[c->out_len++] = (uint8_t)(c->bit_acc >> c->bit_count);
+    }
+}
+
+/**
+ * @brief Longest match of the bytes at pos in the window behind them
+ * @param dist Receives the distance of the match
+ * @return Match length, 0 if none is worth a back-reference
+ */
+static unsigned int find_match(const struct lz_compressor *c, unsigned int *dist)
+{
+    const uint8_t *work = c->work;
+    const uint8_t *cur = &work[c->pos];
+    unsigned int window = 1U << c->window_bits;
+    unsigned int max_len = MIN(1U << c->lookahead_bits, (unsigned int)(c->fill - c->pos));
+    unsigned int lowest = c->pos > window ? c->pos - window : 0;
+    /* A reference has to be shorter than the literals it replaces */
+    unsigned int best = (1U + c->window_bits + c->lookahead_bits) / 9U;
+
+    if (max_len <= best) {
+        return 0;
+    }
+
+    /* Nearest first, so equal lengths keep the shorter distance */
+    for (unsigned int j = c->pos; j-- > lowest;) {
+        const uint8_t *cand = &work[j];
+
+        /* Cheap reject: a longer match must also differ nowhere up to best */
+        if (cand[best] != cur[best] || cand[0] != cur[0]) {
+            continue;
+        }
+
+        unsigned int len = 1;
+
+        while (len < max_len && cand[len] == cur[len]) {
+            len++;
+        }
+
+        if (len > best) {
+            best = len;
+            *dist = c->pos - j;
+            if (len == max_len) {
+                break;
+            }
+        }
+    }
+
+    return *dist != 0 ? best : 0;
+}
+
+/* Encode until fewer than @p keep bytes remain unencoded */
+static void encode(struct lz_compressor *c, unsigned int keep)
+{
+    while ((unsigned int)(c->fill - c->pos) > keep) {
+        unsigned int dist = 0;
+        unsigned int len = find_match(c, &dist);
+
+        if (len == 0) {
+            put_bits(c, 0x100U | c->work[c->pos], 9);
+            c->pos++;
+        } else {
+            put_bits(c, 0, 1);
+            put_bits(c, dist - 1U, c->window_bits);
+            put_bits(c, len - 1U, c->lookahead_bits);
+            c->pos += len;
+        }
+    }
+}
+
+int lz_compress_init(struct lz_compressor *c, uint8_t *work,
+                     uint8_t window_bits, uint8_t lookahead_bits,
+                     uint8_t *out, size_t out_size)
+{
+    if (window_bits < LZ_COMPRESS_MIN_WINDOW_BITS ||
+        window_bits > LZ_COMPRESS_MAX_WINDOW_BITS ||
+        lookahead_bits < LZ_COMPRESS_MIN_LOOKAHEAD_BITS ||
+        lookahead_bits >= window_bits ||
+        out_size < LZ_COMPRESS_HEADER_LEN) {
+        return -EINVAL;
+    }
+
+    *c = (struct lz_compressor){
+        .work = work,
+        .out = out,
+        .out_size = out_size,
+        .out_len = LZ_COMPRESS_HEADER_LEN,
+        .window_bits = window_bits,
+        .lookahead_bits = lookahead_bits,
+    };
+
+    return 0;
+}
+
+int lz_compress_feed(struct lz_compressor *c, const void *data, size_t len)
+{
+    const uint8_t *src = data;
+    unsigned int window = 1U << c->window_bits;
+    unsigned int size = LZ_COMPRESS_WORK_SIZE(c->window_bits);
+
+    c->in_len += len;
+
+    while (len > 0 && c->error == 0) {
+        size_t take = MIN(len, (size_t)(size - c->fill));
+
+        memcpy(&c->work[c->fill], src, take);
+        c->fill += take;
+        src += take;
+        len -= take;
+
+        if (c->fill < size) {
+            break;
+        }
+
+        /* Full: encode all that has a whole lookahead, keep a window of history */
+        encode(c, (1U << c->lookahead_bits) - 1U);
+
+        unsigned int drop = c->pos - window;
+
+        memmove(c->work, &c->work[drop], c->fill - drop);
+        c->fill -= drop;
+        c->pos -= drop;
+    }
+
+    return c->error;
+}
+
+int lz_compress_sink(const char *data, size_t len, void *ctx)
+{
+    return lz_compress_feed(ctx, data, len);
+}
+
+int lz_compress_finish(struct lz_compressor *c)
+{
+    if (c->in_len > UINT16_MAX) {
+        return -EMSGSIZE;
+    }
+
+    encode(c, 0);
+    if (c->bit_count > 0) {
+        put_bits(c, 0, 8U - c->bit_count);
+    }
+
+    if (c->error != 0) {
+        return c->error;
+    }
+
+    c->out[0] = LZ_COMPRESS_VERSION;
+    c->out[1] = (uint8_t)(c->window_bits << 4 | c->lookahead_bits);
+    sys_put_le16((uint16_t)c->in_len, &c->out[2]);
+
+    return (int)c->out_len;
+}
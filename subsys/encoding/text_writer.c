@@ -0,0 +1,298 @@
+/**
+ * @file text_writer.c
+ * @brief printf-free text output for the JSON and console paths
+ */
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+#include "text_writer.h"
+
+static const char digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint32_t pow10_u32[TEXT_FIXED_MAX_DECIMALS + 1] = {
+    1U, 10U, 100U, 1000U, 10000U, 100000U,
+    1000000U, 10000000U, 100000000U, 1000000000U,
+};
+
+static int flush(struct text_writer *w)
+{
+    size_t pending = w->len - w->flushed;
+
+    if (pending > 0 && w->error == 0) {
+        w->error = w->sink(w->buf, pending, w->sink_ctx);
+    }
+    w->flushed = w->len;
+    return w->error;
+}
+
+void text_put_overflow(struct text_writer *w, const char *src, size_t len)
+{
+    if (w->sink == NULL) {
+        /* Keep what fits and just count the rest */
+        size_t pos = w->len - w->flushed;
+
+        if (pos < w->size) {
+            memcpy(w->buf + pos, src, MIN(len, w->size - pos));
+        }
+        w->len += len;
+        return;
+    }
+
+    if (w->size == 0) {
+        /* Nothing can be staged, so the sink would never make progress */
+        w->error = -EINVAL;
+        w->len += len;
+        w->flushed = w->len;
+        return;
+    }
+
+    while (len > 0) {
+        size_t pos = w->len - w->flushed;
+
+        if (pos == w->size) {
+            flush(w);
+            pos = 0;
+        }
+
+        size_t chunk = MIN(len, w->size - pos);
+
+        memcpy(w->buf + pos, src, chunk);
+        w->len += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+static void put_bytes(struct text_writer *w, const char *src, size_t len)
+{
+    size_t pos = w->len - w->flushed;
+
+    if (len <= w->size - MIN(pos, w->size)) {
+        memcpy(w->buf + pos, src, len);
+        w->len += len;
+    } else {
+        text_put_overflow(w, src, len);
+    }
+}
+
+/**
+ * @brief Write exactly @p width digits of @p value ending at @p end
+ * @return Start of the digits
+ */
+static char *digits_fixed(char *end, uint64_t value, unsigned int width)
+{
+    while (width >= 2) {
+        unsigned int pair = (unsigned int)(value % 100U) * 2U;
+
+        value /= 100U;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+        width -= 2;
+    }
+    if (width) {
+        *--end = (char)('0' + value % 10U);
+    }
+    return end;
+}
+
+/**
+ * @brief Write the decimal digits of @p value, no leading zeros, ending at @p end
+ * @return Start of the digits
+ */
+static char *digits(char *end, uint64_t value)
+{
+    while (value >= 100U) {
+        unsigned int pair = (unsigned int)(value % 100U) * 2U;
+
+        value /= 100U;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (value >= 10U) {
+        *--end = digit_pairs[value * 2U + 1];
+        *--end = digit_pairs[value * 2U];
+    } else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+}
+
+void text_put_str(struct text_writer *w, const char *str)
+{
+    put_bytes(w, str, strlen(str));
+}
+
+void text_put_uint(struct text_writer *w, uint32_t value)
+{
+    char tmp[10];
+    char *start = digits(tmp + sizeof(tmp), value);
+
+    put_bytes(w, start, (size_t)(tmp + sizeof(tmp) - start));
+}
+
+void text_put_int(struct text_writer *w, int32_t value)
+{
+    if (value < 0) {
+        text_put_char(w, '-');
+        text_put_uint(w, 0U - (uint32_t)value);
+    } else {
+        text_put_uint(w, (uint32_t)value);
+    }
+}
+
+/**
+ * @brief Integer m × 2^e for exponents past 2^63, in base 10^9 limbs
+ *
+ * Only reached for |value| >= 2^63, so it never runs for sensor data.
+ */
+static void put_big_integer(struct text_writer *w, uint32_t mant, int exp)
+{
+    uint32_t limb[5] = {mant % 1000000000U, mant / 1000000000U};
+    int used = 2;
+
+    while (exp > 0) {
+        int shift = MIN(exp, 32);
+        uint64_t carry = 0;
+
+        for (int i = 0; i < used; i++) {
+            uint64_t v = ((uint64_t)limb[i] << shift) + carry;
+
+            limb[i] = (uint32_t)(v % 1000000000U);
+            carry = v / 1000000000U;
+        }
+        while (carry) {
+            limb[used++] = (uint32_t)(carry % 1000000000U);
+            carry /= 1000000000U;
+        }
+        exp -= shift;
+    }
+
+    while (used > 1 && limb[used - 1] == 0) {
+        used--;
+    }
+
+    char tmp[45];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+
+    for (int i = 0; i < used - 1; i++) {
+        start = digits_fixed(start, limb[i], 9);
+    }
+    start = digits(start, limb[used - 1]);
+    put_bytes(w, start, (size_t)(end - start));
+}
+
+void text_put_fixed(struct text_writer *w, float value, unsigned int decimals)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    decimals = MIN(decimals, TEXT_FIXED_MAX_DECIMALS);
+
+    uint32_t biased = (bits >> 23) & 0xFFU;
+    uint32_t mant = bits & 0x7FFFFFU;
+
+    if (bits >> 31) {
+        text_put_char(w, '-');
+    }
+
+    if (biased == 0xFFU) {
+        text_put_str(w, mant ? "nan" : "inf");
+        return;
+    }
+
+    /* value = mant × 2^exp exactly */
+    int exp;
+    if (biased == 0) {
+        exp = -149;
+    } else {
+        mant |= 0x800000U;
+        exp = (int)biased - 150;
+    }
+
+    if (exp >= 0) {
+        /* Integral already: digits of mant × 2^exp, then zero decimals */
+        if (exp > 39) {
+            put_big_integer(w, mant, exp);
+        } else {
+            char tmp[20];
+            char *start = digits(tmp + sizeof(tmp), (uint64_t)mant << exp);
+
+            put_bytes(w, start, (size_t)(tmp + sizeof(tmp) - start));
+        }
+        if (decimals) {
+            static const char zeros[TEXT_FIXED_MAX_DECIMALS + 1] = ".000000000";
+
+            put_bytes(w, zeros, decimals + 1);
+        }
+        return;
+    }
+
+    /* round(mant × 10^N / 2^-exp), ties to even; mant × 10^N < 2^54 */
+    uint32_t scale = pow10_u32[decimals];
+    unsigned int shift = (unsigned int)-exp;
+    uint64_t num = (uint64_t)mant * scale;
+    uint64_t scaled;
+
+    if (shift > 55) {
+        scaled = 0;     /* num < 2^54 is below half of 2^shift */
+    } else {
+        uint64_t half = 1ULL << (shift - 1);
+        uint64_t rem = num & ((half << 1) - 1);
+
+        scaled = num >> shift;
+        if (rem > half || (rem == half && (scaled & 1U))) {
+            scaled++;
+        }
+    }
+
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+
+    if (decimals) {
+        start = digits_fixed(start, scaled % scale, decimals);
+        *--start = '.';
+    }
+    start = digits(start, scaled / scale);
+    put_bytes(w, start, (size_t)(end - start));
+}
+
+int text_finish(struct text_writer *w)
+{
+    if (w->sink != NULL) {
+        return flush(w) < 0 ? w->error : (int)w->len;
+    }
+
+    if (w->size == 0) {
+        return -ENOMEM;
+    }
+
+    if (w->len >= w->size) {
+        w->buf[w->size - 1] = '\0';
+        return -ENOMEM;
+    }
+
+    w->buf[w->len] = '\0';
+    return (int)w->len;
+}
+
+int text_format_fixed(char *buf, size_t size, float value, unsigned int decimals)
+{
+    struct text_writer w;
+
+    text_writer_init(&w, buf, size);
+    text_put_fixed(&w, value, decimals);
+    return text_finish(&w);
+}
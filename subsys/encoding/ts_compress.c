@@ -0,0 +1,170 @@
+/**
+ * @file ts_compress.c
+ * @brief Streaming bit-packed compression of compact sample series
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include "ts_compress.h"
+
+/* The 17-bit escape holds any delta of 16-bit values */
+BUILD_ASSERT(SAMPLE_VALUE_BYTES == TS_COMPRESS_VALUES * sizeof(int16_t),
+             "ts_compress only packs 16-bit sample fields");
+
+/* Bit cursor over the block after the header */
+struct bit_writer {
+    uint8_t *buf;
+    size_t limit;               /* Capacity in bits */
+    size_t bits;
+    bool overflow;
+};
+
+/* Assigns rather than ORs, so bits left by a refused sample are overwritten */
+static void put_bits(struct bit_writer *w, uint32_t value, unsigned int count)
+{
+    if (w->bits + count > w->limit) {
+        w->overflow = true;
+        return;
+    }
+
+    while (count > 0) {
+        size_t byte = w->bits >> 3;
+        unsigned int used = w->bits & 7U;
+        unsigned int take = MIN(count, 8U - used);
+        unsigned int shift = 8U - used - take;
+        uint8_t mask = (uint8_t)(((1U << take) - 1U) << shift);
+        uint8_t chunk = (uint8_t)((value >> (count - take)) << shift);
+
+        w->buf[byte] = (uint8_t)((w->buf[byte] & ~mask) | (chunk & mask));
+        w->bits += take;
+        count -= take;
+    }
+}
+
+static inline uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static void put_timestamp(struct bit_writer *w, int32_t dod)
+{
+    if (dod == 0) {
+        put_bits(w, 0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        put_bits(w, 0x2, 2);
+        put_bits(w, (uint32_t)dod & 0x7FU, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(w, 0x6, 3);
+        put_bits(w, (uint32_t)dod & 0x1FFU, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(w, 0xE, 4);
+        put_bits(w, (uint32_t)dod & 0xFFFU, 12);
+    } else {
+        put_bits(w, 0xF, 4);
+        put_bits(w, (uint32_t)dod, 32);
+    }
+}
+
+static void put_value(struct bit_writer *w, int32_t delta)
+{
+    uint32_t zz = zigzag(delta);
+
+    if (zz == 0) {
+        put_bits(w, 0x0, 1);
+    } else if (zz < 16U) {
+        put_bits(w, 0x2, 2);
+        put_bits(w, zz, 4);
+    } else if (zz < 256U) {
+        put_bits(w, 0x6, 3);
+        put_bits(w, zz, 8);
+    } else {
+        put_bits(w, 0x7, 3);
+        put_bits(w, zz, 17);
+    }
+}
+
+int ts_compress_init(struct ts_compressor *c, uint8_t *buf, size_t size)
+{
+    if (c == NULL || buf == NULL || size < TS_COMPRESS_HEADER_LEN) {
+        return -EINVAL;
+    }
+
+    *c = (struct ts_compressor){.buf = buf, .size = size};
+    return 0;
+}
+
+int ts_compress_append(struct ts_compressor *c, const sensor_sample_t *sample)
+{
+    if (c->count == UINT16_MAX) {
+        return -ENOSPC;
+    }
+
+    struct bit_writer w = {
+        .buf = c->buf + TS_COMPRESS_HEADER_LEN,
+        .limit = (c->size - TS_COMPRESS_HEADER_LEN) * 8U,
+        .bits = c->bits,
+    };
+    int32_t wide[TS_COMPRESS_VALUES];
+    int16_t values[TS_COMPRESS_VALUES];
+    int32_t dt = 0;
+
+    sample_schema_values(sample, wide);
+    for (int i = 0; i < TS_COMPRESS_VALUES; i++) {
+        values[i] = (int16_t)wide[i];
+    }
+
+    if (c->count > 0) {
+        dt = (int32_t)(sample->timestamp_ms - c->prev_ts);
+        put_timestamp(&w, (int32_t)((uint32_t)dt - (uint32_t)c->prev_dt));
+    }
+
+    if (sample->valid_mask == c->prev_mask) {
+        put_bits(&w, 0x0, 1);
+    } else {
+        put_bits(&w, 0x1, 1);
+        put_bits(&w, sample->valid_mask, 8);
+    }
+
+    for (int i = 0; i < TS_COMPRESS_VALUES; i++) {
+        put_value(&w, (int32_t)values[i] - c->prev[i]);
+    }
+
+    if (w.overflow) {
+        return -ENOSPC;
+    }
+
+    /* Commit only once the whole sample fitted */
+    c->bits = w.bits;
+    c->prev_dt = dt;
+    c->prev_ts = sample->timestamp_ms;
+    c->prev_mask = sample->valid_mask;
+    for (int i = 0; i < TS_COMPRESS_VALUES; i++) {
+        c->prev[i] = values[i];
+    }
+    if (c->count++ == 0) {
+        sys_put_le32(sample->timestamp_ms, &c->buf[3]);
+    }
+
+    return 0;
+}
+
+size_t ts_compress_finish(struct ts_compressor *c)
+{
+    c->buf[0] = TS_COMPRESS_VERSION;
+    sys_put_le16(c->count, &c->buf[1]);
+    if (c->count == 0) {
+        sys_put_le32(0, &c->buf[3]);
+    }
+
+    size_t len = TS_COMPRESS_HEADER_LEN + (c->bits + 7U) / 8U;
+
+    /* Zero the padding bits of the last byte */
+    if (c->bits & 7U) {
+        uint8_t *last = &c->buf[len - 1];
+
+        *last &= (uint8_t)(0xFFU << (8U - (c->bits & 7U)));
+    }
+
+    return len;
+}
@@ -0,0 +1,270 @@
+/**
+ * @file sensor_pipeline.c
+ * @brief Fixed-point calibration, low-pass and decimation per sensor channel
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <math.h>
+#include <string.h>
+#include "sensor_pipeline.h"
+#include "sensor_drivers.h"
+
+#ifdef CONFIG_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
+
+LOG_MODULE_REGISTER(sensor_pipeline, LOG_LEVEL_INF);
+
+/* Biquad coefficients in Q30, a0 normalised to 1 */
+#define BIQUAD_SHIFT 30
+
+struct biquad {
+    int32_t b0, b1, b2;
+    int32_t a1, a2;
+};
+
+/* Build-time shape of one channel's chain */
+struct channel_config {
+    uint16_t cutoff_permille;   /* Of the channel sample rate, 0 = no filter */
+    uint16_t decimation;
+    int32_t nominal_gain_q15;
+};
+
+/* Runtime state of one channel's chain */
+struct channel_state {
+    struct biquad coeff;
+    bool filtered;
+    bool primed;
+    int32_t x1, x2;             /* Inputs, PIPELINE_FRAC_BITS fractional bits */
+    int32_t y1, y2;             /* Outputs, same format */
+    uint16_t phase;
+};
+
+#define ACCEL_CONFIG {                                          \
+    .cutoff_permille = CONFIG_APP_PIPELINE_ACCEL_CUTOFF_PERMILLE, \
+    .decimation = CONFIG_APP_PIPELINE_ACCEL_DECIMATION,         \
+    .nominal_gain_q15 = SPI_ACCEL_SENSOR_MG_PER_LSB_Q15,        \
+}
+
+static const struct channel_config channel_config[PIPELINE_CHANNEL_COUNT] = {
+    [PIPELINE_CHANNEL_TEMP] = {
+        .cutoff_permille = CONFIG_APP_PIPELINE_TEMP_CUTOFF_PERMILLE,
+        .decimation = CONFIG_APP_PIPELINE_TEMP_DECIMATION,
+        .nominal_gain_q15 = I2C_TEMP_SENSOR_CC_PER_LSB_Q15,
+    },
+    [PIPELINE_CHANNEL_ACCEL_X] = ACCEL_CONFIG,
+    [PIPELINE_CHANNEL_ACCEL_Y] = ACCEL_CONFIG,
+    [PIPELINE_CHANNEL_ACCEL_Z] = ACCEL_CONFIG,
+    [PIPELINE_CHANNEL_BATTERY] = {
+        .cutoff_permille = CONFIG_APP_PIPELINE_BATTERY_CUTOFF_PERMILLE,
+        .decimation = CONFIG_APP_PIPELINE_BATTERY_DECIMATION,
+        .nominal_gain_q15 = PIPELINE_GAIN_ONE,   /* ADC driver already reports mV */
+    },
+};
+
+static struct channel_state channel_state[PIPELINE_CHANNEL_COUNT];
+static struct pipeline_calibration calibration[PIPELINE_CHANNEL_COUNT];
+static struct k_spinlock calibration_lock;
+
+static inline int16_t clamp_i16(int64_t value)
+{
+    return (int16_t)CLAMP(value, INT16_MIN, INT16_MAX);
+}
+
+/**
+ * @brief Second-order Butterworth low-pass (RBJ cookbook) in Q30
+ *
+ * Float math, but only at init.
+ */
+static void biquad_lowpass(struct biquad *bq, uint16_t cutoff_permille)
+{
+    float w0 = 2.0f * 3.14159265f * (float)cutoff_permille / 1000.0f;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    float a0 = 1.0f + alpha;
+    float scale = (float)(1 << BIQUAD_SHIFT) / a0;
+
+    bq->b0 = (int32_t)lroundf((1.0f - cos_w0) * 0.5f * scale);
+    bq->b1 = (int32_t)lroundf((1.0f - cos_w0) * scale);
+    bq->b2 = bq->b0;
+    bq->a1 = (int32_t)lroundf(-2.0f * cos_w0 * scale);
+    bq->a2 = (int32_t)lroundf((1.0f - alpha) * scale);
+}
+
+static int32_t biquad_step(struct channel_state *st, int32_t x0)
+{
+    const struct biquad *bq = &st->coeff;
+
+    if (!st->primed) {
+        /* Start from steady state at the first input, not from zero */
+        st->x1 = st->x2 = st->y1 = st->y2 = x0;
+        st->primed = true;
+    }
+
+    int64_t acc = (int64_t)bq->b0 * x0 + (int64_t)bq->b1 * st->x1 + (int64_t)bq->b2 * st->x2 -
+                  (int64_t)bq->a1 * st->y1 - (int64_t)bq->a2 * st->y2;
+    int32_t y0 = (int32_t)((acc + (1LL << (BIQUAD_SHIFT - 1))) >> BIQUAD_SHIFT);
+
+    st->x2 = st->x1;
+    st->x1 = x0;
+    st->y2 = st->y1;
+    st->y1 = y0;
+    return y0;
+}
+
+bool sensor_pipeline_process(pipeline_channel_t channel, int32_t raw, int16_t *out)
+{
+    struct channel_state *st = &channel_state[channel];
+
+    k_spinlock_key_t key = k_spin_lock(&calibration_lock);
+    struct pipeline_calibration cal = calibration[channel];
+    k_spin_unlock(&calibration_lock, key);
+
+    int64_t scaled = ((int64_t)(raw - cal.offset) * cal.gain_q15 + (1 << 14)) >> 15;
+    int16_t value = clamp_i16(scaled);
+
+    if (st->filtered) {
+        int32_t y = biquad_step(st, (int32_t)value << PIPELINE_FRAC_BITS);
+        value = clamp_i16((y + (1 << (PIPELINE_FRAC_BITS - 1))) >> PIPELINE_FRAC_BITS);
+    }
+
+    if (++st->phase < channel_config[channel].decimation) {
+        return false;
+    }
+
+    st->phase = 0;
+    *out = value;
+    return true;
+}
+
+void sensor_pipeline_reset(pipeline_channel_t channel)
+{
+    if (channel >= PIPELINE_CHANNEL_COUNT) {
+        return;
+    }
+
+    channel_state[channel].primed = false;
+    channel_state[channel].phase = 0;
+}
+
+#ifdef CONFIG_SETTINGS
+static int pipeline_settings_set(const char *name, size_t len,
+                                 settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+
+    if (!settings_name_steq(name, "cal", &next) || next != NULL) {
+        return -ENOENT;
+    }
+
+    if (len != sizeof(calibration)) {
+        LOG_WRN("Ignoring stored calibration of %u bytes", (unsigned int)len);
+        return -EINVAL;
+    }
+
+    struct pipeline_calibration stored[PIPELINE_CHANNEL_COUNT];
+    ssize_t ret = read_cb(cb_arg, stored, sizeof(stored));
+    if (ret < 0) {
+        return (int)ret;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&calibration_lock);
+    memcpy(calibration, stored, sizeof(calibration));
+    k_spin_unlock(&calibration_lock, key);
+
+    LOG_INF("Loaded stored calibration");
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(sensor_pipeline, "pipeline", NULL,
+                               pipeline_settings_set, NULL, NULL);
+#endif
+
+/**
+ * @brief Store the whole calibration table as one settings record
+ */
+static int calibration_save(void)
+{
+#ifdef CONFIG_SETTINGS
+    struct pipeline_calibration snapshot[PIPELINE_CHANNEL_COUNT];
+
+    k_spinlock_key_t key = k_spin_lock(&calibration_lock);
+    memcpy(snapshot, calibration, sizeof(snapshot));
+    k_spin_unlock(&calibration_lock, key);
+
+    int ret = settings_save_one("pipeline/cal", snapshot, sizeof(snapshot));
+    if (ret != 0) {
+        LOG_ERR("Failed to store calibration: %d", ret);
+        return ret;
+    }
+#endif
+    return 0;
+}
+
+int sensor_pipeline_init(void)
+{
+    for (int ch = 0; ch < PIPELINE_CHANNEL_COUNT; ch++) {
+        const struct channel_config *cfg = &channel_config[ch];
+        struct channel_state *st = &channel_state[ch];
+
+        *st = (struct channel_state){0};
+        st->filtered = (cfg->cutoff_permille != 0);
+        if (st->filtered) {
+            biquad_lowpass(&st->coeff, cfg->cutoff_permille);
+        }
+
+        calibration[ch].offset = 0;
+        calibration[ch].gain_q15 = cfg->nominal_gain_q15;
+    }
+
+#ifdef CONFIG_SETTINGS
+    int ret = settings_subsys_init();
+    if (ret == 0) {
+        ret = settings_load_subtree("pipeline");
+    }
+    if (ret != 0) {
+        LOG_WRN("Calibration storage unavailable, using nominal scale: %d", ret);
+    }
+#endif
+
+    LOG_INF("Sensor pipeline ready (cutoff/decimation T %u/%u, A %u/%u, B %u/%u)",
+            channel_config[PIPELINE_CHANNEL_TEMP].cutoff_permille,
+            channel_config[PIPELINE_CHANNEL_TEMP].decimation,
+            channel_config[PIPELINE_CHANNEL_ACCEL_X].cutoff_permille,
+            channel_config[PIPELINE_CHANNEL_ACCEL_X].decimation,
+            channel_config[PIPELINE_CHANNEL_BATTERY].cutoff_permille,
+            channel_config[PIPELINE_CHANNEL_BATTERY].decimation);
+    return 0;
+}
+
+int sensor_pipeline_set_calibration(pipeline_channel_t channel,
+                                    const struct pipeline_calibration *cal)
+{
+    if (channel >= PIPELINE_CHANNEL_COUNT || cal == NULL) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&calibration_lock);
+    calibration[channel] = *cal;
+    k_spin_unlock(&calibration_lock, key);
+
+    LOG_INF("Channel %d calibration: offset %d, gain %d/32768",
+            channel, cal->offset, cal->gain_q15);
+
+    return calibration_save();
+}
+
+int sensor_pipeline_get_calibration(pipeline_channel_t channel,
+                                    struct pipeline_calibration *cal)
+{
+    if (channel >= PIPELINE_CHANNEL_COUNT || cal == NULL) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&calibration_lock);
+    *cal = calibration[channel];
+    k_spin_unlock(&calibration_lock, key);
+
+    return 0;
+}
@@ -6,12 +6,81 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/random/random.h>
+#include "sensor_drivers.h"
+
+#ifdef USE_REAL_ADC_BATTERY
+#ifndef CONFIG_ADC
+#error "USE_REAL_ADC_BATTERY needs CONFIG_ADC=y (and CONFIG_ADC_ASYNC=y for non-blocking reads)"
+#endif
+#include <zephyr/drivers/adc.h>
+#endif
 
 LOG_MODULE_REGISTER(adc_battery, LOG_LEVEL_DBG);
 
+/* Asynchronous read state, one conversion in flight at a time */
+static atomic_t async_busy;
+static uint16_t *async_mv;
+static sensor_read_cb_t async_cb;
+static void *async_user_data;
+
+#ifdef USE_REAL_ADC_BATTERY
+/* VBAT is measured through a 1:2 divider on the zephyr,user io-channel */
+#define BATTERY_DIVIDER_RATIO 2
+
+static const struct adc_dt_spec batt_adc = ADC_DT_SPEC_GET(DT_PATH(zephyr_user));
+static int16_t adc_sample;
+
+static enum adc_action adc_sampling_done(const struct device *dev,
+                                         const struct adc_sequence *sequence,
+                                         uint16_t sampling_index);
+
+static const struct adc_sequence_options adc_async_options = {
+    .callback = adc_sampling_done,
+};
+
+static struct adc_sequence adc_seq = {
+    .buffer = &adc_sample,
+    .buffer_size = sizeof(adc_sample),
+};
+
+/**
+ * @brief Convert the last ADC sample to battery millivolts
+ */
+static int adc_sample_to_mv(uint16_t *millivolts)
+{
+    int32_t mv = adc_sample;
+
+    int ret = adc_raw_to_millivolts_dt(&batt_adc, &mv);
+    if (ret < 0) {
+        return ret;
+    }
+
+    *millivolts = (uint16_t)(mv * BATTERY_DIVIDER_RATIO);
+    return 0;
+}
+#endif
+
 int adc_battery_init(void)
 {
+#ifdef USE_REAL_ADC_BATTERY
+    if (!adc_is_ready_dt(&batt_adc)) {
+        LOG_ERR("ADC device not ready");
+        return -ENODEV;
+    }
+
+    int ret = adc_channel_setup_dt(&batt_adc);
+    if (ret == 0) {
+        ret = adc_sequence_init_dt(&batt_adc, &adc_seq);
+    }
+    if (ret < 0) {
+        LOG_ERR("ADC channel setup failed: %d", ret);
+        return ret;
+    }
+
+    LOG_INF("ADC battery sensor initialized");
+#else
     LOG_INF("ADC battery sensor initialized (stub mode)");
+#endif
     return 0;
 }
 
@@ -20,10 +89,103 @@ int adc_battery_read(float *voltage_v)
     if (!voltage_v) {
         return -EINVAL;
     }
-    
+
+#ifdef USE_REAL_ADC_BATTERY
+    uint16_t mv;
+
+    adc_seq.options = NULL;
+    int ret = adc_read_dt(&batt_adc, &adc_seq);
+    if (ret == 0) {
+        ret = adc_sample_to_mv(&mv);
+    }
+    if (ret < 0) {
+        LOG_ERR("ADC read failed: %d", ret);
+        return ret;
+    }
+
+    *voltage_v = adc_battery_mv_to_volts(mv);
+#else
     /* Generate simulated voltage between 3.3V and 4.2V */
-    *voltage_v = 3.3f + ((float)(sys_rand32_get() % 90) / 100.0f);
-    LOG_DBG("Battery voltage (stub): %.2fV", (double)*voltage_v);
-    
+    uint32_t centi = 330U + sys_rand32_get() % 90U;
+
+    *voltage_v = (float)centi / 100.0f;
+    LOG_DBG("Battery voltage (stub): %u.%02uV", centi / 100U, centi % 100U);
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief Finish an asynchronous read and hand the result to the caller
+ */
+static void async_complete(int result, uint16_t millivolts)
+{
+    sensor_read_cb_t cb = async_cb;
+    void *user_data = async_user_data;
+
+    if (result == 0) {
+        *async_mv = millivolts;
+    }
+
+    atomic_clear(&async_busy);
+    cb(result, user_data);
+}
+
+#ifdef USE_REAL_ADC_BATTERY
+static enum adc_action adc_sampling_done(const struct device *dev,
+                                         const struct adc_sequence *sequence,
+                                         uint16_t sampling_index)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(sequence);
+    ARG_UNUSED(sampling_index);
+
+    uint16_t mv = 0;
+    int ret = adc_sample_to_mv(&mv);
+
+    async_complete(ret, mv);
+    return ADC_ACTION_FINISH;
+}
+#endif
+
+int adc_battery_read_async(uint16_t *millivolts, sensor_read_cb_t cb, void *user_data)
+{
+    if (millivolts == NULL || cb == NULL) {
+        return -EINVAL;
+    }
+
+    if (!atomic_cas(&async_busy, 0, 1)) {
+        return -EBUSY;
+    }
+
+    async_mv = millivolts;
+    async_cb = cb;
+    async_user_data = user_data;
+
+#ifdef USE_REAL_ADC_BATTERY
+    adc_seq.options = &adc_async_options;
+#ifdef CONFIG_ADC_ASYNC
+    int ret = adc_read_async(batt_adc.dev, &adc_seq, NULL);
+#else
+    int ret = -ENOTSUP;
+#endif
+    if (ret == -ENOTSUP) {
+        /* No async API: the blocking read still runs the callback */
+        ret = adc_read_dt(&batt_adc, &adc_seq);
+        if (ret < 0) {
+            async_complete(ret, 0);
+        }
+        return 0;
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to start ADC conversion: %d", ret);
+        atomic_clear(&async_busy);
+        return ret;
+    }
+#else
+    /* STUB: 3300..4190 mV, completes immediately */
+    async_complete(0, (uint16_t)(3300 + (sys_rand32_get() % 90) * 10));
+#endif
+
     return 0;
 }
@@ -1,7 +1,7 @@
 /**
  * @file i2c_temp_sensor.c
  * @brief I²C temperature sensor driver (stub for generic I²C temp sensor)
- * 
+ *
  * This is a stub implementation. Replace with actual sensor driver
  * (e.g., TMP117, BME280, SHT3x, etc.)
  */
@@ -9,6 +9,7 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
+#include "sensor_drivers.h"
 
 LOG_MODULE_REGISTER(i2c_temp, LOG_LEVEL_DBG);
 
@@ -17,20 +18,36 @@ LOG_MODULE_REGISTER(i2c_temp, LOG_LEVEL_DBG);
 
 /* Example address */
 #define TEMP_SENSOR_ADDR 0x48
+#define TEMP_SENSOR_REG_TEMP 0x00
 
 #define CONFIG_I2C_TEMP_SENSOR_STUB 1
 
 static const struct device *i2c_dev;
 
+/* Asynchronous read state, one transfer in flight at a time */
+static atomic_t async_busy;
+static int16_t *async_raw;
+static sensor_read_cb_t async_cb;
+static void *async_user_data;
+
+#if !defined(CONFIG_I2C_TEMP_SENSOR_STUB)
+static uint8_t async_reg = TEMP_SENSOR_REG_TEMP;
+static uint8_t async_buf[2];
+static struct i2c_msg async_msgs[2] = {
+    {.buf = &async_reg, .len = 1, .flags = I2C_MSG_WRITE},
+    {.buf = async_buf, .len = sizeof(async_buf), .flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP},
+};
+#endif
+
 
 static uint32_t local_rand32(void)
 {
     static uint32_t seed = 0;
-    
+
     if (seed == 0) {
         seed = k_uptime_get_32() + 1;
     }
-    
+
     seed = (1103515245 * seed + 12345) & 0x7FFFFFFF;
     return seed;
 }
@@ -70,14 +87,16 @@ int i2c_temp_sensor_read(float *temp_c)
 
 #if defined(CONFIG_I2C_TEMP_SENSOR_STUB)
     /* STUB: Generate simulated temperature */
-    *temp_c = 20.0f + (float)(local_rand32() % 1000) / 100.0f;
-    LOG_DBG("Temperature (stub): %.2f°C", (double)*temp_c);
+    uint32_t centi = 2000U + local_rand32() % 1000U;
+
+    *temp_c = (float)centi / 100.0f;
+    LOG_DBG("Temperature (stub): %u.%02u°C", centi / 100U, centi % 100U);
     return 0;
 
 #else
     uint8_t data[2];
 
-    int ret = i2c_burst_read(i2c_dev, TEMP_SENSOR_ADDR, 0x00, data, sizeof(data));
+    int ret = i2c_burst_read(i2c_dev, TEMP_SENSOR_ADDR, TEMP_SENSOR_REG_TEMP, data, sizeof(data));
     if (ret != 0) {
         LOG_ERR("Failed to read from I²C sensor: %d", ret);
         return ret;
@@ -85,8 +104,72 @@ int i2c_temp_sensor_read(float *temp_c)
 
     /* Convert raw data (example conversion) */
     int16_t raw = (data[0] << 8) | data[1];
-    *temp_c = (float)raw * 0.0078125f;
+    *temp_c = i2c_temp_sensor_raw_to_celsius(raw);
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Finish an asynchronous read and hand the result to the caller
+ */
+static void async_complete(int result, int16_t raw)
+{
+    sensor_read_cb_t cb = async_cb;
+    void *user_data = async_user_data;
+
+    if (result == 0) {
+        *async_raw = raw;
+    }
+
+    atomic_clear(&async_busy);
+    cb(result, user_data);
+}
+
+#if !defined(CONFIG_I2C_TEMP_SENSOR_STUB)
+static void i2c_transfer_done(const struct device *dev, int result, void *data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(data);
+
+    async_complete(result, (int16_t)((async_buf[0] << 8) | async_buf[1]));
+}
+#endif
+
+int i2c_temp_sensor_read_async(int16_t *raw, sensor_read_cb_t cb, void *user_data)
+{
+    if (raw == NULL || cb == NULL) {
+        return -EINVAL;
+    }
+
+    if (!atomic_cas(&async_busy, 0, 1)) {
+        return -EBUSY;
+    }
+
+    async_raw = raw;
+    async_cb = cb;
+    async_user_data = user_data;
+
+#if defined(CONFIG_I2C_TEMP_SENSOR_STUB)
+    /* STUB: 20.00..29.99 °C in 1/128 °C counts, completes immediately */
+    async_complete(0, (int16_t)(2560 + (local_rand32() % 1280)));
+    return 0;
+
+#else
+    int ret = i2c_transfer_cb(i2c_dev, async_msgs, ARRAY_SIZE(async_msgs),
+                              TEMP_SENSOR_ADDR, i2c_transfer_done, NULL);
+    if (ret == -ENOSYS) {
+        /* Controller has no callback API: fall back to a blocking transfer */
+        ret = i2c_transfer(i2c_dev, async_msgs, ARRAY_SIZE(async_msgs), TEMP_SENSOR_ADDR);
+        i2c_transfer_done(i2c_dev, ret, NULL);
+        return 0;
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to start I²C transfer: %d", ret);
+        atomic_clear(&async_busy);
+        return ret;
+    }
 
     return 0;
 #endif
-}
\ No newline at end of file
+}
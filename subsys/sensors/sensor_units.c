@@ -0,0 +1,46 @@
+/**
+ * @file sensor_units.c
+ * @brief Raw register value to unit conversions of the sensor drivers
+ *
+ * Kept apart from the drivers so code that only converts (the vibration
+ * analysis, the benchmarks) links without the devicetree sensor nodes.
+ */
+
+#include <stdint.h>
+#include "sensor_drivers.h"
+
+/* Temperature register LSB: 1/128 °C */
+#define TEMP_SENSOR_C_PER_LSB 0.0078125f
+
+/* ADXL345 full-resolution scale factor: 3.9 mg/LSB */
+#define ADXL345_MS2_PER_LSB      (0.0039f * 9.81f)
+#define ADXL345_DECI_MG_PER_LSB  39
+
+float i2c_temp_sensor_raw_to_celsius(int16_t raw)
+{
+    return (float)raw * TEMP_SENSOR_C_PER_LSB;
+}
+
+int16_t i2c_temp_sensor_raw_to_cc(int16_t raw)
+{
+    /* 1/128 °C per LSB = 25/32 centi-degree, rounded to nearest */
+    int32_t scaled = (int32_t)raw * 25;
+    return (int16_t)((scaled + (scaled >= 0 ? 16 : -16)) / 32);
+}
+
+float spi_accel_sensor_raw_to_ms2(int16_t raw)
+{
+    return (float)raw * ADXL345_MS2_PER_LSB;
+}
+
+int16_t spi_accel_sensor_raw_to_mg(int16_t raw)
+{
+    /* 3.9 mg per LSB, rounded to nearest */
+    int32_t scaled = (int32_t)raw * ADXL345_DECI_MG_PER_LSB;
+    return (int16_t)((scaled + (scaled >= 0 ? 5 : -5)) / 10);
+}
+
+float adc_battery_mv_to_volts(uint16_t millivolts)
+{
+    return (float)millivolts / 1000.0f;
+}
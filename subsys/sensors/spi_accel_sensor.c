@@ -1,7 +1,7 @@
 /**
  * @file spi_accel_sensor.c
  * @brief SPI accelerometer sensor driver (stub for generic SPI accelerometer)
- * 
+ *
  * This is a stub implementation. Replace with actual sensor driver
  * (e.g., ADXL345, MPU6050 with SPI, LIS3DH, etc.)
  */
@@ -11,6 +11,9 @@
 #include <zephyr/drivers/spi.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/random/random.h>  // Pour sys_rand32_get()
+#include <zephyr/sys/byteorder.h>
+#include <math.h>
+#include "sensor_drivers.h"
 
 LOG_MODULE_REGISTER(spi_accel, LOG_LEVEL_DBG);
 
@@ -21,6 +24,24 @@ LOG_MODULE_REGISTER(spi_accel, LOG_LEVEL_DBG);
 #error "spi-accel alias not defined or device disabled in Devicetree"
 #endif
 
+/* ADXL345 register map */
+#define ADXL345_REG_BW_RATE      0x2C
+#define ADXL345_REG_POWER_CTL    0x2D
+#define ADXL345_REG_DATA_FORMAT  0x31
+#define ADXL345_REG_DATAX0       0x32
+#define ADXL345_REG_FIFO_CTL     0x38
+#define ADXL345_REG_FIFO_STATUS  0x39
+
+#define ADXL345_SPI_READ         0x80
+#define ADXL345_SPI_MULTIBYTE    0x40
+
+#define ADXL345_POWER_MEASURE    0x08
+#define ADXL345_FORMAT_FULL_RES  0x08
+#define ADXL345_FIFO_BYPASS      0x00
+#define ADXL345_FIFO_STREAM      0x80
+#define ADXL345_FIFO_ENTRIES     0x3F
+#define ADXL345_RATE_3200HZ      0x0F
+
 static const struct device *spi_dev;
 
 static struct spi_config spi_cfg = {
@@ -31,6 +52,80 @@ static struct spi_config spi_cfg = {
     .slave = 0,
 };
 
+/* Stream mode state */
+static bool stream_enabled;
+static uint16_t stream_odr_hz;
+
+/* Asynchronous read state, one transfer in flight at a time */
+static atomic_t async_busy;
+static struct accel_raw_frame *async_frame;
+static sensor_read_cb_t async_cb;
+static void *async_user_data;
+
+#ifdef USE_REAL_SPI_SENSOR
+static uint8_t async_cmd = ADXL345_SPI_READ | ADXL345_SPI_MULTIBYTE | ADXL345_REG_DATAX0;
+static uint8_t async_rx[6];
+static const struct spi_buf async_tx_buf = {.buf = &async_cmd, .len = 1};
+static const struct spi_buf async_rx_bufs[2] = {
+    {.buf = NULL, .len = 1},
+    {.buf = async_rx, .len = sizeof(async_rx)},
+};
+static const struct spi_buf_set async_tx_set = {.buffers = &async_tx_buf, .count = 1};
+static const struct spi_buf_set async_rx_set = {.buffers = async_rx_bufs, .count = 2};
+#endif
+
+#ifndef USE_REAL_SPI_SENSOR
+/* Simulated FIFO: frames produced since stream start vs. frames drained */
+static int64_t stub_stream_start_ms;
+static uint32_t stub_frames_consumed;
+#endif
+
+/**
+ * @brief Write a single ADXL345 register
+ */
+static int adxl345_write_reg(uint8_t reg, uint8_t value)
+{
+#ifndef USE_REAL_SPI_SENSOR
+    ARG_UNUSED(reg);
+    ARG_UNUSED(value);
+    return 0;
+#else
+    uint8_t tx_buf[2] = {reg, value};
+
+    const struct spi_buf tx = {.buf = tx_buf, .len = sizeof(tx_buf)};
+    const struct spi_buf_set tx_set = {.buffers = &tx, .count = 1};
+
+    return spi_write(spi_dev, &spi_cfg, &tx_set);
+#endif
+}
+
+#ifdef USE_REAL_SPI_SENSOR
+/**
+ * @brief Read consecutive ADXL345 registers in one transaction
+ *
+ * Reading the six data registers in one transaction pops exactly one
+ * FIFO entry when the part is in stream mode.
+ */
+static int adxl345_read_regs(uint8_t reg, uint8_t *data, size_t len)
+{
+    uint8_t cmd = ADXL345_SPI_READ | reg;
+
+    if (len > 1) {
+        cmd |= ADXL345_SPI_MULTIBYTE;
+    }
+
+    const struct spi_buf tx = {.buf = &cmd, .len = 1};
+    const struct spi_buf rx[2] = {
+        {.buf = NULL, .len = 1},        /* Skip byte clocked in with the command */
+        {.buf = data, .len = len},
+    };
+    const struct spi_buf_set tx_set = {.buffers = &tx, .count = 1};
+    const struct spi_buf_set rx_set = {.buffers = rx, .count = 2};
+
+    return spi_transceive(spi_dev, &spi_cfg, &tx_set, &rx_set);
+}
+#endif
+
 /**
  * @brief Initialize SPI accelerometer sensor
  */
@@ -43,6 +138,16 @@ int spi_accel_sensor_init(void)
         return -ENODEV;
     }
 
+    /* Full resolution, then start measuring */
+    int ret = adxl345_write_reg(ADXL345_REG_DATA_FORMAT, ADXL345_FORMAT_FULL_RES);
+    if (ret == 0) {
+        ret = adxl345_write_reg(ADXL345_REG_POWER_CTL, ADXL345_POWER_MEASURE);
+    }
+    if (ret < 0) {
+        LOG_ERR("Accelerometer configuration failed: %d", ret);
+        return ret;
+    }
+
     LOG_INF("SPI accelerometer sensor initialized");
     return 0;
 }
@@ -58,38 +163,232 @@ int spi_accel_sensor_read(float *accel_x, float *accel_y, float *accel_z)
 
 #ifndef USE_REAL_SPI_SENSOR
     /* STUB simulation */
-    *accel_x = ((float)(sys_rand32_get() % 200) - 100) / 100.0f;
-    *accel_y = ((float)(sys_rand32_get() % 200) - 100) / 100.0f;
-    *accel_z = 9.81f + ((float)(sys_rand32_get() % 100) - 50) / 100.0f;
+    /* Hundredths of m/s² */
+    int32_t x = (int32_t)(sys_rand32_get() % 200) - 100;
+    int32_t y = (int32_t)(sys_rand32_get() % 200) - 100;
+    int32_t z = 981 + (int32_t)(sys_rand32_get() % 100) - 50;
 
-    LOG_DBG("Accel (stub): X=%.2f Y=%.2f Z=%.2f m/s²",
-            (double)*accel_x, (double)*accel_y, (double)*accel_z);
+    *accel_x = (float)x / 100.0f;
+    *accel_y = (float)y / 100.0f;
+    *accel_z = (float)z / 100.0f;
+
+    LOG_DBG("Accel (stub): X=%d Y=%d Z=%d cm/s²", x, y, z);
     return 0;
 
 #else
     /* REAL SPI SENSOR example (ADXL345-like) */
-    uint8_t tx_buf[7] = {0x80 | 0x32, 0, 0, 0, 0, 0, 0};
-    uint8_t rx_buf[7] = {0};
-
-    const struct spi_buf tx = {.buf = tx_buf, .len = sizeof(tx_buf)};
-    const struct spi_buf rx = {.buf = rx_buf, .len = sizeof(rx_buf)};
-    const struct spi_buf_set tx_set = {.buffers = &tx, .count = 1};
-    const struct spi_buf_set rx_set = {.buffers = &rx, .count = 1};
+    uint8_t rx_buf[6] = {0};
 
-    int ret = spi_transceive(spi_dev, &spi_cfg, &tx_set, &rx_set);
+    int ret = adxl345_read_regs(ADXL345_REG_DATAX0, rx_buf, sizeof(rx_buf));
     if (ret < 0) {
         LOG_ERR("SPI read failed: %d", ret);
         return ret;
     }
 
-    int16_t raw_x = (rx_buf[2] << 8) | rx_buf[1];
-    int16_t raw_y = (rx_buf[4] << 8) | rx_buf[3];
-    int16_t raw_z = (rx_buf[6] << 8) | rx_buf[5];
+    *accel_x = spi_accel_sensor_raw_to_ms2((int16_t)sys_get_le16(&rx_buf[0]));
+    *accel_y = spi_accel_sensor_raw_to_ms2((int16_t)sys_get_le16(&rx_buf[2]));
+    *accel_z = spi_accel_sensor_raw_to_ms2((int16_t)sys_get_le16(&rx_buf[4]));
 
-    *accel_x = raw_x * 0.0039f * 9.81f;
-    *accel_y = raw_y * 0.0039f * 9.81f;
-    *accel_z = raw_z * 0.0039f * 9.81f;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Finish an asynchronous read and hand the result to the caller
+ */
+static void async_complete(int result, const struct accel_raw_frame *frame)
+{
+    sensor_read_cb_t cb = async_cb;
+    void *user_data = async_user_data;
+
+    if (result == 0) {
+        *async_frame = *frame;
+    }
+
+    atomic_clear(&async_busy);
+    cb(result, user_data);
+}
+
+#ifdef USE_REAL_SPI_SENSOR
+static void spi_transfer_done(const struct device *dev, int result, void *data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(data);
+
+    const struct accel_raw_frame frame = {
+        .x = (int16_t)sys_get_le16(&async_rx[0]),
+        .y = (int16_t)sys_get_le16(&async_rx[2]),
+        .z = (int16_t)sys_get_le16(&async_rx[4]),
+    };
+
+    async_complete(result, &frame);
+}
+#endif
+
+int spi_accel_sensor_read_async(struct accel_raw_frame *frame,
+                                sensor_read_cb_t cb, void *user_data)
+{
+    if (frame == NULL || cb == NULL) {
+        return -EINVAL;
+    }
+
+    if (!atomic_cas(&async_busy, 0, 1)) {
+        return -EBUSY;
+    }
+
+    async_frame = frame;
+    async_cb = cb;
+    async_user_data = user_data;
+
+#ifndef USE_REAL_SPI_SENSOR
+    /* STUB: ±1 m/s² on X/Y, 1 g ± 0.5 m/s² on Z, completes immediately */
+    const struct accel_raw_frame stub = {
+        .x = (int16_t)(sys_rand32_get() % 52) - 26,
+        .y = (int16_t)(sys_rand32_get() % 52) - 26,
+        .z = 256 + (int16_t)(sys_rand32_get() % 26) - 13,
+    };
 
+    async_complete(0, &stub);
     return 0;
+
+#else
+    int ret = spi_transceive_cb(spi_dev, &spi_cfg, &async_tx_set, &async_rx_set,
+                                spi_transfer_done, NULL);
+    if (ret == -ENOTSUP) {
+        /* Controller has no async API: fall back to a blocking transfer */
+        ret = spi_transceive(spi_dev, &spi_cfg, &async_tx_set, &async_rx_set);
+        spi_transfer_done(spi_dev, ret, NULL);
+        return 0;
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to start SPI transfer: %d", ret);
+        atomic_clear(&async_busy);
+        return ret;
+    }
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Map an output data rate to the ADXL345 BW_RATE code
+ * @return Rate code, or -EINVAL for unsupported rates
+ */
+static int adxl345_rate_code(uint16_t odr_hz)
+{
+    /* Codes 0x08..0x0F are 25 Hz..3200 Hz, doubling at each step */
+    for (int code = ADXL345_RATE_3200HZ; code >= 0x08; code--) {
+        if ((3200U >> (ADXL345_RATE_3200HZ - code)) == odr_hz) {
+            return code;
+        }
+    }
+
+    return -EINVAL;
+}
+
+int spi_accel_sensor_stream_start(uint16_t odr_hz, uint8_t watermark)
+{
+    int rate = adxl345_rate_code(odr_hz);
+
+    if (rate < 0 || watermark == 0 || watermark >= ACCEL_FIFO_DEPTH) {
+        return -EINVAL;
+    }
+
+    int ret = adxl345_write_reg(ADXL345_REG_BW_RATE, (uint8_t)rate);
+    if (ret == 0) {
+        ret = adxl345_write_reg(ADXL345_REG_FIFO_CTL,
+                                ADXL345_FIFO_STREAM | watermark);
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to enable FIFO stream: %d", ret);
+        return ret;
+    }
+
+#ifndef USE_REAL_SPI_SENSOR
+    stub_stream_start_ms = k_uptime_get();
+    stub_frames_consumed = 0;
+#endif
+
+    stream_odr_hz = odr_hz;
+    stream_enabled = true;
+
+    LOG_INF("Accelerometer FIFO stream at %u Hz (watermark %u)", odr_hz, watermark);
+    return 0;
+}
+
+int spi_accel_sensor_stream_stop(void)
+{
+    int ret = adxl345_write_reg(ADXL345_REG_FIFO_CTL, ADXL345_FIFO_BYPASS);
+    if (ret < 0) {
+        return ret;
+    }
+
+    stream_enabled = false;
+    return 0;
+}
+
+int spi_accel_sensor_fifo_read(struct accel_raw_frame *frames, size_t max_frames)
+{
+    if (frames == NULL) {
+        return -EINVAL;
+    }
+
+    if (!stream_enabled) {
+        return -EPERM;
+    }
+
+#ifndef USE_REAL_SPI_SENSOR
+    /* STUB: frames accumulate at the ODR, FIFO keeps the newest 32 */
+    uint32_t produced = (uint32_t)((k_uptime_get() - stub_stream_start_ms) *
+                                   stream_odr_hz / 1000);
+    uint32_t pending = produced - stub_frames_consumed;
+
+    if (pending > ACCEL_FIFO_DEPTH) {
+        stub_frames_consumed = produced - ACCEL_FIFO_DEPTH;
+        pending = ACCEL_FIFO_DEPTH;
+    }
+
+    size_t count = MIN((size_t)pending, max_frames);
+
+    for (size_t i = 0; i < count; i++) {
+        /* 1 g on Z plus a 50 Hz vibration component and some noise */
+        float t = (float)(stub_frames_consumed + i) / (float)stream_odr_hz;
+        int16_t vib = (int16_t)(20.0f * sinf(2.0f * 3.14159265f * 50.0f * t));
+
+        frames[i].x = (int16_t)(sys_rand32_get() % 16) - 8;
+        frames[i].y = (int16_t)(sys_rand32_get() % 16) - 8;
+        frames[i].z = 256 + vib + (int16_t)(sys_rand32_get() % 8) - 4;
+    }
+
+    stub_frames_consumed += count;
+    return (int)count;
+
+#else
+    uint8_t status;
+
+    /* One status read tells how many entries can be popped back to back */
+    int ret = adxl345_read_regs(ADXL345_REG_FIFO_STATUS, &status, 1);
+    if (ret < 0) {
+        LOG_ERR("FIFO status read failed: %d", ret);
+        return ret;
+    }
+
+    size_t count = MIN((size_t)(status & ADXL345_FIFO_ENTRIES), max_frames);
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t raw[6];
+
+        ret = adxl345_read_regs(ADXL345_REG_DATAX0, raw, sizeof(raw));
+        if (ret < 0) {
+            LOG_ERR("FIFO read failed after %u frames: %d", (unsigned int)i, ret);
+            return (i > 0) ? (int)i : ret;
+        }
+
+        frames[i].x = (int16_t)sys_get_le16(&raw[0]);
+        frames[i].y = (int16_t)sys_get_le16(&raw[2]);
+        frames[i].z = (int16_t)sys_get_le16(&raw[4]);
+    }
+
+    return (int)count;
 #endif
 }
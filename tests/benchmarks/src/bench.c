@@ -0,0 +1,184 @@
+/**
+ * @file bench.c
+ * @brief Timing harness of the benchmark suite
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include "bench.h"
+#include "text_writer.h"
+
+#define STACK_PAINT 0xA5
+
+/* Longest report line */
+#define REPORT_MAX_LEN 256
+
+/* Largest timed batch */
+#define MAX_ITERATIONS (1U << 24)
+
+#ifdef CONFIG_ARCH_POSIX
+/*
+ * Simulated time stands still while code runs, so on native_sim the
+ * harness reads the host's clocks (host_clock.c, built into the runner).
+ */
+extern uint64_t bench_host_time_ns(void);
+extern uint64_t bench_host_cycles(void);
+#endif
+
+/* Reading of both clocks */
+struct bench_clock {
+    uint64_t ns;
+    uint64_t cycles;
+};
+
+static inline void clock_read(struct bench_clock *clock)
+{
+#ifdef CONFIG_ARCH_POSIX
+    clock->ns = bench_host_time_ns();
+    clock->cycles = bench_host_cycles();
+#else
+    clock->ns = 0;
+    clock->cycles = k_cycle_get_32();
+#endif
+}
+
+static inline void clock_since(const struct bench_clock *start, struct bench_clock *elapsed)
+{
+    struct bench_clock now;
+
+    clock_read(&now);
+#ifdef CONFIG_ARCH_POSIX
+    elapsed->ns = now.ns - start->ns;
+    elapsed->cycles = now.cycles - start->cycles;
+#else
+    /* A batch lasts milliseconds, far from a 32-bit wrap */
+    elapsed->cycles = (uint32_t)(now.cycles - start->cycles);
+    elapsed->ns = k_cyc_to_ns_floor64(elapsed->cycles);
+#endif
+}
+
+/* Painted region of the last stack_paint() */
+static uintptr_t painted_low;
+static uintptr_t painted_high;
+
+/**
+ * @brief Paint the stack below the caller's frame
+ *
+ * An operation called next from the same frame reuses that stack, so
+ * the lowest byte it overwrites is its high-water mark.
+ */
+static __noinline void stack_paint(void)
+{
+    volatile uint8_t area[BENCH_STACK_PROBE];
+
+    for (size_t i = 0; i < sizeof(area); i++) {
+        area[i] = STACK_PAINT;
+    }
+
+    painted_low = (uintptr_t)&area[0];
+    painted_high = (uintptr_t)&area[BENCH_STACK_PROBE];
+}
+
+/**
+ * @brief Bytes of painted stack overwritten since stack_paint()
+ */
+static __noinline uint32_t stack_high_water(void)
+{
+    const volatile uint8_t *p = (const volatile uint8_t *)painted_low;
+
+    while ((uintptr_t)p < painted_high && *p == STACK_PAINT) {
+        p++;
+    }
+
+    return (uint32_t)(painted_high - (uintptr_t)p);
+}
+
+static void time_batch(bench_fn_t fn, void *ctx, uint32_t iterations,
+                       struct bench_clock *elapsed)
+{
+    struct bench_clock start;
+
+    clock_read(&start);
+    for (uint32_t i = 0; i < iterations; i++) {
+        (void)fn(ctx);
+    }
+    clock_since(&start, elapsed);
+}
+
+static void report(const char *name, const struct bench_result *result, uint32_t samples)
+{
+    char line[REPORT_MAX_LEN];
+    struct text_writer w;
+
+    text_writer_init(&w, line, sizeof(line));
+    text_put_str(&w, "{\"name\":\"");
+    text_put_str(&w, name);
+    text_put_str(&w, "\",\"iterations\":");
+    text_put_uint(&w, result->iterations);
+    text_put_str(&w, ",\"ns_per_op\":");
+    text_put_fixed(&w, bench_ns_per_op(result), 1);
+    text_put_str(&w, ",\"cycles_per_op\":");
+    text_put_fixed(&w, (float)result->cycles / (float)result->iterations, 1);
+    text_put_str(&w, ",\"bytes\":");
+    text_put_int(&w, result->bytes);
+    if (samples > 0 && result->bytes > 0) {
+        text_put_str(&w, ",\"bytes_per_sample\":");
+        text_put_fixed(&w, (float)result->bytes / (float)samples, 2);
+    }
+    text_put_str(&w, ",\"stack_bytes\":");
+    text_put_uint(&w, result->stack_bytes);
+    text_put_char(&w, '}');
+
+    if (text_finish(&w) < 0) {
+        printk("BENCH {\"name\":\"%s\",\"error\":\"line too long\"}\n", name);
+        return;
+    }
+
+    printk("BENCH %s\n", line);
+}
+
+int bench_run(const char *name, bench_fn_t fn, void *ctx, uint32_t samples,
+              struct bench_result *result)
+{
+    struct bench_result r = {0};
+
+    stack_paint();
+    r.bytes = fn(ctx);
+    r.stack_bytes = stack_high_water();
+
+    if (r.bytes < 0) {
+        printk("BENCH {\"name\":\"%s\",\"error\":%d}\n", name, r.bytes);
+        return r.bytes;
+    }
+
+    /* Double the batch until it is long enough to time */
+    struct bench_clock elapsed;
+    uint32_t iterations = 1;
+
+    for (;;) {
+        time_batch(fn, ctx, iterations, &elapsed);
+        if (elapsed.ns >= BENCH_MIN_BATCH_NS || iterations >= MAX_ITERATIONS) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    r.iterations = iterations;
+    r.ns = elapsed.ns;
+    r.cycles = elapsed.cycles;
+
+    for (int round = 1; round < BENCH_ROUNDS; round++) {
+        time_batch(fn, ctx, iterations, &elapsed);
+        if (elapsed.ns < r.ns) {
+            r.ns = elapsed.ns;
+            r.cycles = elapsed.cycles;
+        }
+    }
+
+    report(name, &r, samples);
+
+    if (result != NULL) {
+        *result = r;
+    }
+    return 0;
+}
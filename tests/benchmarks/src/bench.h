@@ -0,0 +1,63 @@
+/**
+ * @file bench.h
+ * @brief Timing harness of the benchmark suite
+ *
+ * bench_run() calls an operation once to check it and measure its stack
+ * use, then times it in batches that double until one lasts
+ * BENCH_MIN_BATCH_NS, keeps the fastest of BENCH_ROUNDS such batches and
+ * prints one line per operation:
+ *
+ *   BENCH {"name":"json_compact","iterations":16384,"ns_per_op":412.5,
+ *          "cycles_per_op":1402.0,"bytes":61,"bytes_per_sample":61.0,
+ *          "stack_bytes":304}
+ *
+ * (on one line). scripts/bench_compare.py compares the lines of two runs.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+/* Shortest timed batch; shorter ones are doubled */
+#define BENCH_MIN_BATCH_NS   10000000ULL
+
+/* Timed batches per operation, the fastest is reported */
+#define BENCH_ROUNDS         11
+
+/* Stack below the harness painted before the first call */
+#define BENCH_STACK_PROBE    8192
+
+/**
+ * @brief Operation under test
+ * @param ctx Context given to bench_run()
+ * @return Bytes produced, 0 if it produces none, or negative errno
+ */
+typedef int (*bench_fn_t)(void *ctx);
+
+struct bench_result {
+    uint32_t iterations;        /* Calls per timed batch */
+    uint64_t ns;                /* Fastest batch */
+    uint64_t cycles;            /* Same batch, 0 if no cycle counter */
+    int bytes;                  /* Returned by the first call */
+    uint32_t stack_bytes;       /* High-water mark of the first call */
+};
+
+/**
+ * @brief Measure and report one operation
+ * @param name Name in the report
+ * @param fn Operation
+ * @param ctx Passed to @p fn
+ * @param samples Samples one call handles, for bytes_per_sample; 0 to omit it
+ * @param result Receives the measurement, may be NULL
+ * @return 0 on success, or the error of the first call
+ */
+int bench_run(const char *name, bench_fn_t fn, void *ctx, uint32_t samples,
+              struct bench_result *result);
+
+static inline float bench_ns_per_op(const struct bench_result *result)
+{
+    return (float)result->ns / (float)result->iterations;
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,33 @@
+/**
+ * @file host_clock.c
+ * @brief Host clocks for the benchmarks on native_sim
+ *
+ * Built into the native simulator runner with the host C library, not
+ * into the Zephyr image: simulated time does not advance while code
+ * runs, so bench.c times operations against these instead.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+uint64_t bench_host_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Time-stamp counter on x86 hosts, 0 elsewhere */
+uint64_t bench_host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,862 @@
+/**
+ * @file main.c
+ * @brief Encoder, pipeline and transport micro-benchmarks
+ *
+ * Drives the application's encoding, processing and transport encode
+ * paths with a synthetic sample series and prints one BENCH line per
+ * operation (see bench.h). The checks next to each benchmark keep the
+ * faster paths honest: the fast FFT against the scalar one, streamed JSON against buffered JSON, LZ
+ * payloads against their input. The batch compressors also run over
+ * the sample trace of data/trace.csv, with a table of ratio against
+ * time per batch.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "app_config.h"
+#include "ble_service.h"
+#include "dsp.h"
+#include "lz_compress.h"
+#include "report_filter.h"
+#include "sample_bus.h"
+#include "sample_stats.h"
+#include "sensor_drivers.h"
+#include "sensor_manager.h"
+#include "sensor_manager_internal.h"
+#include "sensor_pipeline.h"
+#include "text_writer.h"
+#include "trace.h"
+#include "ts_compress.h"
+#include "vibration.h"
+
+/* JSON encoder */
+extern int json_encode_sensor_data_with_metadata(const sensor_data_t *data,
+                                                 char *buffer,
+                                                 size_t buffer_size,
+                                                 const char *device_id);
+extern int json_encode_sensor_data_compact(const sensor_data_t *data,
+                                           char *buffer,
+                                           size_t buffer_size);
+extern int json_encode_sensor_batch(const sensor_sample_t *samples,
+                                    size_t count,
+                                    char *buffer,
+                                    size_t buffer_size,
+                                    const char *device_id);
+extern void json_write_sensor_batch(struct text_writer *w,
+                                    const sensor_sample_t *samples,
+                                    size_t count,
+                                    const char *device_id);
+
+/* CBOR encoder */
+extern int cbor_encode_sensor_data(const sensor_data_t *data,
+                                   uint8_t *buffer,
+                                   size_t buffer_size);
+extern int cbor_encode_sensor_data_with_metadata(const sensor_data_t *data,
+                                                 uint8_t *buffer,
+                                                 size_t buffer_size,
+                                                 const char *device_id);
+extern int cbor_encode_sensor_batch(const sensor_sample_t *samples,
+                                    size_t count,
+                                    uint8_t *buffer,
+                                    size_t buffer_size,
+                                    const char *device_id);
+
+/* One full history ring of synthetic samples */
+#define BENCH_SAMPLES    SENSOR_HISTORY_SIZE
+
+/* Samples per batch, as the MQTT uplink sends them */
+#define BENCH_BATCH      CONFIG_APP_PAYLOAD_BATCH_SIZE
+
+#define BENCH_DEVICE_ID  MQTT_CLIENT_ID
+
+/* Large enough for a batch of BENCH_SAMPLES in any encoding */
+#define BATCH_BUF_SIZE   (BATCH_HEADER_MAX_LEN + BENCH_SAMPLES * BATCH_ROW_MAX_LEN)
+
+#define FFT_SIZE         CONFIG_APP_VIBRATION_FFT_SIZE
+
+BUILD_ASSERT(BENCH_BATCH <= BENCH_SAMPLES, "Batch larger than the sample series");
+
+/* Raw driver readings the samples are made from */
+struct raw_reading {
+    int16_t temp;
+    struct accel_raw_frame accel;
+    uint16_t battery_mv;
+};
+
+static sensor_sample_t samples[BENCH_SAMPLES];
+static int16_t vibration_window[FFT_SIZE];
+
+static uint32_t rng_state = 0x2545f491;
+
+/* Uniform integer in [-amplitude, amplitude], xorshift32 */
+static int32_t noise(int32_t amplitude)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    return (int32_t)(rng_state % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+/*
+ * A node at rest on a vibrating machine: temperature drifting up,
+ * gravity on Z with a little noise, a slowly discharging battery, the
+ * accelerometer on its own period and the slow channels every 25th.
+ */
+static void make_samples(void)
+{
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        struct raw_reading reading;
+        struct raw_reading *r = &reading;
+
+        r->temp = (int16_t)(2752 + i / 4 + noise(2));                  /* ~21.5 °C */
+        r->accel.x = (int16_t)noise(8);
+        r->accel.y = (int16_t)(4 + noise(8));
+        r->accel.z = (int16_t)(256 + noise(8));                         /* ~1 g */
+        r->battery_mv = (uint16_t)(3900 - i / 16);
+
+        sensor_sample_t *s = &samples[i];
+
+        s->timestamp_ms = 100000 + i * CONFIG_APP_SENSOR_ACCEL_PERIOD_MS + noise(1);
+        s->temperature_cc = i2c_temp_sensor_raw_to_cc(r->temp);
+        s->accel_mg[0] = spi_accel_sensor_raw_to_mg(r->accel.x);
+        s->accel_mg[1] = spi_accel_sensor_raw_to_mg(r->accel.y);
+        s->accel_mg[2] = spi_accel_sensor_raw_to_mg(r->accel.z);
+        s->battery_mv = r->battery_mv;
+        s->valid_mask = SENSOR_FIELD_ALL;
+        s->fresh_mask = (i % 25 == 0) ? SENSOR_FIELD_ALL : SENSOR_FIELD(SENSOR_CHANNEL_ACCEL);
+    }
+
+    /* 50 Hz and 120 Hz tones on 1 g, in mg */
+    for (int i = 0; i < FFT_SIZE; i++) {
+        float t = (float)i / CONFIG_APP_ACCEL_STREAM_ODR_HZ;
+
+        vibration_window[i] = (int16_t)(1000.0f +
+                                        80.0f * sinf(2.0f * 3.14159265f * 50.0f * t) +
+                                        25.0f * sinf(2.0f * 3.14159265f * 120.0f * t) +
+                                        (float)noise(4));
+    }
+}
+
+static const sensor_sample_t *next_sample(unsigned int *next)
+{
+    const sensor_sample_t *sample = &samples[*next];
+
+    *next = (*next + 1) % BENCH_SAMPLES;
+    return sample;
+}
+
+static void *benchmarks_setup(void)
+{
+    make_samples();
+
+    /* Stub drivers, accelerometer stream and pipeline; the thread is not started */
+    zassert_ok(sensor_manager_init());
+    zassert_ok(vibration_start());
+    return NULL;
+}
+
+ZTEST_SUITE(benchmarks, NULL, benchmarks_setup, NULL, NULL, NULL);
+
+/* ---- text_writer against snprintf ---- */
+
+struct fixed_op {
+    unsigned int next;
+    float values[BENCH_SAMPLES];
+    char buf[TEXT_FIXED_MAX_LEN];
+};
+
+static struct fixed_op fixed_op;
+
+static int op_text_fixed(void *ctx)
+{
+    struct fixed_op *op = ctx;
+    float value = op->values[op->next];
+
+    op->next = (op->next + 1) % BENCH_SAMPLES;
+    return text_format_fixed(op->buf, sizeof(op->buf), value, 2);
+}
+
+static int op_snprintf_fixed(void *ctx)
+{
+    struct fixed_op *op = ctx;
+    float value = op->values[op->next];
+
+    op->next = (op->next + 1) % BENCH_SAMPLES;
+    return snprintf(op->buf, sizeof(op->buf), "%.2f", (double)value);
+}
+
+ZTEST(benchmarks, test_text_writer)
+{
+    /* Equivalence with snprintf is checked in tests/text_writer */
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        fixed_op.values[i] = (float)samples[i].temperature_cc / 100.0f;
+    }
+
+    zassert_ok(bench_run("text_format_fixed", op_text_fixed, &fixed_op, 0, NULL));
+    zassert_ok(bench_run("snprintf_fixed", op_snprintf_fixed, &fixed_op, 0, NULL));
+}
+
+/* ---- Single-sample encoders, as BLE and MQTT run them ---- */
+
+struct sample_op {
+    unsigned int next;
+    uint8_t buf[JSON_BUFFER_SIZE];
+};
+
+static struct sample_op sample_op;
+
+static int op_json_metadata(void *ctx)
+{
+    struct sample_op *op = ctx;
+    sensor_data_t data;
+
+    sensor_sample_to_data(next_sample(&op->next), &data);
+    return json_encode_sensor_data_with_metadata(&data, (char *)op->buf, sizeof(op->buf),
+                                                 BENCH_DEVICE_ID);
+}
+
+static int op_json_compact(void *ctx)
+{
+    struct sample_op *op = ctx;
+    sensor_data_t data;
+
+    sensor_sample_to_data(next_sample(&op->next), &data);
+    return json_encode_sensor_data_compact(&data, (char *)op->buf, sizeof(op->buf));
+}
+
+static int op_cbor_metadata(void *ctx)
+{
+    struct sample_op *op = ctx;
+    sensor_data_t data;
+
+    sensor_sample_to_data(next_sample(&op->next), &data);
+    return cbor_encode_sensor_data_with_metadata(&data, op->buf, sizeof(op->buf),
+                                                 BENCH_DEVICE_ID);
+}
+
+static int op_cbor_compact(void *ctx)
+{
+    struct sample_op *op = ctx;
+    sensor_data_t data;
+
+    sensor_sample_to_data(next_sample(&op->next), &data);
+    return cbor_encode_sensor_data(&data, op->buf, sizeof(op->buf));
+}
+
+static int op_ble_packed(void *ctx)
+{
+    struct sample_op *op = ctx;
+
+    ble_packed_encode(next_sample(&op->next), op->buf);
+    return BLE_PACKED_LEN;
+}
+
+static int op_sample_to_data(void *ctx)
+{
+    struct sample_op *op = ctx;
+    sensor_data_t data;
+
+    sensor_sample_to_data(next_sample(&op->next), &data);
+    memcpy(op->buf, &data, sizeof(data));
+    return 0;
+}
+
+ZTEST(benchmarks, test_sample_encoders)
+{
+    struct bench_result json;
+    struct bench_result json_compact;
+    struct bench_result cbor;
+    struct bench_result cbor_compact;
+    struct bench_result packed;
+
+    zassert_ok(bench_run("sample_to_data", op_sample_to_data, &sample_op, 1, NULL));
+    zassert_ok(bench_run("json_metadata", op_json_metadata, &sample_op, 1, &json));
+    zassert_ok(bench_run("json_compact", op_json_compact, &sample_op, 1, &json_compact));
+    zassert_ok(bench_run("cbor_metadata", op_cbor_metadata, &sample_op, 1, &cbor));
+    zassert_ok(bench_run("cbor_compact", op_cbor_compact, &sample_op, 1, &cbor_compact));
+    zassert_ok(bench_run("ble_packed", op_ble_packed, &sample_op, 1, &packed));
+
+    zassert_true(cbor.bytes < json.bytes, "CBOR %d >= JSON %d", cbor.bytes, json.bytes);
+    zassert_true(cbor_compact.bytes < json_compact.bytes);
+    zassert_true(packed.bytes < cbor_compact.bytes);
+}
+
+/* ---- Batch encoders of the MQTT uplink ---- */
+
+struct batch_op {
+    uint8_t buf[BATCH_BUF_SIZE];
+    char chunk[MQTT_STREAM_CHUNK_SIZE];
+    size_t streamed;
+};
+
+static struct batch_op batch_op;
+
+static int op_json_batch(void *ctx)
+{
+    struct batch_op *op = ctx;
+
+    return json_encode_sensor_batch(samples, BENCH_BATCH, (char *)op->buf, sizeof(op->buf),
+                                    BENCH_DEVICE_ID);
+}
+
+/* Stands in for the socket of a streamed PUBLISH */
+static int count_sink(const char *data, size_t len, void *ctx)
+{
+    struct batch_op *op = ctx;
+
+    ARG_UNUSED(data);
+    op->streamed += len;
+    return 0;
+}
+
+static int op_json_batch_stream(void *ctx)
+{
+    struct batch_op *op = ctx;
+    struct text_writer w;
+
+    op->streamed = 0;
+    text_writer_init_stream(&w, op->chunk, sizeof(op->chunk), count_sink, op);
+    json_write_sensor_batch(&w, samples, BENCH_BATCH, BENCH_DEVICE_ID);
+    return text_finish(&w);
+}
+
+static int op_cbor_batch(void *ctx)
+{
+    struct batch_op *op = ctx;
+
+    return cbor_encode_sensor_batch(samples, BENCH_BATCH, op->buf, sizeof(op->buf),
+                                    BENCH_DEVICE_ID);
+}
+
+static int op_ts_compress(void *ctx)
+{
+    struct batch_op *op = ctx;
+    struct ts_compressor c;
+
+    int ret = ts_compress_init(&c, op->buf, sizeof(op->buf));
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < BENCH_BATCH; i++) {
+        ret = ts_compress_append(&c, &samples[i]);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return (int)ts_compress_finish(&c);
+}
+
+ZTEST(benchmarks, test_batch_encoders)
+{
+    struct bench_result json;
+    struct bench_result stream;
+    struct bench_result cbor;
+    struct bench_result ts;
+
+    zassert_ok(bench_run("json_batch", op_json_batch, &batch_op, BENCH_BATCH, &json));
+    zassert_ok(bench_run("json_batch_stream", op_json_batch_stream, &batch_op, BENCH_BATCH,
+                         &stream));
+    zassert_ok(bench_run("cbor_batch", op_cbor_batch, &batch_op, BENCH_BATCH, &cbor));
+    zassert_ok(bench_run("ts_compress_batch", op_ts_compress, &batch_op, BENCH_BATCH, &ts));
+
+    zassert_equal(stream.bytes, json.bytes, "streamed %d, buffered %d",
+                  stream.bytes, json.bytes);
+    zassert_equal(batch_op.streamed, (size_t)json.bytes);
+    zassert_true(cbor.bytes < json.bytes);
+    zassert_true(ts.bytes < cbor.bytes);
+}
+
+/* ---- Compression of the sample trace: ratio against CPU ---- */
+
+/* Whole batches in the trace, as the uplink would cut them */
+#define TRACE_BATCHES    (trace_sample_count / BENCH_BATCH)
+
+/* LZ parameters swept, window and lookahead bits */
+static const uint8_t lz_params[][2] = {{6, 3}, {8, 4}, {10, 4}, {10, 5}, {12, 5}};
+
+struct trace_op {
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint8_t encoded[BATCH_BUF_SIZE];
+    uint8_t out[LZ_COMPRESS_BOUND(BATCH_BUF_SIZE)];
+    uint8_t work[LZ_COMPRESS_WORK_SIZE(LZ_COMPRESS_MAX_WINDOW_BITS)];
+    char chunk[MQTT_STREAM_CHUNK_SIZE];
+};
+
+static struct trace_op trace_op;
+
+static const sensor_sample_t *trace_batch(size_t batch)
+{
+    return &trace_samples[batch * BENCH_BATCH];
+}
+
+static int op_trace_json(void *ctx)
+{
+    struct trace_op *op = ctx;
+    int total = 0;
+
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        int len = json_encode_sensor_batch(trace_batch(b), BENCH_BATCH, (char *)op->encoded,
+                                           sizeof(op->encoded), BENCH_DEVICE_ID);
+        if (len < 0) {
+            return len;
+        }
+        total += len;
+    }
+
+    return total;
+}
+
+static int op_trace_cbor(void *ctx)
+{
+    struct trace_op *op = ctx;
+    int total = 0;
+
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        int len = cbor_encode_sensor_batch(trace_batch(b), BENCH_BATCH, op->encoded,
+                                           sizeof(op->encoded), BENCH_DEVICE_ID);
+        if (len < 0) {
+            return len;
+        }
+        total += len;
+    }
+
+    return total;
+}
+
+static int op_trace_ts(void *ctx)
+{
+    struct trace_op *op = ctx;
+    struct ts_compressor c;
+    int total = 0;
+
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        ts_compress_init(&c, op->encoded, sizeof(op->encoded));
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            int ret = ts_compress_append(&c, &trace_batch(b)[i]);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        total += (int)ts_compress_finish(&c);
+    }
+
+    return total;
+}
+
+/* One JSON batch streamed through the compressor, as the MQTT uplink does */
+static int trace_json_lz(struct trace_op *op, size_t batch)
+{
+    struct lz_compressor lz;
+    struct text_writer w;
+
+    int ret = lz_compress_init(&lz, op->work, op->window_bits, op->lookahead_bits,
+                               op->out, sizeof(op->out));
+    if (ret < 0) {
+        return ret;
+    }
+
+    text_writer_init_stream(&w, op->chunk, sizeof(op->chunk), lz_compress_sink, &lz);
+    json_write_sensor_batch(&w, trace_batch(batch), BENCH_BATCH, BENCH_DEVICE_ID);
+    ret = text_finish(&w);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return lz_compress_finish(&lz);
+}
+
+static int op_trace_json_lz(void *ctx)
+{
+    int total = 0;
+
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        int len = trace_json_lz(ctx, b);
+        if (len < 0) {
+            return len;
+        }
+        total += len;
+    }
+
+    return total;
+}
+
+/* One CBOR batch compressed in place, as the MQTT uplink does */
+static int trace_cbor_lz(struct trace_op *op, size_t batch)
+{
+    const size_t offset = LZ_COMPRESS_IN_PLACE_OFFSET(sizeof(op->out));
+    struct lz_compressor lz;
+
+    int len = cbor_encode_sensor_batch(trace_batch(batch), BENCH_BATCH, &op->out[offset],
+                                       sizeof(op->out) - offset, BENCH_DEVICE_ID);
+    if (len < 0) {
+        return len;
+    }
+
+    int ret = lz_compress_init(&lz, op->work, op->window_bits, op->lookahead_bits,
+                               op->out, sizeof(op->out));
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = lz_compress_feed(&lz, &op->out[offset], len);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return lz_compress_finish(&lz);
+}
+
+static int op_trace_cbor_lz(void *ctx)
+{
+    int total = 0;
+
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        int len = trace_cbor_lz(ctx, b);
+        if (len < 0) {
+            return len;
+        }
+        total += len;
+    }
+
+    return total;
+}
+
+/* Reads the MSB-first bit stream; -1 past its end */
+static int32_t get_bits(const uint8_t *in, size_t in_len, size_t *bit, unsigned int count)
+{
+    uint32_t value = 0;
+
+    for (unsigned int k = 0; k < count; k++, (*bit)++) {
+        if (*bit >= in_len * 8) {
+            return -1;
+        }
+        value = (value << 1) | ((in[*bit >> 3] >> (7 - (*bit & 7))) & 1U);
+    }
+
+    return (int32_t)value;
+}
+
+/* Reference decoder, as scripts/lz_decompress.py */
+static int lz_expand(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_size)
+{
+    if (in_len < LZ_COMPRESS_HEADER_LEN || in[0] != LZ_COMPRESS_VERSION) {
+        return -EBADMSG;
+    }
+
+    unsigned int window_bits = in[1] >> 4;
+    unsigned int lookahead_bits = in[1] & 0x0F;
+    size_t len = sys_get_le16(&in[2]);
+    size_t bit = LZ_COMPRESS_HEADER_LEN * 8;
+    size_t n = 0;
+
+    if (len > out_size) {
+        return -ENOMEM;
+    }
+
+    while (n < len) {
+        int32_t literal = get_bits(in, in_len, &bit, 1);
+
+        if (literal == 1) {
+            int32_t byte = get_bits(in, in_len, &bit, 8);
+
+            if (byte < 0) {
+                return -EBADMSG;
+            }
+            out[n++] = (uint8_t)byte;
+            continue;
+        }
+
+        int32_t dist = get_bits(in, in_len, &bit, window_bits) + 1;
+        int32_t count = get_bits(in, in_len, &bit, lookahead_bits) + 1;
+
+        if (literal < 0 || dist <= 0 || count <= 0 ||
+            (size_t)dist > n || n + count > len) {
+            return -EBADMSG;
+        }
+        for (int32_t k = 0; k < count; k++, n++) {
+            out[n] = out[n - dist];
+        }
+    }
+
+    return (int)len;
+}
+
+/* One line of the ratio table: bytes and time of a pass over the trace */
+static void print_row(const char *name, const struct bench_result *result, int base_bytes)
+{
+    printk("%-22s %8d %6.2fx %12.0f\n", name, result->bytes,
+           (double)base_bytes / result->bytes,
+           (double)bench_ns_per_op(result) / TRACE_BATCHES);
+}
+
+ZTEST(benchmarks, test_trace_compression)
+{
+    uint32_t samples_in = TRACE_BATCHES * BENCH_BATCH;
+    struct bench_result json;
+    struct bench_result cbor;
+    struct bench_result ts;
+    struct bench_result result;
+    char name[32];
+
+    zassert_true(TRACE_BATCHES > 0, "trace shorter than a batch");
+
+    zassert_ok(bench_run("trace_json", op_trace_json, &trace_op, samples_in, &json));
+    zassert_ok(bench_run("trace_cbor", op_trace_cbor, &trace_op, samples_in, &cbor));
+    zassert_ok(bench_run("trace_ts", op_trace_ts, &trace_op, samples_in, &ts));
+
+    printk("trace: %u batches of %d samples, ratio against JSON\n",
+           (unsigned int)TRACE_BATCHES, BENCH_BATCH);
+    printk("%-22s %8s %7s %12s\n", "payload", "bytes", "ratio", "ns/batch");
+    print_row("trace_json", &json, json.bytes);
+    print_row("trace_cbor", &cbor, json.bytes);
+    print_row("trace_ts", &ts, json.bytes);
+
+    for (size_t p = 0; p < ARRAY_SIZE(lz_params); p++) {
+        static char expected[BATCH_BUF_SIZE];
+        static uint8_t expanded[BATCH_BUF_SIZE];
+
+        trace_op.window_bits = lz_params[p][0];
+        trace_op.lookahead_bits = lz_params[p][1];
+
+        /* Every batch has to come back byte for byte */
+        for (size_t b = 0; b < TRACE_BATCHES; b++) {
+            int len = json_encode_sensor_batch(trace_batch(b), BENCH_BATCH, expected,
+                                               sizeof(expected), BENCH_DEVICE_ID);
+            int packed = trace_json_lz(&trace_op, b);
+
+            zassert_true(packed > 0, "batch %u: %d", (unsigned int)b, packed);
+            zassert_equal(lz_expand(trace_op.out, packed, expanded, sizeof(expanded)), len);
+            zassert_mem_equal(expanded, expected, len, "batch %u", (unsigned int)b);
+        }
+
+        snprintf(name, sizeof(name), "trace_json_lz_w%u_l%u",
+                 trace_op.window_bits, trace_op.lookahead_bits);
+        zassert_ok(bench_run(name, op_trace_json_lz, &trace_op, samples_in, &result));
+        zassert_true(result.bytes < json.bytes, "%s %d >= JSON %d",
+                     name, result.bytes, json.bytes);
+        print_row(name, &result, json.bytes);
+    }
+
+    /* CBOR is dense already; shows what a window still finds in it */
+    trace_op.window_bits = 8;
+    trace_op.lookahead_bits = 4;
+    for (size_t b = 0; b < TRACE_BATCHES; b++) {
+        static uint8_t expanded[BATCH_BUF_SIZE];
+        int len = cbor_encode_sensor_batch(trace_batch(b), BENCH_BATCH, trace_op.encoded,
+                                           sizeof(trace_op.encoded), BENCH_DEVICE_ID);
+        int packed = trace_cbor_lz(&trace_op, b);
+
+        zassert_true(packed > 0, "batch %u: %d", (unsigned int)b, packed);
+        zassert_equal(lz_expand(trace_op.out, packed, expanded, sizeof(expanded)), len);
+        zassert_mem_equal(expanded, trace_op.encoded, len, "batch %u", (unsigned int)b);
+    }
+
+    zassert_ok(bench_run("trace_cbor_lz_w8_l4", op_trace_cbor_lz, &trace_op, samples_in,
+                         &result));
+    zassert_true(result.bytes < cbor.bytes);
+    print_row("trace_cbor_lz_w8_l4", &result, json.bytes);
+}
+
+/* ---- Sample bus ---- */
+
+SAMPLE_BUS_SUBSCRIBER_DEFINE(bench_sub, 4, 0, SAMPLE_BUS_DROP_OLDEST);
+
+static int op_bus_roundtrip(void *ctx)
+{
+    unsigned int *next = ctx;
+
+    int ret = sample_bus_publish(next_sample(next));
+    if (ret < 0) {
+        return ret;
+    }
+
+    struct sample_buf *buf = sample_bus_receive(&bench_sub, K_NO_WAIT);
+    if (buf == NULL) {
+        return -EAGAIN;
+    }
+
+    sample_bus_release(buf);
+    return 0;
+}
+
+ZTEST(benchmarks, test_transport_paths)
+{
+    unsigned int next = 0;
+
+    zassert_ok(sample_bus_subscribe(&bench_sub));
+    zassert_ok(bench_run("sample_bus_roundtrip", op_bus_roundtrip, &next, 0, NULL));
+    zassert_ok(sample_bus_unsubscribe(&bench_sub));
+}
+
+/* ---- Sampling path and processing ---- */
+
+struct cycle_op {
+    unsigned int next;
+    uint32_t count;
+    sensor_sample_t sample;
+    struct report_filter filter;
+    sensor_cursor_t cursor;
+    sensor_sample_t batch[BENCH_BATCH];
+};
+
+static struct cycle_op cycle_op;
+
+/*
+ * One cycle of every channel through the sensor thread's own code, on
+ * the stub drivers. Simulated time stands still in the timing loop, so
+ * the stub FIFO stays empty and the accelerometer takes the no-data path.
+ */
+static int op_sensor_cycle(void *ctx)
+{
+    struct cycle_op *op = ctx;
+
+    op->sample.fresh_mask = 0;
+    sample_channels(SENSOR_FIELD_ALL, &op->sample);
+    return (op->sample.valid_mask != 0) ? 0 : -EIO;
+}
+
+static int op_history_publish(void *ctx)
+{
+    struct cycle_op *op = ctx;
+
+    history_publish(next_sample(&op->next));
+    return 0;
+}
+
+/* A consumer catching up on one batch: the cursor is rewound each call */
+static int op_read_since(void *ctx)
+{
+    struct cycle_op *op = ctx;
+
+    op->cursor.next -= BENCH_BATCH;
+
+    int n = sensor_manager_read_since(&op->cursor, op->batch, BENCH_BATCH);
+    return (n == BENCH_BATCH) ? 0 : -EIO;
+}
+
+static int op_get_sample(void *ctx)
+{
+    struct cycle_op *op = ctx;
+
+    return sensor_manager_get_sample(&op->sample);
+}
+
+static int op_stats_add(void *ctx)
+{
+    struct cycle_op *op = ctx;
+    struct stats_summary summary;
+
+    op->sample = *next_sample(&op->next);
+    op->sample.timestamp_ms = op->count++ * CONFIG_APP_SENSOR_ACCEL_PERIOD_MS;
+    sample_stats_add(&op->sample);
+
+    /* Closed windows go to the uplink queue; keep it from filling */
+    while (sample_stats_get_summary(&summary, K_NO_WAIT) == 0) {
+    }
+    return 0;
+}
+
+static int op_report_filter(void *ctx)
+{
+    struct cycle_op *op = ctx;
+    const sensor_sample_t *sample = next_sample(&op->next);
+
+    if (report_filter_check(&op->filter, sample)) {
+        report_filter_commit(&op->filter, sample);
+    }
+    return 0;
+}
+
+ZTEST(benchmarks, test_sample_path)
+{
+    cycle_op = (struct cycle_op){.sample = samples[0]};
+    zassert_ok(bench_run("sensor_cycle", op_sensor_cycle, &cycle_op, 1, NULL));
+
+    /* Publishing laps the history ring many times over */
+    cycle_op = (struct cycle_op){0};
+    zassert_ok(bench_run("history_publish", op_history_publish, &cycle_op, 1, NULL));
+
+    /* Readers of the full ring */
+    sensor_manager_cursor_init(&cycle_op.cursor);
+    zassert_ok(bench_run("history_read_since", op_read_since, &cycle_op, BENCH_BATCH, NULL));
+    zassert_ok(bench_run("history_get_sample", op_get_sample, &cycle_op, 1, NULL));
+    zassert_equal(cycle_op.cursor.dropped, 0, "reader lapped by the ring");
+
+    cycle_op = (struct cycle_op){0};
+    zassert_ok(bench_run("sample_stats_add", op_stats_add, &cycle_op, 1, NULL));
+
+    cycle_op = (struct cycle_op){0};
+    report_filter_init(&cycle_op.filter, "bench", &report_filter_default_config);
+    zassert_ok(bench_run("report_filter", op_report_filter, &cycle_op, 1, NULL));
+}
+
+/* ---- Vibration spectrum ---- */
+
+struct fft_op {
+    float work[2 * FFT_SIZE];       /* The scalar FFT widens to complex */
+    float power[FFT_SIZE / 2 + 1];
+    struct vibration_spectrum spectrum;
+};
+
+static struct fft_op fft_op;
+
+static void load_window(float *work)
+{
+    for (int i = 0; i < FFT_SIZE; i++) {
+        work[i] = (float)vibration_window[i];
+    }
+}
+
+static int op_fft_scalar(void *ctx)
+{
+    struct fft_op *op = ctx;
+
+    load_window(op->work);
+    return dsp_rfft_power_scalar(op->work, FFT_SIZE, op->power);
+}
+
+static int op_fft_fast(void *ctx)
+{
+    struct fft_op *op = ctx;
+
+    load_window(op->work);
+    return dsp_rfft_power_fast(op->work, FFT_SIZE, op->power);
+}
+
+static int op_vibration_analyze(void *ctx)
+{
+    struct fft_op *op = ctx;
+
+    return vibration_analyze(vibration_window, &op->spectrum);
+}
+
+ZTEST(benchmarks, test_vibration)
+{
+    static float reference[FFT_SIZE / 2 + 1];
+    float peak = 0.0f;
+
+    zassert_ok(op_fft_scalar(&fft_op));
+    memcpy(reference, fft_op.power, sizeof(reference));
+    zassert_ok(op_fft_fast(&fft_op));
+
+    for (int k = 0; k <= FFT_SIZE / 2; k++) {
+        peak = MAX(peak, reference[k]);
+    }
+    for (int k = 0; k <= FFT_SIZE / 2; k++) {
+        zassert_within(fft_op.power[k], reference[k], 1e-4f * peak, "bin %d", k);
+    }
+
+    zassert_ok(bench_run("fft_scalar", op_fft_scalar, &fft_op, FFT_SIZE, NULL));
+    zassert_ok(bench_run("fft_fast", op_fft_fast, &fft_op, FFT_SIZE, NULL));
+    zassert_ok(bench_run("vibration_analyze", op_vibration_analyze, &fft_op, FFT_SIZE, NULL));
+    zassert_true(fft_op.spectrum.peak_count > 0);
+}
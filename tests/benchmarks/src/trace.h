@@ -0,0 +1,18 @@
+/**
+ * @file trace.h
+ * @brief Sample trace the compression benchmarks run on
+ *
+ * Generated at build time from data/trace.csv by trace_to_c.py.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <zephyr/sys/util.h>
+#include "sample_schema.h"
+
+extern const sensor_sample_t trace_samples[];
+extern const size_t trace_sample_count;
+
+#endif /* TRACE_H */
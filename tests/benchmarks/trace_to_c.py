@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Turn a sample trace (CSV) into the C array of src/trace.h.
+
+The columns are those scripts/ts_decompress.py prints: timestamp_ms, one
+per value of include/sample_schema.h, valid_mask. Lines starting with '#'
+are comments.
+
+Usage:
+    trace_to_c.py data/trace.csv trace_samples.c
+"""
+
+import argparse
+import csv
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "scripts"))
+
+from sample_schema import FIELDS, VALUES, wrap  # noqa: E402
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        rows = csv.DictReader(line for line in f if line.strip() and not line.startswith("#"))
+        missing = {"timestamp_ms", "valid_mask", *(v.name for v in VALUES)} - set(rows.fieldnames or ())
+        if missing:
+            raise ValueError(f"{path}: missing columns {', '.join(sorted(missing))}")
+        return list(rows)
+
+
+def initializer(row):
+    values = iter(VALUES)
+    members = [f".timestamp_ms = {int(row['timestamp_ms'])}U"]
+    for field in FIELDS:
+        items = [str(wrap(int(row[v.name]), v)) for v in (next(values) for _ in range(field.n))]
+        members.append(f".{field.name} = " + (items[0] if field.n == 1 else "{" + ", ".join(items) + "}"))
+    members.append(f".valid_mask = {int(row['valid_mask'])}")
+    return "    {" + ", ".join(members) + "},"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="trace CSV")
+    parser.add_argument("output", help="C file to write")
+    args = parser.parse_args()
+
+    rows = load(args.trace)
+    if not rows:
+        parser.error(f"{args.trace} holds no samples")
+
+    lines = [f"/* Generated by trace_to_c.py from {os.path.basename(args.trace)}, do not edit */",
+             "",
+             '#include "trace.h"',
+             "",
+             "const sensor_sample_t trace_samples[] = {",
+             *(initializer(row) for row in rows),
+             "};",
+             "",
+             "const size_t trace_sample_count = ARRAY_SIZE(trace_samples);",
+             ""]
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
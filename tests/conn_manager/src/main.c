@@ -0,0 +1,254 @@
+/**
+ * @file main.c
+ * @brief Reconnect state machine: which layers each loss redoes, backoff, recovery time
+ *
+ * The WiFi driver, the DHCP client and the broker are stand-ins that answer
+ * after fixed delays, so each recovery time is the sum of the layers redone.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "conn_manager.h"
+
+/* Stand-in network timings */
+#define ASSOC_MS    30
+#define DHCP_MS     20
+#define BROKER_MS   5
+
+#define BACKOFF_MIN CONFIG_APP_CONN_BACKOFF_MIN_MS
+#define BACKOFF_MAX CONFIG_APP_CONN_BACKOFF_MAX_MS
+
+static bool link_ok;
+static bool dhcp_ok;
+static bool broker_ok;
+static bool broker_up;
+
+static void assoc_done(struct k_work *work);
+static void dhcp_done(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(assoc_work, assoc_done);
+static K_WORK_DELAYABLE_DEFINE(dhcp_work, dhcp_done);
+
+static void assoc_done(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (!link_ok) {
+        conn_manager_notify(CONN_EVENT_LINK_FAILED);
+        return;
+    }
+
+    conn_manager_notify(CONN_EVENT_LINK_UP);
+    /* The DHCP client starts by itself on association */
+    k_work_schedule(&dhcp_work, K_MSEC(DHCP_MS));
+}
+
+static void dhcp_done(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (dhcp_ok) {
+        conn_manager_notify(CONN_EVENT_IP_UP);
+    }
+}
+
+static int fake_link_connect(void)
+{
+    k_work_schedule(&assoc_work, K_MSEC(ASSOC_MS));
+    return 0;
+}
+
+static int fake_ip_renew(void)
+{
+    k_work_schedule(&dhcp_work, K_MSEC(DHCP_MS));
+    return 0;
+}
+
+static int fake_broker_connect(void)
+{
+    /* CONNECT and CONNACK */
+    k_msleep(BROKER_MS);
+    broker_up = broker_ok;
+    return broker_ok ? 0 : -ECONNREFUSED;
+}
+
+static bool fake_broker_connected(void)
+{
+    return broker_up;
+}
+
+static const struct conn_ops fake_ops = {
+    .link_connect = fake_link_connect,
+    .ip_renew = fake_ip_renew,
+    .broker_connect = fake_broker_connect,
+    .broker_connected = fake_broker_connected,
+};
+
+static struct conn_stats before;
+
+/* Report @p event and let the manager take it; the session dies with any layer */
+static void inject(enum conn_event event)
+{
+    broker_up = false;
+    conn_manager_notify(event);
+    k_msleep(1);
+    zassert_not_equal(conn_manager_state(), CONN_STATE_UP, "loss ignored");
+}
+
+/* Wait for recovery and check how often each layer was redone */
+static uint32_t recover(enum conn_loss loss, uint32_t links, uint32_t renewals,
+                        uint32_t brokers)
+{
+    struct conn_stats after;
+
+    zassert_equal(conn_manager_wait_up(K_SECONDS(10)), 0, "not recovered");
+    conn_manager_get_stats(&after);
+
+    zassert_equal(after.losses[loss] - before.losses[loss], 1);
+    zassert_equal(after.link_attempts - before.link_attempts, links);
+    zassert_equal(after.ip_renewals - before.ip_renewals, renewals);
+    zassert_equal(after.broker_attempts - before.broker_attempts, brokers);
+
+    return after.recovery_ms[loss];
+}
+
+static void *conn_setup(void)
+{
+    link_ok = true;
+    dhcp_ok = true;
+    broker_ok = true;
+
+    zassert_equal(conn_manager_start(&fake_ops), 0);
+    zassert_equal(conn_manager_start(&fake_ops), -EINVAL, "started twice");
+    zassert_equal(conn_manager_wait_up(K_SECONDS(10)), 0, "never came up");
+    return NULL;
+}
+
+static void conn_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    link_ok = true;
+    dhcp_ok = true;
+    broker_ok = true;
+    zassert_equal(conn_manager_wait_up(K_SECONDS(10)), 0);
+    conn_manager_get_stats(&before);
+}
+
+ZTEST_SUITE(conn_manager, NULL, conn_setup, conn_before, NULL, NULL);
+
+ZTEST(conn_manager, test_backoff_bounds)
+{
+    zassert_equal(conn_backoff_ms(0, 12345), 0, "first retry waits");
+
+    /* Between half and all of MIN << (attempt - 1) */
+    zassert_equal(conn_backoff_ms(1, 0), BACKOFF_MIN / 2);
+    zassert_equal(conn_backoff_ms(1, BACKOFF_MIN / 2), BACKOFF_MIN);
+    zassert_equal(conn_backoff_ms(2, 0), BACKOFF_MIN);
+
+    for (uint32_t attempt = 1; attempt < 40; attempt++) {
+        uint32_t cap = MIN((uint64_t)BACKOFF_MIN << MIN(attempt - 1, 32), BACKOFF_MAX);
+
+        for (uint32_t i = 0; i < 64; i++) {
+            uint32_t delay = conn_backoff_ms(attempt, i * 0x9E3779B9u);
+
+            zassert_true(delay >= cap / 2 && delay <= cap,
+                         "attempt %u: %u ms", attempt, delay);
+        }
+    }
+}
+
+ZTEST(conn_manager, test_broker_loss_skips_wifi_and_dhcp)
+{
+    inject(CONN_EVENT_BROKER_DOWN);
+
+    uint32_t ms = recover(CONN_LOSS_BROKER, 0, 0, 1);
+
+    TC_PRINT("broker loss recovered in %u ms\n", ms);
+    zassert_true(ms < BROKER_MS + 20, "%u ms", ms);
+}
+
+ZTEST(conn_manager, test_ip_loss_keeps_association)
+{
+    inject(CONN_EVENT_IP_DOWN);
+
+    uint32_t ms = recover(CONN_LOSS_IP, 0, 1, 1);
+
+    TC_PRINT("IP loss recovered in %u ms\n", ms);
+    zassert_true(ms < DHCP_MS + BROKER_MS + 20, "%u ms", ms);
+}
+
+ZTEST(conn_manager, test_link_loss_redoes_every_layer)
+{
+    inject(CONN_EVENT_LINK_DOWN);
+
+    uint32_t ms = recover(CONN_LOSS_LINK, 1, 0, 1);
+
+    TC_PRINT("link loss recovered in %u ms\n", ms);
+    zassert_true(ms < ASSOC_MS + DHCP_MS + BROKER_MS + 20, "%u ms", ms);
+}
+
+ZTEST(conn_manager, test_stale_broker_event_ignored)
+{
+    struct conn_stats after;
+
+    /* Reported for a session a reconnect already replaced */
+    conn_manager_notify(CONN_EVENT_BROKER_DOWN);
+    k_msleep(50);
+
+    conn_manager_get_stats(&after);
+    zassert_equal(conn_manager_state(), CONN_STATE_UP);
+    zassert_equal(after.broker_attempts, before.broker_attempts);
+    zassert_equal(after.losses[CONN_LOSS_BROKER], before.losses[CONN_LOSS_BROKER]);
+}
+
+ZTEST(conn_manager, test_broker_refusal_backs_off)
+{
+    broker_ok = false;
+    inject(CONN_EVENT_BROKER_DOWN);
+
+    /* The immediate retry failed; the next waits at least MIN / 2 */
+    k_msleep(BROKER_MS + BACKOFF_MIN / 2 - 10);
+    zassert_equal(conn_manager_state(), CONN_STATE_BROKER_DOWN);
+
+    broker_ok = true;
+
+    uint32_t ms = recover(CONN_LOSS_BROKER, 0, 0, 2);
+
+    TC_PRINT("broker refusal recovered in %u ms\n", ms);
+    zassert_true(ms >= 2 * BROKER_MS + BACKOFF_MIN / 2, "%u ms", ms);
+    zassert_true(ms < 2 * BROKER_MS + BACKOFF_MIN + 20, "%u ms", ms);
+}
+
+ZTEST(conn_manager, test_association_failure_backs_off)
+{
+    link_ok = false;
+    inject(CONN_EVENT_LINK_DOWN);
+
+    k_msleep(ASSOC_MS + 10);
+    zassert_equal(conn_manager_state(), CONN_STATE_LINK_DOWN);
+
+    link_ok = true;
+
+    uint32_t ms = recover(CONN_LOSS_LINK, 2, 0, 1);
+
+    TC_PRINT("failed association recovered in %u ms\n", ms);
+    zassert_true(ms >= 2 * ASSOC_MS + BACKOFF_MIN / 2, "%u ms", ms);
+}
+
+ZTEST(conn_manager, test_silent_dhcp_reassociates)
+{
+    dhcp_ok = false;
+    inject(CONN_EVENT_IP_DOWN);
+
+    /* One restart, then the DHCP timeout gives up on the association */
+    k_msleep(CONFIG_APP_CONN_DHCP_TIMEOUT_MS / 2);
+    zassert_equal(conn_manager_state(), CONN_STATE_IP_WAIT);
+
+    dhcp_ok = true;
+
+    uint32_t ms = recover(CONN_LOSS_IP, 1, 1, 1);
+
+    TC_PRINT("silent DHCP recovered in %u ms\n", ms);
+    zassert_true(ms >= CONFIG_APP_CONN_DHCP_TIMEOUT_MS + ASSOC_MS + DHCP_MS, "%u ms", ms);
+}
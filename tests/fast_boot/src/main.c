@@ -0,0 +1,265 @@
+/**
+ * @file main.c
+ * @brief Connection cache in settings and boot milestones
+ *
+ * Every test starts from empty settings. A reboot is fast_boot_init() run
+ * again: the cache reloads from settings, with nothing carried over in RAM.
+ * The lease tests play DHCP's part on the loopback interface.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/net/net_if.h>
+#include <string.h>
+#include "fast_boot.h"
+
+static const struct fast_boot_link link = {
+    .ssid_crc = 0x12345678,
+    .bssid = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55},
+    .channel = 6,
+};
+
+static const struct fast_boot_lease lease = {
+    .addr = {172, 20, 10, 3},
+    .netmask = {255, 255, 255, 240},
+    .gateway = {172, 20, 10, 1},
+};
+
+static const struct fast_boot_broker broker = {
+    .name_crc = 0x9abcdef0,
+    .addr = {172, 20, 10, 7},
+};
+
+static struct net_if *iface;
+
+/* Another address in the same subnet */
+static struct in_addr granted = {{{172, 20, 10, 9}}};
+
+static struct net_if_addr *find_addr(const struct in_addr *addr)
+{
+    struct net_if *owner;
+
+    return net_if_ipv4_addr_lookup(addr, &owner);
+}
+
+static void reboot(void)
+{
+    zassert_ok(fast_boot_init());
+}
+
+static void save_all(void)
+{
+    zassert_ok(fast_boot_save(FAST_BOOT_LINK, &link, sizeof(link)));
+    zassert_ok(fast_boot_save(FAST_BOOT_LEASE, &lease, sizeof(lease)));
+    zassert_ok(fast_boot_save(FAST_BOOT_BROKER, &broker, sizeof(broker)));
+}
+
+static void *fast_boot_setup(void)
+{
+    zassert_ok(settings_subsys_init());
+    iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+    zassert_not_null(iface);
+    return NULL;
+}
+
+static void fast_boot_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    settings_delete("fboot/link");
+    settings_delete("fboot/lease");
+    settings_delete("fboot/broker");
+    reboot();
+}
+
+static void fast_boot_after(void *fixture)
+{
+    struct in_addr addr;
+
+    ARG_UNUSED(fixture);
+
+    memcpy(&addr, lease.addr, sizeof(addr));
+    net_if_ipv4_addr_rm(iface, &addr);
+    net_if_ipv4_addr_rm(iface, &granted);
+}
+
+ZTEST_SUITE(fast_boot, NULL, fast_boot_setup, fast_boot_before, fast_boot_after, NULL);
+
+ZTEST(fast_boot, test_first_boot_has_no_cache)
+{
+    struct fast_boot_link got;
+    struct fast_boot_stats stats;
+
+    zassert_false(fast_boot_get(FAST_BOOT_LINK, &got, sizeof(got)));
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.loaded, 0);
+    zassert_equal(stats.used, 0);
+}
+
+ZTEST(fast_boot, test_items_survive_reboot)
+{
+    struct fast_boot_link got_link;
+    struct fast_boot_lease got_lease;
+    struct fast_boot_broker got_broker;
+    struct fast_boot_stats stats;
+
+    save_all();
+    reboot();
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.loaded, BIT_MASK(FAST_BOOT_ITEM_COUNT));
+    zassert_equal(stats.used, 0);
+
+    zassert_true(fast_boot_get(FAST_BOOT_LINK, &got_link, sizeof(got_link)));
+    zassert_mem_equal(&got_link, &link, sizeof(link));
+    zassert_true(fast_boot_get(FAST_BOOT_LEASE, &got_lease, sizeof(got_lease)));
+    zassert_mem_equal(&got_lease, &lease, sizeof(lease));
+    zassert_true(fast_boot_get(FAST_BOOT_BROKER, &got_broker, sizeof(got_broker)));
+    zassert_mem_equal(&got_broker, &broker, sizeof(broker));
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.used, BIT_MASK(FAST_BOOT_ITEM_COUNT));
+}
+
+ZTEST(fast_boot, test_unchanged_items_are_not_rewritten)
+{
+    struct fast_boot_lease moved = lease;
+    struct fast_boot_stats stats;
+
+    save_all();
+    reboot();
+
+    /* Every boot saves what worked; only a change reaches flash */
+    save_all();
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.saves, 0);
+
+    moved.addr[3] = 9;
+    zassert_ok(fast_boot_save(FAST_BOOT_LEASE, &moved, sizeof(moved)));
+    zassert_ok(fast_boot_save(FAST_BOOT_LEASE, &moved, sizeof(moved)));
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.saves, 1);
+
+    reboot();
+    struct fast_boot_lease got;
+
+    zassert_true(fast_boot_get(FAST_BOOT_LEASE, &got, sizeof(got)));
+    zassert_equal(got.addr[3], 9);
+}
+
+ZTEST(fast_boot, test_forgotten_item_takes_full_path)
+{
+    struct fast_boot_broker got;
+    struct fast_boot_stats stats;
+
+    save_all();
+    reboot();
+
+    zassert_true(fast_boot_get(FAST_BOOT_BROKER, &got, sizeof(got)));
+    fast_boot_forget(FAST_BOOT_BROKER);
+    zassert_false(fast_boot_get(FAST_BOOT_BROKER, &got, sizeof(got)));
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.failed, BIT(FAST_BOOT_BROKER));
+
+    /* Gone from flash too; the other items stay */
+    reboot();
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.loaded, BIT(FAST_BOOT_LINK) | BIT(FAST_BOOT_LEASE));
+}
+
+ZTEST(fast_boot, test_foreign_layout_ignored)
+{
+    uint8_t old[3] = {1, 2, 3};
+    struct fast_boot_link got;
+    struct fast_boot_stats stats;
+
+    /* Left by a build whose struct had another size */
+    zassert_ok(settings_save_one("fboot/link", old, sizeof(old)));
+    reboot();
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.loaded, 0);
+    zassert_false(fast_boot_get(FAST_BOOT_LINK, &got, sizeof(got)));
+    zassert_equal(fast_boot_save(FAST_BOOT_LINK, &link, 3), -EINVAL);
+}
+
+ZTEST(fast_boot, test_milestones_count_once)
+{
+    struct fast_boot_stats stats;
+
+    k_msleep(5);
+    fast_boot_mark(FAST_BOOT_MARK_LINK);
+    k_msleep(5);
+    fast_boot_mark(FAST_BOOT_MARK_IP);
+    fast_boot_mark(FAST_BOOT_MARK_BROKER);
+    fast_boot_mark(FAST_BOOT_MARK_PUBLISH);
+
+    fast_boot_get_stats(&stats);
+    uint32_t first = stats.mark_ms[FAST_BOOT_MARK_LINK];
+
+    zassert_not_equal(first, 0);
+    zassert_true(stats.mark_ms[FAST_BOOT_MARK_IP] >= first + 5);
+    zassert_true(stats.mark_ms[FAST_BOOT_MARK_PUBLISH] >= stats.mark_ms[FAST_BOOT_MARK_BROKER]);
+
+    /* A reconnect later on does not move them */
+    k_msleep(5);
+    fast_boot_mark(FAST_BOOT_MARK_LINK);
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.mark_ms[FAST_BOOT_MARK_LINK], first);
+}
+
+ZTEST(fast_boot, test_confirmed_lease_becomes_dhcp)
+{
+    struct in_addr addr;
+    struct in_addr netmask;
+    struct fast_boot_stats stats;
+
+    save_all();
+    reboot();
+
+    zassert_true(fast_boot_lease_apply(iface, &addr));
+    zassert_mem_equal(&addr, lease.addr, sizeof(lease.addr));
+    zassert_equal(find_addr(&addr)->addr_type, NET_ADDR_MANUAL);
+
+    /* DHCP is granted the same address: its add finds the manual one */
+    zassert_not_null(net_if_ipv4_addr_add(iface, &addr, NET_ADDR_DHCP, 3600));
+    zassert_equal(find_addr(&addr)->addr_type, NET_ADDR_MANUAL);
+
+    zassert_true(fast_boot_lease_bound(iface, &addr, &addr, 3600));
+    zassert_not_null(find_addr(&addr));
+    zassert_equal(find_addr(&addr)->addr_type, NET_ADDR_DHCP);
+    netmask = net_if_ipv4_get_netmask_by_addr(iface, &addr);
+    zassert_mem_equal(&netmask, lease.netmask, sizeof(lease.netmask));
+
+    /* Still cached for the next boot */
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.failed, 0);
+}
+
+ZTEST(fast_boot, test_stale_lease_removed_when_bound)
+{
+    struct in_addr addr;
+    struct fast_boot_lease got;
+    struct fast_boot_stats stats;
+
+    save_all();
+    reboot();
+
+    zassert_true(fast_boot_lease_apply(iface, &addr));
+
+    /* DHCP is granted another address, which comes up next to the cached one */
+    zassert_not_null(net_if_ipv4_addr_add(iface, &granted, NET_ADDR_DHCP, 3600));
+    zassert_not_null(find_addr(&addr));
+
+    zassert_false(fast_boot_lease_bound(iface, &addr, &granted, 3600));
+    zassert_is_null(find_addr(&addr));
+    zassert_equal(find_addr(&granted)->addr_type, NET_ADDR_DHCP);
+
+    fast_boot_get_stats(&stats);
+    zassert_equal(stats.failed, BIT(FAST_BOOT_LEASE));
+    reboot();
+    zassert_false(fast_boot_get(FAST_BOOT_LEASE, &got, sizeof(got)));
+}
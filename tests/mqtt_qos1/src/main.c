@@ -0,0 +1,182 @@
+/**
+ * @file main.c
+ * @brief QoS 1 in-flight window: packet identifiers, PUBACK matching, timeouts
+ *
+ * Time is passed in explicitly, so every test runs on a made-up clock.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "mqtt_qos1.h"
+
+#define WINDOW  CONFIG_APP_MQTT_QOS1_WINDOW
+#define TIMEOUT 500
+
+static struct mqtt_qos1_window window;
+
+/* Reserve and send one PUBLISH at @p now, returning its identifier */
+static uint16_t send_one(uint32_t now)
+{
+    uint16_t id;
+    int slot = mqtt_qos1_reserve(&window, &id);
+
+    zassert_true(slot >= 0, "reserve failed: %d", slot);
+    mqtt_qos1_sent(&window, slot, now);
+    return id;
+}
+
+static void qos1_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    mqtt_qos1_init(&window, TIMEOUT);
+}
+
+ZTEST_SUITE(mqtt_qos1, NULL, NULL, qos1_before, NULL, NULL);
+
+ZTEST(mqtt_qos1, test_ids_count_up_and_skip_zero)
+{
+    for (uint16_t expect = 1; expect <= 3; expect++) {
+        uint16_t id = send_one(1000);
+
+        zassert_equal(id, expect);
+        zassert_true(mqtt_qos1_ack(&window, id, 1010) >= 0);
+    }
+
+    /* Past 65535 the next identifier is 1, never 0 */
+    window.last_id = UINT16_MAX - 1;
+    zassert_equal(send_one(1000), UINT16_MAX);
+    zassert_equal(send_one(1000), 1);
+}
+
+ZTEST(mqtt_qos1, test_ids_in_flight_are_skipped)
+{
+    uint16_t held = send_one(1000);
+
+    zassert_equal(held, 1);
+
+    /* Wrap around while packet 1 still waits for its PUBACK */
+    window.last_id = UINT16_MAX;
+    zassert_equal(send_one(1000), 2);
+}
+
+ZTEST(mqtt_qos1, test_window_full)
+{
+    uint16_t ids[WINDOW];
+    uint16_t id;
+
+    for (int i = 0; i < WINDOW; i++) {
+        ids[i] = send_one(1000);
+    }
+
+    zassert_equal(mqtt_qos1_reserve(&window, &id), -EAGAIN);
+    zassert_equal(window.stats.window_full, 1);
+    zassert_equal(window.stats.in_flight, WINDOW);
+    zassert_equal(window.stats.in_flight_peak, WINDOW);
+
+    /* Any PUBACK frees a slot */
+    zassert_true(mqtt_qos1_ack(&window, ids[WINDOW / 2], 1020) >= 0);
+    zassert_true(mqtt_qos1_reserve(&window, &id) >= 0);
+}
+
+ZTEST(mqtt_qos1, test_acks_out_of_order)
+{
+    uint16_t a = send_one(1000);
+    uint16_t b = send_one(1001);
+    uint16_t c = send_one(1002);
+
+    zassert_true(mqtt_qos1_ack(&window, c, 1030) >= 0);
+    zassert_true(mqtt_qos1_ack(&window, a, 1040) >= 0);
+
+    /* Twice, or never sent */
+    zassert_equal(mqtt_qos1_ack(&window, a, 1041), -ENOENT);
+    zassert_equal(mqtt_qos1_ack(&window, 0, 1041), -ENOENT);
+    zassert_equal(mqtt_qos1_ack(&window, 999, 1041), -ENOENT);
+
+    zassert_true(mqtt_qos1_ack(&window, b, 1050) >= 0);
+    zassert_equal(window.stats.in_flight, 0);
+    zassert_equal(window.stats.acked, 3);
+}
+
+ZTEST(mqtt_qos1, test_reserved_slot_is_not_in_flight)
+{
+    uint16_t id;
+    int32_t wait;
+    int slot = mqtt_qos1_reserve(&window, &id);
+
+    zassert_true(slot >= 0);
+    zassert_equal(mqtt_qos1_next_due(&window, 100000, &wait), -ENOENT);
+    zassert_equal(wait, -1);
+    zassert_equal(mqtt_qos1_ack(&window, id, 100000), -ENOENT);
+
+    /* A failed send hands it back */
+    mqtt_qos1_release(&window, slot);
+    zassert_equal(window.stats.in_flight, 0);
+    zassert_equal(window.stats.sent, 0);
+}
+
+ZTEST(mqtt_qos1, test_overdue_publish_is_resent)
+{
+    int32_t wait;
+
+    send_one(1000);
+    send_one(1200);
+
+    zassert_equal(mqtt_qos1_next_due(&window, 1100, &wait), -ENOENT);
+    zassert_equal(wait, 400);
+
+    int slot = mqtt_qos1_next_due(&window, 1500, &wait);
+
+    zassert_true(slot >= 0);
+    zassert_equal(window.slots[slot].id, 1);
+
+    mqtt_qos1_resent(&window, slot, 1500, true);
+    zassert_equal(window.slots[slot].retries, 1);
+    zassert_true(window.slots[slot].dup);
+    zassert_equal(window.stats.retransmits, 1);
+
+    /* Packet 2 is next, then the resent packet 1 */
+    zassert_equal(mqtt_qos1_next_due(&window, 1600, &wait), -ENOENT);
+    zassert_equal(wait, 100);
+
+    /* A reconnect resend starts the retry count again */
+    mqtt_qos1_resent(&window, slot, 1650, false);
+    zassert_equal(window.slots[slot].retries, 0);
+}
+
+ZTEST(mqtt_qos1, test_timeout_across_clock_wrap)
+{
+    int32_t wait;
+
+    send_one(UINT32_MAX - 100);
+
+    zassert_equal(mqtt_qos1_next_due(&window, 200, &wait), -ENOENT);
+    zassert_equal(wait, TIMEOUT - 301);
+    zassert_true(mqtt_qos1_next_due(&window, TIMEOUT, &wait) >= 0);
+}
+
+ZTEST(mqtt_qos1, test_rtt_only_from_first_transmissions)
+{
+    uint16_t a = send_one(1000);
+
+    zassert_true(mqtt_qos1_ack(&window, a, 1040) >= 0);
+    zassert_equal(window.stats.rtt_last_ms, 40);
+    zassert_equal(window.stats.rtt_avg_ms, 40);
+
+    uint16_t b = send_one(2000);
+
+    zassert_true(mqtt_qos1_ack(&window, b, 2120) >= 0);
+    zassert_equal(window.stats.rtt_last_ms, 120);
+    zassert_equal(window.stats.rtt_avg_ms, 50);
+    zassert_equal(window.stats.rtt_max_ms, 120);
+
+    /* Resent: the PUBACK may answer either copy, so no sample is taken */
+    uint16_t c = send_one(3000);
+    int32_t wait;
+    int slot = mqtt_qos1_next_due(&window, 3000 + TIMEOUT, &wait);
+
+    mqtt_qos1_resent(&window, slot, 3000 + TIMEOUT, true);
+    zassert_true(mqtt_qos1_ack(&window, c, 3000 + TIMEOUT + 10) >= 0);
+    zassert_equal(window.stats.rtt_last_ms, 120);
+    zassert_equal(window.stats.acked, 3);
+}
@@ -0,0 +1,229 @@
+/**
+ * @file main.c
+ * @brief History ring drained into a QoS 1 window at the default sample rate
+ *
+ * Samples go into the ring at the rate the accelerometer produces them,
+ * one main loop's worth at a time, and a fake broker stands in for the
+ * MQTT client: its window holds CONFIG_APP_MQTT_QOS1_WINDOW publishes and
+ * empties one round trip after a wait, unless the broker is stalled.
+ * Every sample carries its sequence number in timestamp_ms, so each one
+ * can be followed into the broker, the store or the cursor's drop count.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "app_config.h"
+#include "sample_drain.h"
+#include "sensor_manager_internal.h"
+
+#define WINDOW          CONFIG_APP_MQTT_QOS1_WINDOW
+#define WAIT_BUDGET_MS  CONFIG_APP_MQTT_QOS1_WINDOW_WAIT_MS
+
+/* Matches sleep_cycle() in src/main.c */
+#define MAIN_LOOP_MS    5000
+#define LOOP_SAMPLES    (MAIN_LOOP_MS / CONFIG_APP_SENSOR_ACCEL_PERIOD_MS)
+
+/* PUBACK round trip of the fake broker */
+#define RTT_MS          20
+
+#define LOOPS           10
+#define MAX_SAMPLES     (LOOPS * LOOP_SAMPLES)
+
+struct fake_broker {
+    bool acking;                /* PUBACKs come back; false: window stalls */
+    bool storing;               /* store() accepts samples */
+    unsigned int in_flight;
+    uint32_t sent[MAX_SAMPLES];
+    unsigned int sent_count;
+    uint32_t stored[MAX_SAMPLES];
+    unsigned int stored_count;
+};
+
+static struct fake_broker broker;
+static struct sample_drain drain;
+static uint32_t next_seq;
+
+static int fake_send(const sensor_sample_t *sample, void *ctx)
+{
+    struct fake_broker *b = ctx;
+
+    if (b->in_flight == WINDOW) {
+        return -EAGAIN;
+    }
+    b->in_flight++;
+    b->sent[b->sent_count++] = sample->timestamp_ms;
+    return 0;
+}
+
+static int fake_wait(k_timeout_t timeout, void *ctx)
+{
+    struct fake_broker *b = ctx;
+
+    if (!b->acking) {
+        k_sleep(timeout);
+        return -EAGAIN;
+    }
+    k_sleep(K_MSEC(RTT_MS));
+    b->in_flight = 0;
+    return 0;
+}
+
+static int fake_store(const sensor_sample_t *sample, void *ctx)
+{
+    struct fake_broker *b = ctx;
+
+    if (!b->storing) {
+        return -ENOSPC;
+    }
+    b->stored[b->stored_count++] = sample->timestamp_ms;
+    return 0;
+}
+
+static const struct sample_drain_ops windowed_ops = {
+    .send = fake_send,
+    .wait = fake_wait,
+    .store = fake_store,
+};
+
+static const struct sample_drain_ops no_store_ops = {
+    .send = fake_send,
+    .wait = fake_wait,
+};
+
+/* The drain before bounded waits: a full window ends the pass */
+static const struct sample_drain_ops no_wait_ops = {
+    .send = fake_send,
+};
+
+/* Publish one main loop's worth of samples into the history ring */
+static void sample_one_loop(void)
+{
+    for (int i = 0; i < LOOP_SAMPLES; i++) {
+        sensor_sample_t sample = {
+            .timestamp_ms = next_seq++,
+            .valid_mask = SENSOR_FIELD_ALL,
+        };
+
+        history_publish(&sample);
+    }
+}
+
+/* Acks that arrive while the main loop sleeps */
+static void sleep_one_loop(void)
+{
+    if (broker.acking) {
+        broker.in_flight = 0;
+    }
+}
+
+static void assert_in_order(const uint32_t *seqs, unsigned int count, uint32_t first)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        zassert_equal(seqs[i], first + i, "sample %u out of order", i);
+    }
+}
+
+static void drain_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    memset(&broker, 0, sizeof(broker));
+    broker.acking = true;
+    broker.storing = true;
+    sample_drain_init(&drain, &windowed_ops, &broker, WAIT_BUDGET_MS);
+    next_seq = 0;
+}
+
+ZTEST_SUITE(sample_drain, NULL, NULL, drain_before, NULL, NULL);
+
+ZTEST(sample_drain, test_default_rate_against_acking_window)
+{
+    /* A loop's worth of window waits fits the budget */
+    zassert_true(DIV_ROUND_UP(LOOP_SAMPLES, WINDOW) * RTT_MS < WAIT_BUDGET_MS);
+
+    for (int loop = 0; loop < LOOPS; loop++) {
+        sample_one_loop();
+        zassert_equal(sample_drain_run(&drain, true), LOOP_SAMPLES);
+        sleep_one_loop();
+    }
+
+    zassert_equal(broker.sent_count, MAX_SAMPLES);
+    assert_in_order(broker.sent, broker.sent_count, 0);
+    zassert_equal(broker.stored_count, 0);
+    zassert_equal(drain.cursor.dropped, 0);
+    zassert_equal(drain.stats.stalls, 0);
+    zassert_true(drain.stats.waits > 0);
+}
+
+ZTEST(sample_drain, test_no_wait_overruns_ring)
+{
+    sample_drain_init(&drain, &no_wait_ops, &broker, WAIT_BUDGET_MS);
+
+    for (int loop = 0; loop < LOOPS; loop++) {
+        sample_one_loop();
+        sample_drain_run(&drain, true);
+        sleep_one_loop();
+    }
+
+    /* One window per loop goes out; the ring loses the rest */
+    zassert_equal(broker.sent_count, LOOPS * WINDOW);
+    zassert_true(drain.cursor.dropped > 0);
+}
+
+ZTEST(sample_drain, test_stalled_window_stores_the_rest)
+{
+    broker.acking = false;
+
+    for (int loop = 0; loop < 3; loop++) {
+        sample_one_loop();
+        zassert_equal(sample_drain_run(&drain, true), LOOP_SAMPLES);
+        sleep_one_loop();
+    }
+
+    /* The first window went out, everything after it is in the store */
+    zassert_equal(broker.sent_count, WINDOW);
+    assert_in_order(broker.sent, broker.sent_count, 0);
+    zassert_equal(broker.stored_count, 3 * LOOP_SAMPLES - WINDOW);
+    assert_in_order(broker.stored, broker.stored_count, WINDOW);
+    zassert_equal(drain.cursor.dropped, 0);
+    zassert_equal(drain.stats.stalls, 3);
+}
+
+ZTEST(sample_drain, test_disconnected_stores_everything)
+{
+    sample_one_loop();
+    zassert_equal(sample_drain_run(&drain, false), LOOP_SAMPLES);
+
+    zassert_equal(broker.sent_count, 0);
+    zassert_equal(broker.stored_count, LOOP_SAMPLES);
+    assert_in_order(broker.stored, broker.stored_count, 0);
+    zassert_equal(drain.stats.waits, 0);
+}
+
+ZTEST(sample_drain, test_store_failure_is_counted)
+{
+    broker.storing = false;
+
+    sample_one_loop();
+    zassert_equal(sample_drain_run(&drain, false), LOOP_SAMPLES);
+    zassert_equal(drain.stats.lost, LOOP_SAMPLES);
+}
+
+ZTEST(sample_drain, test_without_store_samples_wait_in_ring)
+{
+    sample_drain_init(&drain, &no_store_ops, &broker, WAIT_BUDGET_MS);
+    broker.acking = false;
+
+    sample_one_loop();
+    zassert_equal(sample_drain_run(&drain, true), WINDOW);
+    zassert_equal(broker.sent_count, WINDOW);
+
+    /* The broker catches up before the ring wraps */
+    broker.acking = true;
+    sleep_one_loop();
+    zassert_equal(sample_drain_run(&drain, true), LOOP_SAMPLES - WINDOW);
+
+    zassert_equal(broker.sent_count, LOOP_SAMPLES);
+    assert_in_order(broker.sent, broker.sent_count, 0);
+    zassert_equal(drain.cursor.dropped, 0);
+}
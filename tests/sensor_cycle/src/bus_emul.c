@@ -0,0 +1,147 @@
+/**
+ * @file bus_emul.c
+ * @brief Emulated I²C, SPI and ADC transfers behind the sensor driver API
+ */
+
+#include <zephyr/kernel.h>
+#include "sensor_drivers.h"
+#include "bus_emul.h"
+
+struct emul_bus {
+    struct k_timer timer;
+    atomic_t busy;
+
+    /* Behaviour of the next transfer */
+    uint32_t latency_ms;
+    int result;
+    int16_t value;
+
+    /* Transfer in flight, latched at submit */
+    sensor_channel_t channel;
+    void *dest;
+    int pending_result;
+    int16_t pending_value;
+    sensor_read_cb_t cb;
+    void *user_data;
+
+    struct bus_emul_stats stats;
+};
+
+static struct emul_bus buses[SENSOR_CHANNEL_COUNT];
+static bool timers_ready;
+
+static void bus_done(struct k_timer *timer)
+{
+    struct emul_bus *bus = CONTAINER_OF(timer, struct emul_bus, timer);
+
+    if (bus->pending_result == 0) {
+        switch (bus->channel) {
+        case SENSOR_CHANNEL_TEMP:
+            *(int16_t *)bus->dest = bus->pending_value;
+            break;
+        case SENSOR_CHANNEL_ACCEL: {
+            struct accel_raw_frame *frame = bus->dest;
+
+            frame->x = bus->pending_value;
+            frame->y = bus->pending_value;
+            frame->z = bus->pending_value;
+            break;
+        }
+        case SENSOR_CHANNEL_BATTERY:
+            *(uint16_t *)bus->dest = (uint16_t)bus->pending_value;
+            break;
+        default:
+            break;
+        }
+    }
+
+    bus->stats.completions++;
+    atomic_clear(&bus->busy);
+    bus->cb(bus->pending_result, bus->user_data);
+}
+
+static int bus_submit(sensor_channel_t channel, void *dest,
+                      sensor_read_cb_t cb, void *user_data)
+{
+    struct emul_bus *bus = &buses[channel];
+
+    if (dest == NULL || cb == NULL) {
+        return -EINVAL;
+    }
+
+    if (!atomic_cas(&bus->busy, 0, 1)) {
+        bus->stats.rejected++;
+        return -EBUSY;
+    }
+
+    bus->dest = dest;
+    bus->pending_result = bus->result;
+    bus->pending_value = bus->value;
+    bus->cb = cb;
+    bus->user_data = user_data;
+    bus->stats.submits++;
+
+    k_timer_start(&bus->timer, K_MSEC(bus->latency_ms), K_NO_WAIT);
+    return 0;
+}
+
+void bus_emul_reset(void)
+{
+    for (int ch = 0; ch < SENSOR_CHANNEL_COUNT; ch++) {
+        struct emul_bus *bus = &buses[ch];
+
+        if (timers_ready) {
+            k_timer_stop(&bus->timer);
+        }
+
+        *bus = (struct emul_bus){.channel = ch};
+        k_timer_init(&bus->timer, bus_done, NULL);
+    }
+
+    timers_ready = true;
+}
+
+void bus_emul_set(sensor_channel_t channel, uint32_t latency_ms, int result, int16_t value)
+{
+    struct emul_bus *bus = &buses[channel];
+
+    bus->latency_ms = latency_ms;
+    bus->result = result;
+    bus->value = value;
+}
+
+void bus_emul_get_stats(sensor_channel_t channel, struct bus_emul_stats *stats)
+{
+    *stats = buses[channel].stats;
+}
+
+int i2c_temp_sensor_init(void)
+{
+    return 0;
+}
+
+int i2c_temp_sensor_read_async(int16_t *raw, sensor_read_cb_t cb, void *user_data)
+{
+    return bus_submit(SENSOR_CHANNEL_TEMP, raw, cb, user_data);
+}
+
+int spi_accel_sensor_init(void)
+{
+    return 0;
+}
+
+int spi_accel_sensor_read_async(struct accel_raw_frame *frame,
+                                sensor_read_cb_t cb, void *user_data)
+{
+    return bus_submit(SENSOR_CHANNEL_ACCEL, frame, cb, user_data);
+}
+
+int adc_battery_init(void)
+{
+    return 0;
+}
+
+int adc_battery_read_async(uint16_t *millivolts, sensor_read_cb_t cb, void *user_data)
+{
+    return bus_submit(SENSOR_CHANNEL_BATTERY, millivolts, cb, user_data);
+}
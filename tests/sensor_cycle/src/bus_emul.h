@@ -0,0 +1,44 @@
+/**
+ * @file bus_emul.h
+ * @brief Emulated I²C, SPI and ADC transfers behind the sensor driver API
+ *
+ * Each channel's *_read_async() starts a transfer that completes from a
+ * timer, in interrupt context like a bus driver, after the channel's
+ * latency. One transfer per channel is in flight at a time; another
+ * submit meanwhile fails with -EBUSY, as with the real drivers.
+ */
+
+#ifndef BUS_EMUL_H
+#define BUS_EMUL_H
+
+#include <stdint.h>
+#include "sensor_manager.h"
+
+struct bus_emul_stats {
+    uint32_t submits;           /* Transfers started */
+    uint32_t rejected;          /* Submits refused with -EBUSY */
+    uint32_t completions;       /* Callbacks run */
+};
+
+/**
+ * @brief Stop every transfer in flight and zero the counters
+ */
+void bus_emul_reset(void);
+
+/**
+ * @brief Set how the next transfers of a channel behave
+ * @param channel Channel
+ * @param latency_ms Time from submit to completion
+ * @param result Result passed to the callback
+ * @param value Raw temperature, accelerometer count on every axis, or battery mV
+ */
+void bus_emul_set(sensor_channel_t channel, uint32_t latency_ms, int result, int16_t value);
+
+/**
+ * @brief Get the counters of a channel
+ * @param channel Channel
+ * @param stats Counters to fill
+ */
+void bus_emul_get_stats(sensor_channel_t channel, struct bus_emul_stats *stats);
+
+#endif /* BUS_EMUL_H */
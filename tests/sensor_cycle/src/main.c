@@ -0,0 +1,190 @@
+/**
+ * @file main.c
+ * @brief Overlapped sampling cycle against emulated buses
+ *
+ * sample_channels() runs here without the sensor thread. The drivers are
+ * replaced by bus_emul.c, whose transfers complete from a timer after a
+ * set latency, so the cycle's wall time and its handling of slow, late
+ * and busy buses can be measured on native_sim.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "app_config.h"
+#include "sensor_drivers.h"
+#include "sensor_manager_internal.h"
+#include "bus_emul.h"
+
+/* Bus latencies, far above the cost of the cycle itself */
+#define TEMP_BUS_MS     20
+#define ACCEL_BUS_MS    10
+#define BATTERY_BUS_MS  40
+
+/* Tick rounding and scheduling slack allowed on top of a latency */
+#define SLACK_MS        5
+
+/* A transfer that outlives the cycle's timeout */
+#define LATE_MS         (SENSOR_READ_TIMEOUT_MS + 50)
+
+#define TEMP_RAW        400
+#define ACCEL_RAW       256
+#define BATTERY_MV      3900
+
+#define TEMP_BIT        SENSOR_FIELD(SENSOR_CHANNEL_TEMP)
+#define BATTERY_BIT     SENSOR_FIELD(SENSOR_CHANNEL_BATTERY)
+
+static sensor_sample_t sample;
+
+static K_SEM_DEFINE(seq_done, 0, 1);
+static int seq_result;
+
+static void seq_complete(int result, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    seq_result = result;
+    k_sem_give(&seq_done);
+}
+
+/* The cycle before overlapping: each transfer waits for the previous one */
+static void sample_sequential(void)
+{
+    int16_t temp_raw;
+    struct accel_raw_frame accel_raw;
+    uint16_t battery_mv;
+
+    zassert_ok(i2c_temp_sensor_read_async(&temp_raw, seq_complete, NULL));
+    zassert_ok(k_sem_take(&seq_done, K_MSEC(SENSOR_READ_TIMEOUT_MS)));
+    zassert_ok(seq_result);
+
+    zassert_ok(spi_accel_sensor_read_async(&accel_raw, seq_complete, NULL));
+    zassert_ok(k_sem_take(&seq_done, K_MSEC(SENSOR_READ_TIMEOUT_MS)));
+    zassert_ok(seq_result);
+
+    zassert_ok(adc_battery_read_async(&battery_mv, seq_complete, NULL));
+    zassert_ok(k_sem_take(&seq_done, K_MSEC(SENSOR_READ_TIMEOUT_MS)));
+    zassert_ok(seq_result);
+}
+
+/* Run one cycle and return its wall time in microseconds */
+static uint32_t timed_cycle(uint8_t due)
+{
+    uint32_t start = k_cycle_get_32();
+
+    sample_channels(due, &sample);
+    return k_cyc_to_us_floor32(k_cycle_get_32() - start);
+}
+
+static void cycle_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    bus_emul_reset();
+    bus_emul_set(SENSOR_CHANNEL_TEMP, TEMP_BUS_MS, 0, TEMP_RAW);
+    bus_emul_set(SENSOR_CHANNEL_ACCEL, ACCEL_BUS_MS, 0, ACCEL_RAW);
+    bus_emul_set(SENSOR_CHANNEL_BATTERY, BATTERY_BUS_MS, 0, BATTERY_MV);
+
+    sample = (sensor_sample_t){0};
+    k_sem_reset(&seq_done);
+}
+
+ZTEST_SUITE(sensor_cycle, NULL, NULL, cycle_before, NULL, NULL);
+
+ZTEST(sensor_cycle, test_overlapped_cycle_costs_slowest_bus)
+{
+    uint32_t start = k_cycle_get_32();
+
+    sample_sequential();
+    uint32_t sequential_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    uint32_t overlapped_us = timed_cycle(SENSOR_FIELD_ALL);
+
+    TC_PRINT("sequential %u us, overlapped %u us, %u%% less per cycle\n",
+             sequential_us, overlapped_us,
+             100U - overlapped_us * 100U / sequential_us);
+
+    zassert_true(sequential_us >= (TEMP_BUS_MS + ACCEL_BUS_MS + BATTERY_BUS_MS) * 1000U,
+                 "sequential cycle took %u us", sequential_us);
+    zassert_true(overlapped_us >= BATTERY_BUS_MS * 1000U,
+                 "cycle ended before the slowest bus");
+    zassert_true(overlapped_us < (BATTERY_BUS_MS + SLACK_MS) * 1000U,
+                 "overlapped cycle took %u us", overlapped_us);
+
+    zassert_equal(sample.valid_mask, SENSOR_FIELD_ALL);
+    zassert_equal(sample.fresh_mask, SENSOR_FIELD_ALL);
+    zassert_equal(sample.temperature_cc, i2c_temp_sensor_raw_to_cc(TEMP_RAW));
+    zassert_equal(sample.accel_mg[2], spi_accel_sensor_raw_to_mg(ACCEL_RAW));
+    zassert_equal(sample.battery_mv, BATTERY_MV);
+}
+
+ZTEST(sensor_cycle, test_bus_error_invalidates_channel)
+{
+    timed_cycle(SENSOR_FIELD_ALL);
+    zassert_equal(sample.valid_mask, SENSOR_FIELD_ALL);
+
+    bus_emul_set(SENSOR_CHANNEL_BATTERY, BATTERY_BUS_MS, -EIO, 0);
+    sample.fresh_mask = 0;
+    timed_cycle(SENSOR_FIELD_ALL);
+
+    zassert_equal(sample.valid_mask, SENSOR_FIELD_ALL & ~BATTERY_BIT);
+    zassert_equal(sample.fresh_mask, SENSOR_FIELD_ALL & ~BATTERY_BIT);
+}
+
+ZTEST(sensor_cycle, test_late_completion_discarded)
+{
+    struct bus_emul_stats stats;
+
+    /* The battery outlives the cycle, which gives up on it */
+    bus_emul_set(SENSOR_CHANNEL_BATTERY, LATE_MS, 0, BATTERY_MV);
+    uint32_t elapsed_us = timed_cycle(TEMP_BIT | BATTERY_BIT);
+
+    zassert_true(elapsed_us >= SENSOR_READ_TIMEOUT_MS * 1000U, "cycle did not time out");
+    zassert_true(elapsed_us < LATE_MS * 1000U, "cycle waited for the late bus");
+    zassert_equal(sample.valid_mask, TEMP_BIT);
+
+    /* Its completion lands in the middle of the next cycle ... */
+    bus_emul_set(SENSOR_CHANNEL_TEMP, LATE_MS - SENSOR_READ_TIMEOUT_MS + 30, 0, TEMP_RAW + 16);
+    sample.fresh_mask = 0;
+    elapsed_us = timed_cycle(TEMP_BIT);
+
+    bus_emul_get_stats(SENSOR_CHANNEL_BATTERY, &stats);
+    zassert_equal(stats.completions, 1, "late completion missed the second cycle");
+
+    /* ... and must not end it before the temperature is in */
+    zassert_true(elapsed_us >= (LATE_MS - SENSOR_READ_TIMEOUT_MS + 30) * 1000U,
+                 "stale completion ended the cycle after %u us", elapsed_us);
+    zassert_equal(sample.fresh_mask, TEMP_BIT);
+    zassert_equal(sample.valid_mask, TEMP_BIT);
+    zassert_equal(sample.temperature_cc, i2c_temp_sensor_raw_to_cc(TEMP_RAW + 16));
+}
+
+ZTEST(sensor_cycle, test_busy_bus_resubmitted_after_timeout)
+{
+    struct bus_emul_stats stats;
+
+    bus_emul_set(SENSOR_CHANNEL_BATTERY, LATE_MS, 0, BATTERY_MV);
+    timed_cycle(SENSOR_FIELD_ALL);
+    zassert_equal(sample.valid_mask, SENSOR_FIELD_ALL & ~BATTERY_BIT);
+
+    /* The conversion is still running: the resubmit is refused and the
+     * cycle does not wait on it */
+    bus_emul_set(SENSOR_CHANNEL_BATTERY, BATTERY_BUS_MS, 0, BATTERY_MV - 100);
+    uint32_t elapsed_us = timed_cycle(SENSOR_FIELD_ALL);
+
+    bus_emul_get_stats(SENSOR_CHANNEL_BATTERY, &stats);
+    zassert_equal(stats.rejected, 1);
+    zassert_equal(stats.completions, 0);
+    zassert_true(elapsed_us < (TEMP_BUS_MS + SLACK_MS) * 1000U,
+                 "cycle waited %u us on a busy bus", elapsed_us);
+    zassert_equal(sample.valid_mask, SENSOR_FIELD_ALL & ~BATTERY_BIT);
+
+    /* Once the late conversion finishes the channel reads again */
+    k_msleep(LATE_MS);
+    sample.fresh_mask = 0;
+    timed_cycle(BATTERY_BIT);
+
+    bus_emul_get_stats(SENSOR_CHANNEL_BATTERY, &stats);
+    zassert_equal(stats.submits, 2);
+    zassert_equal(stats.completions, 2);
+    zassert_equal(sample.fresh_mask, BATTERY_BIT);
+    zassert_equal(sample.battery_mv, BATTERY_MV - 100);
+}
@@ -0,0 +1,240 @@
+/**
+ * @file adxl345_emul.c
+ * @brief Emulated ADXL345 on the SPI emulator bus
+ */
+
+#define DT_DRV_COMPAT test_adxl345_emul
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include "adxl345_emul.h"
+
+#define REG_COUNT        0x40
+#define REG_DEVID        0x00
+#define REG_DATAX0       0x32
+#define REG_DATA_LEN     6
+#define REG_FIFO_CTL     0x38
+#define REG_FIFO_STATUS  0x39
+
+#define CMD_READ         0x80
+#define CMD_MULTIBYTE    0x40
+#define CMD_ADDR         0x3F
+
+#define DEVID            0xE5
+#define FIFO_MODE        0xC0    /* FIFO_CTL mode bits; 0 is bypass */
+
+/* Command byte plus the six data registers */
+#define MAX_TRANSFER     (1 + REG_DATA_LEN)
+
+static uint8_t regs[REG_COUNT];
+static struct accel_raw_frame fifo[ACCEL_FIFO_DEPTH];
+static size_t fifo_head;
+static size_t fifo_count;
+static struct accel_raw_frame latest;
+static uint32_t transfers;
+
+void adxl345_emul_reset(void)
+{
+    fifo_head = 0;
+    fifo_count = 0;
+    latest = (struct accel_raw_frame){0};
+    transfers = 0;
+}
+
+void adxl345_emul_push(const struct accel_raw_frame *frames, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        latest = frames[i];
+
+        if ((regs[REG_FIFO_CTL] & FIFO_MODE) == 0) {
+            continue;
+        }
+
+        /* Stream mode: a full FIFO drops its oldest frame */
+        if (fifo_count == ACCEL_FIFO_DEPTH) {
+            fifo_head = (fifo_head + 1) % ACCEL_FIFO_DEPTH;
+            fifo_count--;
+        }
+        fifo[(fifo_head + fifo_count) % ACCEL_FIFO_DEPTH] = frames[i];
+        fifo_count++;
+    }
+}
+
+size_t adxl345_emul_fifo_level(void)
+{
+    return fifo_count;
+}
+
+uint8_t adxl345_emul_reg(uint8_t reg)
+{
+    return regs[reg & CMD_ADDR];
+}
+
+uint32_t adxl345_emul_transfers(void)
+{
+    return transfers;
+}
+
+static uint8_t reg_read(uint8_t reg, const struct accel_raw_frame *out)
+{
+    if (reg == REG_FIFO_STATUS) {
+        return (uint8_t)fifo_count;
+    }
+
+    if (reg >= REG_DATAX0 && reg < REG_DATAX0 + REG_DATA_LEN) {
+        uint8_t data[REG_DATA_LEN];
+
+        sys_put_le16((uint16_t)out->x, &data[0]);
+        sys_put_le16((uint16_t)out->y, &data[2]);
+        sys_put_le16((uint16_t)out->z, &data[4]);
+        return data[reg - REG_DATAX0];
+    }
+
+    return regs[reg];
+}
+
+static void reg_write(uint8_t reg, uint8_t value)
+{
+    regs[reg] = value;
+
+    if (reg == REG_FIFO_CTL && (value & FIFO_MODE) == 0) {
+        /* Bypass mode empties the FIFO */
+        fifo_head = 0;
+        fifo_count = 0;
+    }
+}
+
+/* Bytes clocked for @p set */
+static int set_len(const struct spi_buf_set *set, size_t *len)
+{
+    *len = 0;
+    if (set == NULL) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < set->count; i++) {
+        *len += set->buffers[i].len;
+    }
+    return (*len > MAX_TRANSFER) ? -EIO : 0;
+}
+
+/* Bytes clocked out of @p set, dummy bytes for NULL buffers */
+static void gather(const struct spi_buf_set *set, uint8_t *bytes)
+{
+    size_t off = 0;
+
+    if (set == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < set->count; i++) {
+        const struct spi_buf *buf = &set->buffers[i];
+
+        if (buf->buf != NULL) {
+            memcpy(&bytes[off], buf->buf, buf->len);
+        }
+        off += buf->len;
+    }
+}
+
+/* Bytes clocked into @p set, skipping NULL buffers */
+static void scatter(const struct spi_buf_set *set, const uint8_t *bytes)
+{
+    size_t off = 0;
+
+    if (set == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < set->count; i++) {
+        const struct spi_buf *buf = &set->buffers[i];
+
+        if (buf->buf != NULL) {
+            memcpy(buf->buf, &bytes[off], buf->len);
+        }
+        off += buf->len;
+    }
+}
+
+static int adxl345_emul_io(const struct emul *target, const struct spi_config *config,
+                           const struct spi_buf_set *tx_bufs,
+                           const struct spi_buf_set *rx_bufs)
+{
+    uint8_t mosi[MAX_TRANSFER] = {0};
+    uint8_t miso[MAX_TRANSFER] = {0};
+    size_t tx_len;
+    size_t rx_len;
+
+    ARG_UNUSED(target);
+    ARG_UNUSED(config);
+
+    if (set_len(tx_bufs, &tx_len) != 0 || set_len(rx_bufs, &rx_len) != 0) {
+        return -EIO;
+    }
+    gather(tx_bufs, mosi);
+
+    size_t len = MAX(tx_len, rx_len);
+
+    if (len == 0) {
+        return -EIO;
+    }
+
+    uint8_t reg = mosi[0] & CMD_ADDR;
+    bool multi = (mosi[0] & CMD_MULTIBYTE) != 0;
+
+    transfers++;
+
+    if (!(mosi[0] & CMD_READ)) {
+        for (size_t i = 1; i < len; i++) {
+            reg_write((reg + (multi ? i - 1 : 0)) & CMD_ADDR, mosi[i]);
+        }
+        return 0;
+    }
+
+    /* The output registers hold the FIFO head until the read ends */
+    const struct accel_raw_frame out = (fifo_count > 0) ? fifo[fifo_head] : latest;
+    bool data_read = false;
+
+    for (size_t i = 1; i < len; i++) {
+        uint8_t addr = (reg + (multi ? i - 1 : 0)) & CMD_ADDR;
+
+        miso[i] = reg_read(addr, &out);
+        data_read |= (addr >= REG_DATAX0 && addr < REG_DATAX0 + REG_DATA_LEN);
+    }
+
+    if (data_read && fifo_count > 0) {
+        fifo_head = (fifo_head + 1) % ACCEL_FIFO_DEPTH;
+        fifo_count--;
+    }
+
+    scatter(rx_bufs, miso);
+    return 0;
+}
+
+static const struct spi_emul_api adxl345_emul_api = {
+    .io = adxl345_emul_io,
+};
+
+static int adxl345_emul_init(const struct emul *target, const struct device *parent)
+{
+    ARG_UNUSED(target);
+    ARG_UNUSED(parent);
+
+    memset(regs, 0, sizeof(regs));
+    regs[REG_DEVID] = DEVID;
+    adxl345_emul_reset();
+    return 0;
+}
+
+/* The emulator hangs off a device; the driver under test talks to the bus */
+#define ADXL345_EMUL(n)                                                         \
+    DEVICE_DT_INST_DEFINE(n, NULL, NULL, NULL, NULL, POST_KERNEL,               \
+                          CONFIG_APPLICATION_INIT_PRIORITY, NULL);              \
+    EMUL_DT_INST_DEFINE(n, adxl345_emul_init, NULL, NULL, &adxl345_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(ADXL345_EMUL)
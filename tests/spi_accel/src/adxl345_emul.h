@@ -0,0 +1,45 @@
+/**
+ * @file adxl345_emul.h
+ * @brief Emulated ADXL345 on the SPI emulator bus
+ *
+ * Holds the register file and a 32-entry FIFO. In stream mode frames
+ * pushed by the test queue up, the oldest overwritten when full, and a
+ * multi-byte read of the six data registers pops one. In bypass mode the
+ * data registers show the last frame pushed.
+ */
+
+#ifndef ADXL345_EMUL_H
+#define ADXL345_EMUL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_drivers.h"
+
+/**
+ * @brief Empty the FIFO and zero the transfer count; registers are kept
+ */
+void adxl345_emul_reset(void);
+
+/**
+ * @brief Produce frames as the part would at its output data rate
+ * @param frames Frames, oldest first
+ * @param count Number of frames
+ */
+void adxl345_emul_push(const struct accel_raw_frame *frames, size_t count);
+
+/**
+ * @brief Frames waiting in the FIFO
+ */
+size_t adxl345_emul_fifo_level(void);
+
+/**
+ * @brief Value last written to a register
+ */
+uint8_t adxl345_emul_reg(uint8_t reg);
+
+/**
+ * @brief SPI transactions (chip select cycles) since the last reset
+ */
+uint32_t adxl345_emul_transfers(void);
+
+#endif /* ADXL345_EMUL_H */
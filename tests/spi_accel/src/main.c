@@ -0,0 +1,217 @@
+/**
+ * @file main.c
+ * @brief ADXL345 FIFO stream, burst drain and async read against an emulated part
+ *
+ * The driver is built with USE_REAL_SPI_SENSOR and talks to adxl345_emul
+ * through the SPI emulator, so every check is on the registers it wrote
+ * and the transactions it made.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "sensor_drivers.h"
+#include "adxl345_emul.h"
+
+#define REG_BW_RATE      0x2C
+#define REG_POWER_CTL    0x2D
+#define REG_DATA_FORMAT  0x31
+#define REG_FIFO_CTL     0x38
+
+#define FIFO_STREAM      0x80
+
+static struct accel_raw_frame make_frame(int i)
+{
+    return (struct accel_raw_frame){
+        .x = (int16_t)i,
+        .y = (int16_t)-i,
+        .z = (int16_t)(256 + i),
+    };
+}
+
+static void push_range(int first, int count)
+{
+    for (int i = first; i < first + count; i++) {
+        struct accel_raw_frame frame = make_frame(i);
+
+        adxl345_emul_push(&frame, 1);
+    }
+}
+
+static void check_range(const struct accel_raw_frame *frames, int first, int count)
+{
+    for (int i = 0; i < count; i++) {
+        struct accel_raw_frame want = make_frame(first + i);
+
+        zassert_equal(frames[i].x, want.x, "frame %d", first + i);
+        zassert_equal(frames[i].y, want.y, "frame %d", first + i);
+        zassert_equal(frames[i].z, want.z, "frame %d", first + i);
+    }
+}
+
+static void *spi_accel_setup(void)
+{
+    zassert_ok(spi_accel_sensor_init());
+    return NULL;
+}
+
+static void spi_accel_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_ok(spi_accel_sensor_stream_stop());
+    adxl345_emul_reset();
+}
+
+ZTEST_SUITE(spi_accel, NULL, spi_accel_setup, spi_accel_before, NULL, NULL);
+
+ZTEST(spi_accel, test_init_starts_measuring)
+{
+    zassert_equal(adxl345_emul_reg(REG_DATA_FORMAT), 0x08, "not full resolution");
+    zassert_equal(adxl345_emul_reg(REG_POWER_CTL), 0x08, "not measuring");
+}
+
+ZTEST(spi_accel, test_rate_codes)
+{
+    /* BW_RATE codes 0x08..0x0F, doubling from 25 Hz */
+    static const struct {
+        uint16_t odr_hz;
+        uint8_t code;
+    } rates[] = {
+        {25, 0x08}, {50, 0x09}, {100, 0x0A}, {200, 0x0B},
+        {400, 0x0C}, {800, 0x0D}, {1600, 0x0E}, {3200, 0x0F},
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(rates); i++) {
+        zassert_ok(spi_accel_sensor_stream_start(rates[i].odr_hz, 16));
+        zassert_equal(adxl345_emul_reg(REG_BW_RATE), rates[i].code,
+                      "%u Hz", rates[i].odr_hz);
+        zassert_equal(adxl345_emul_reg(REG_FIFO_CTL), FIFO_STREAM | 16);
+    }
+}
+
+ZTEST(spi_accel, test_unsupported_rates_rejected)
+{
+    static const uint16_t bad[] = {0, 12, 24, 26, 300, 401, 3199, 6400};
+
+    zassert_ok(spi_accel_sensor_stream_start(400, 16));
+    adxl345_emul_reset();
+
+    for (size_t i = 0; i < ARRAY_SIZE(bad); i++) {
+        zassert_equal(spi_accel_sensor_stream_start(bad[i], 16), -EINVAL,
+                      "%u Hz", bad[i]);
+    }
+
+    /* Rejected before touching the part */
+    zassert_equal(adxl345_emul_transfers(), 0);
+    zassert_equal(adxl345_emul_reg(REG_BW_RATE), 0x0C);
+}
+
+ZTEST(spi_accel, test_watermark_limits)
+{
+    zassert_equal(spi_accel_sensor_stream_start(400, 0), -EINVAL);
+    zassert_equal(spi_accel_sensor_stream_start(400, ACCEL_FIFO_DEPTH), -EINVAL);
+    zassert_equal(spi_accel_sensor_stream_start(400, 0xFF), -EINVAL);
+    zassert_equal(adxl345_emul_transfers(), 0);
+
+    zassert_ok(spi_accel_sensor_stream_start(400, 1));
+    zassert_equal(adxl345_emul_reg(REG_FIFO_CTL), FIFO_STREAM | 1);
+
+    zassert_ok(spi_accel_sensor_stream_start(400, ACCEL_FIFO_DEPTH - 1));
+    zassert_equal(adxl345_emul_reg(REG_FIFO_CTL), FIFO_STREAM | (ACCEL_FIFO_DEPTH - 1));
+}
+
+ZTEST(spi_accel, test_fifo_read_needs_stream)
+{
+    struct accel_raw_frame frames[4];
+
+    zassert_equal(spi_accel_sensor_fifo_read(frames, ARRAY_SIZE(frames)), -EPERM);
+    zassert_equal(adxl345_emul_reg(REG_FIFO_CTL), 0, "not back in bypass");
+}
+
+ZTEST(spi_accel, test_burst_drain)
+{
+    struct accel_raw_frame frames[ACCEL_FIFO_DEPTH];
+
+    zassert_ok(spi_accel_sensor_stream_start(400, 16));
+    adxl345_emul_reset();
+    push_range(0, 20);
+
+    zassert_equal(spi_accel_sensor_fifo_read(frames, ARRAY_SIZE(frames)), 20);
+    check_range(frames, 0, 20);
+    zassert_equal(adxl345_emul_fifo_level(), 0);
+
+    /* One status read, then one six-byte read per frame */
+    zassert_equal(adxl345_emul_transfers(), 1 + 20);
+
+    /* An empty FIFO costs only the status read */
+    zassert_equal(spi_accel_sensor_fifo_read(frames, ARRAY_SIZE(frames)), 0);
+    zassert_equal(adxl345_emul_transfers(), 1 + 20 + 1);
+}
+
+ZTEST(spi_accel, test_drain_bounded_by_buffer)
+{
+    struct accel_raw_frame frames[10];
+    struct accel_raw_frame rest[ACCEL_FIFO_DEPTH];
+
+    zassert_ok(spi_accel_sensor_stream_start(400, 16));
+    adxl345_emul_reset();
+    push_range(0, 25);
+
+    zassert_equal(spi_accel_sensor_fifo_read(frames, ARRAY_SIZE(frames)), 10);
+    check_range(frames, 0, 10);
+    zassert_equal(adxl345_emul_fifo_level(), 15, "frames popped beyond the buffer");
+
+    zassert_equal(spi_accel_sensor_fifo_read(rest, ARRAY_SIZE(rest)), 15);
+    check_range(rest, 10, 15);
+}
+
+ZTEST(spi_accel, test_full_fifo_drains_newest)
+{
+    struct accel_raw_frame frames[ACCEL_FIFO_DEPTH + 8];
+
+    zassert_ok(spi_accel_sensor_stream_start(400, 16));
+    adxl345_emul_reset();
+
+    /* Drained too late: the part kept the newest 32 */
+    push_range(0, ACCEL_FIFO_DEPTH + 8);
+
+    zassert_equal(spi_accel_sensor_fifo_read(frames, ARRAY_SIZE(frames)), ACCEL_FIFO_DEPTH);
+    check_range(frames, 8, ACCEL_FIFO_DEPTH);
+}
+
+static K_SEM_DEFINE(read_done, 0, 1);
+static int read_result;
+
+static void read_complete(int result, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    read_result = result;
+    k_sem_give(&read_done);
+}
+
+ZTEST(spi_accel, test_read_async_single_frame)
+{
+    struct accel_raw_frame frame = {0};
+    struct accel_raw_frame want = make_frame(7);
+
+    adxl345_emul_push(&want, 1);
+    k_sem_reset(&read_done);
+
+    zassert_equal(spi_accel_sensor_read_async(NULL, read_complete, NULL), -EINVAL);
+    zassert_equal(spi_accel_sensor_read_async(&frame, NULL, NULL), -EINVAL);
+
+    /* The emulator has no async API, so this is the blocking fallback */
+    zassert_ok(spi_accel_sensor_read_async(&frame, read_complete, NULL));
+    zassert_ok(k_sem_take(&read_done, K_MSEC(100)));
+    zassert_ok(read_result);
+    check_range(&frame, 7, 1);
+    zassert_equal(adxl345_emul_transfers(), 1, "frame not read in one transaction");
+
+    /* The completion released the channel for the next cycle */
+    want = make_frame(8);
+    adxl345_emul_push(&want, 1);
+    zassert_ok(spi_accel_sensor_read_async(&frame, read_complete, NULL));
+    zassert_ok(k_sem_take(&read_done, K_MSEC(100)));
+    check_range(&frame, 8, 1);
+}
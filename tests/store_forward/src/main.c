@@ -0,0 +1,228 @@
+/**
+ * @file main.c
+ * @brief Store-and-forward log on the native_sim flash simulator
+ *
+ * Every test starts from an erased log and cursor. A reboot is
+ * store_forward_init() run again: the log reopens from flash and the
+ * cursor from settings, with nothing carried over in RAM.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#include "store_forward.h"
+
+/* More than the eight-sector log holds */
+#define OVERFILL 2000
+
+static sensor_sample_t make_sample(uint32_t i)
+{
+    return (sensor_sample_t){
+        .timestamp_ms = 1000 + i * 100,
+        .temperature_cc = (int16_t)i,
+        .accel_mg = {(int16_t)i, 0, 1000},
+        .battery_mv = 3900,
+        .valid_mask = 0x07,
+    };
+}
+
+static void append_range(uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < first + count; i++) {
+        sensor_sample_t sample = make_sample(i);
+
+        zassert_ok(store_forward_append(&sample, 1), "sample %u", i);
+    }
+}
+
+/* Peek, check and confirm @p count samples that must start at @p first */
+static void replay_range(uint32_t first, uint32_t count)
+{
+    sensor_sample_t got[16];
+    uint32_t seq;
+
+    while (count > 0) {
+        int n = store_forward_peek(got, MIN(count, ARRAY_SIZE(got)), &seq);
+
+        zassert_true(n > 0, "peek returned %d with %u left", n, count);
+        for (int k = 0; k < n; k++) {
+            zassert_equal(got[k].timestamp_ms, make_sample(first + k).timestamp_ms,
+                          "sample %u out of order", first + k);
+        }
+        zassert_ok(store_forward_ack(seq));
+        first += n;
+        count -= n;
+    }
+}
+
+static void reboot(void)
+{
+    zassert_ok(store_forward_init());
+}
+
+static void *store_setup(void)
+{
+    zassert_ok(settings_subsys_init());
+    return NULL;
+}
+
+static void store_before(void *fixture)
+{
+    const struct flash_area *fa;
+
+    ARG_UNUSED(fixture);
+
+    zassert_ok(flash_area_open(FIXED_PARTITION_ID(store_partition), &fa));
+    zassert_ok(flash_area_erase(fa, 0, flash_area_get_size(fa)));
+    flash_area_close(fa);
+    settings_delete("saf/acked");
+
+    zassert_ok(store_forward_init());
+    zassert_equal(store_forward_pending(), 0);
+}
+
+ZTEST_SUITE(store_forward, NULL, store_setup, store_before, NULL, NULL);
+
+ZTEST(store_forward, test_replay_in_order)
+{
+    struct store_forward_stats stats;
+
+    append_range(0, 40);
+    zassert_equal(store_forward_pending(), 40);
+
+    replay_range(0, 25);
+    zassert_equal(store_forward_pending(), 15);
+
+    /* Live appends queue behind the backlog */
+    append_range(40, 10);
+    replay_range(25, 25);
+
+    store_forward_get_stats(&stats);
+    zassert_equal(stats.pending, 0);
+    zassert_equal(stats.stored, 50);
+    zassert_equal(stats.replayed, 50);
+    zassert_equal(stats.dropped, 0);
+}
+
+ZTEST(store_forward, test_cursor_survives_reboot)
+{
+    append_range(0, 30);
+    replay_range(0, 12);
+
+    reboot();
+    zassert_equal(store_forward_pending(), 18);
+    replay_range(12, 18);
+
+    /* Sequence numbers carry on after the reboot */
+    append_range(30, 5);
+    reboot();
+    zassert_equal(store_forward_pending(), 5);
+    replay_range(30, 5);
+}
+
+ZTEST(store_forward, test_unconfirmed_samples_replay_again)
+{
+    sensor_sample_t got[8];
+    uint32_t seq;
+
+    append_range(0, 20);
+    zassert_equal(store_forward_peek(got, ARRAY_SIZE(got), &seq), 8);
+
+    /* Reset between publish and ack: the group is sent again */
+    reboot();
+    zassert_equal(store_forward_pending(), 20);
+    replay_range(0, 20);
+}
+
+ZTEST(store_forward, test_ack_is_idempotent)
+{
+    sensor_sample_t got[8];
+    uint32_t seq;
+
+    append_range(0, 20);
+    zassert_equal(store_forward_peek(got, ARRAY_SIZE(got), &seq), 8);
+    zassert_ok(store_forward_ack(seq));
+    zassert_equal(store_forward_pending(), 12);
+
+    /* A PUBACK resent after a reconnect confirms nothing new */
+    zassert_ok(store_forward_ack(seq));
+    zassert_equal(store_forward_pending(), 12);
+    zassert_equal(store_forward_ack(seq + 100), -EINVAL);
+
+    replay_range(8, 12);
+}
+
+ZTEST(store_forward, test_group_erased_in_flight)
+{
+    struct store_forward_stats stats;
+    sensor_sample_t got[8];
+    uint32_t seq;
+
+    append_range(0, 20);
+    zassert_equal(store_forward_peek(got, ARRAY_SIZE(got), &seq), 8);
+
+    /* The log fills while the group waits for its PUBACK */
+    append_range(20, OVERFILL);
+    store_forward_get_stats(&stats);
+    zassert_true(stats.dropped >= 8, "oldest sector not erased");
+
+    /* The late ack confirms nothing that was not sent */
+    uint32_t pending = store_forward_pending();
+
+    zassert_ok(store_forward_ack(seq));
+    zassert_equal(store_forward_pending(), pending);
+    replay_range(stats.dropped, pending);
+}
+
+ZTEST(store_forward, test_full_log_drops_oldest)
+{
+    struct store_forward_stats stats;
+
+    append_range(0, OVERFILL);
+
+    store_forward_get_stats(&stats);
+    zassert_true(stats.dropped > 0, "log never filled");
+    zassert_true(stats.erased > 0);
+    zassert_equal(stats.pending + stats.dropped, OVERFILL);
+
+    /* What is left is the newest samples, still in order */
+    replay_range(stats.dropped, stats.pending);
+    zassert_equal(store_forward_pending(), 0);
+}
+
+ZTEST(store_forward, test_drained_log_never_drops)
+{
+    struct store_forward_stats stats;
+    uint32_t next = 0;
+
+    /* Several laps around the sectors, half a log at a time */
+    for (int lap = 0; lap < 10; lap++) {
+        append_range(next, 500);
+        replay_range(next, 500);
+        next += 500;
+    }
+
+    store_forward_get_stats(&stats);
+    zassert_equal(stats.dropped, 0);
+    zassert_true(stats.erased >= 8, "only %u sector erases", stats.erased);
+
+    /* Confirmed sectors were erased as they emptied, so a full backlog fits again */
+    reboot();
+    zassert_equal(store_forward_pending(), 0);
+    append_range(next, 500);
+    replay_range(next, 500);
+}
+
+ZTEST(store_forward, test_clear)
+{
+    append_range(0, 10);
+    zassert_ok(store_forward_clear());
+    zassert_equal(store_forward_pending(), 0);
+
+    reboot();
+    zassert_equal(store_forward_pending(), 0);
+
+    append_range(10, 3);
+    replay_range(10, 3);
+}
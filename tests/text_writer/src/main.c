@@ -0,0 +1,223 @@
+/**
+ * @file main.c
+ * @brief text_writer output, into a buffer and streamed through a sink
+ *
+ * Fixed-point output is checked against snprintf("%.Nf"), which is built
+ * with floating-point support for this test only.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdio.h>
+#include <string.h>
+#include "text_writer.h"
+
+/* Collects streamed output */
+struct capture {
+    char buf[128];
+    size_t len;
+    unsigned int flushes;
+};
+
+static int capture_sink(const char *data, size_t len, void *ctx)
+{
+    struct capture *cap = ctx;
+
+    if (cap->len + len > sizeof(cap->buf)) {
+        return -ENOSPC;
+    }
+    memcpy(&cap->buf[cap->len], data, len);
+    cap->len += len;
+    cap->flushes++;
+    return 0;
+}
+
+static int never_sink(const char *data, size_t len, void *ctx)
+{
+    ARG_UNUSED(data);
+    ARG_UNUSED(len);
+    ARG_UNUSED(ctx);
+
+    ztest_test_fail();
+    return -EIO;
+}
+
+static uint32_t rng_state = 0x2545f491;
+
+/* Uniform integer in [-amplitude, amplitude], xorshift32 */
+static int32_t noise(int32_t amplitude)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    return (int32_t)(rng_state % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+/* text_format_fixed() gives what snprintf gives, at every precision */
+static void check_fixed(float value, unsigned int max_decimals)
+{
+    char ours[TEXT_FIXED_MAX_LEN];
+    char ref[TEXT_FIXED_MAX_LEN];
+
+    for (unsigned int decimals = 0; decimals <= max_decimals; decimals++) {
+        int len = snprintf(ref, sizeof(ref), "%.*f", (int)decimals, (double)value);
+
+        zassert_equal(text_format_fixed(ours, sizeof(ours), value, decimals), len,
+                      "%.*f of %a", (int)decimals, (double)value);
+        zassert_str_equal(ours, ref, "%.*f of %a", (int)decimals, (double)value);
+    }
+}
+
+/* A small JSON object of every put function */
+static void write_record(struct text_writer *w)
+{
+    text_put_str(w, "{\"id\":\"node\",\"n\":");
+    text_put_uint(w, 4294967295U);
+    text_put_str(w, ",\"d\":");
+    text_put_int(w, -2147483647 - 1);
+    text_put_str(w, ",\"t\":");
+    text_put_fixed(w, -21.375f, 2);
+    text_put_char(w, '}');
+}
+
+ZTEST_SUITE(text_writer, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(text_writer, test_stream_matches_buffer)
+{
+    static const char expected[] =
+        "{\"id\":\"node\",\"n\":4294967295,\"d\":-2147483648,\"t\":-21.38}";
+    char buf[sizeof(expected)];
+    struct text_writer w;
+
+    text_writer_init(&w, buf, sizeof(buf));
+    write_record(&w);
+    zassert_equal(text_finish(&w), strlen(expected));
+    zassert_str_equal(buf, expected);
+
+    /* Every staging size, down to one byte, gives the same bytes */
+    for (size_t size = 1; size <= sizeof(expected); size++) {
+        struct capture cap = {0};
+        char chunk[sizeof(expected)];
+
+        text_writer_init_stream(&w, chunk, size, capture_sink, &cap);
+        write_record(&w);
+        zassert_equal(text_finish(&w), strlen(expected), "staging %u", (unsigned int)size);
+        zassert_equal(cap.len, strlen(expected));
+        zassert_mem_equal(cap.buf, expected, cap.len, "staging %u", (unsigned int)size);
+    }
+}
+
+ZTEST(text_writer, test_stream_sink_error)
+{
+    struct capture cap = {.len = sizeof(cap.buf)};
+    char chunk[8];
+    struct text_writer w;
+
+    /* The first error stops the stream and is what text_finish() reports */
+    text_writer_init_stream(&w, chunk, sizeof(chunk), capture_sink, &cap);
+    write_record(&w);
+    zassert_equal(text_finish(&w), -ENOSPC);
+    zassert_equal(cap.flushes, 0);
+}
+
+ZTEST(text_writer, test_zero_stream_buffer)
+{
+    struct text_writer w;
+
+    /* Must fail rather than spin flushing nothing */
+    text_writer_init_stream(&w, NULL, 0, never_sink, NULL);
+    text_put_str(&w, "{\"t\":");
+    text_put_fixed(&w, 21.5f, 2);
+    zassert_equal(text_finish(&w), -EINVAL);
+}
+
+ZTEST(text_writer, test_fixed_matches_snprintf)
+{
+    /* Every magnitude the encoders print, ties included */
+    for (int i = 0; i < 20000; i++) {
+        int32_t mantissa = noise(1 << 20);
+        float value = (float)mantissa / (float)(1 << (i % 24));
+
+        if (i % 4 == 0) {
+            value = (float)mantissa / 8.0f;     /* Exact ties at 2 decimals */
+        }
+        check_fixed(value, 4);
+    }
+}
+
+ZTEST(text_writer, test_fixed_negative)
+{
+    static const float values[] = {
+        -0.0f, -1e-30f, -0.001f, -0.004999f, -0.5f, -1.0f, -21.375f,
+        -327.68f, -16000.0f, -2147483648.0f, -3.4028235e38f,
+    };
+    char buf[TEXT_FIXED_MAX_LEN];
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        check_fixed(values[i], TEXT_FIXED_MAX_DECIMALS);
+    }
+
+    /* The sign stays on values that round to zero */
+    zassert_equal(text_format_fixed(buf, sizeof(buf), -0.001f, 2), 5);
+    zassert_str_equal(buf, "-0.00");
+    zassert_equal(text_format_fixed(buf, sizeof(buf), -21.375f, 2), 6);
+    zassert_str_equal(buf, "-21.38");
+}
+
+ZTEST(text_writer, test_fixed_rounding_carry)
+{
+    static const struct {
+        float value;
+        unsigned int decimals;
+        const char *text;
+    } cases[] = {
+        {9.9999f, 2, "10.00"},          /* Carry into a new integer digit */
+        {-9.9999f, 2, "-10.00"},
+        {999.996f, 2, "1000.00"},
+        {0.9999999f, 4, "1.0000"},
+        {99.5f, 0, "100"},              /* Tie, rounded up to even */
+        {0.5f, 0, "0"},                 /* Ties go to even */
+        {1.5f, 0, "2"},
+        {2.5f, 0, "2"},
+        {0.125f, 2, "0.12"},
+        {0.375f, 2, "0.38"},
+        {-0.125f, 2, "-0.12"},
+    };
+    char buf[TEXT_FIXED_MAX_LEN];
+
+    for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+        zassert_equal(text_format_fixed(buf, sizeof(buf), cases[i].value, cases[i].decimals),
+                      strlen(cases[i].text), "case %u", (unsigned int)i);
+        zassert_str_equal(buf, cases[i].text, "case %u", (unsigned int)i);
+        check_fixed(cases[i].value, TEXT_FIXED_MAX_DECIMALS);
+    }
+}
+
+ZTEST(text_writer, test_buffer_full_truncates)
+{
+    char buf[8];
+    struct text_writer w;
+
+    /* One byte short of the terminator: what fits is kept, NUL-terminated */
+    memset(buf, 'x', sizeof(buf));
+    zassert_equal(text_format_fixed(buf, 6, -21.375f, 2), -ENOMEM);
+    zassert_str_equal(buf, "-21.3");
+    zassert_equal(buf[6], 'x');
+
+    zassert_equal(text_format_fixed(buf, 7, -21.375f, 2), 6);
+    zassert_str_equal(buf, "-21.38");
+
+    /* Overflow across several puts is reported once, at the end */
+    text_writer_init(&w, buf, sizeof(buf));
+    text_put_str(&w, "{\"t\":");
+    text_put_fixed(&w, 21.5f, 2);
+    text_put_char(&w, '}');
+    zassert_equal(text_finish(&w), -ENOMEM);
+    zassert_str_equal(buf, "{\"t\":21");
+
+    text_writer_init(&w, buf, 1);
+    text_put_uint(&w, 7);
+    zassert_equal(text_finish(&w), -ENOMEM);
+    zassert_str_equal(buf, "");
+}